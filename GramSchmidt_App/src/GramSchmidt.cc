@@ -42,13 +42,560 @@
 */
 
 /*------------------------------[Include Files]-------------------------------*/
+#include <errno.h>
+#include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <new>
 
 #include "StdTypes.hh"
-#include "Vector.hh"
-#include "Matrix.hh"
+#include "Orthonormal.hh"
+#include "Grammian.hh"
+#include "Tsqr.hh"
+#include "Batched.hh"
+#include "FixedDispatch.hh"
+#include "ThreadPool.hh"
+#include "View.hh"
+#include "VecFile.hh"
+#include "TextLoader.hh"
+#include "VecWriter.hh"
+#include "VecStream.hh"
+#include "VecService.hh"
 
 /*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @enum    OrthMethod
+** @brief   Orthonormalization methods selectable from the command line
+********************************************************************************
+*/
+enum OrthMethod {ORTH_MGS,          /**< Modified Gram-Schmidt */
+                 ORTH_BGS,          /**< Block Gram-Schmidt */
+                 ORTH_CHOLQR2,      /**< CholeskyQR2 */
+                 ORTH_PIVOTED,      /**< Column pivoted Modified Gram-Schmidt */
+                 ORTH_TSQR,         /**< Tall-skinny QR */
+                 ORTH_BATCHED};     /**< Batched Modified Gram-Schmidt */
+
+/**
+********************************************************************************
+** @def   DEFAULT_BATCH_COUNT
+** @brief Default number of copies of the vector set in the batched method
+********************************************************************************
+*/
+#define DEFAULT_BATCH_COUNT 1000000
+
+/**
+********************************************************************************
+** @def   MAX_GRAM_VECS
+** @brief Largest number of vectors in a set solved by a method that forms
+**        the Grammian, which bounds the Grammian to 2 GB
+********************************************************************************
+*/
+#define MAX_GRAM_VECS 16384
+
+/**
+********************************************************************************
+** @def   MAX_THREADS
+** @brief Largest number of threads that can be requested with -t
+********************************************************************************
+*/
+#define MAX_THREADS 1024
+
+/**
+********************************************************************************
+** @details Parse a count given on the command line. Only decimal digits are
+**          accepted, so a sign, trailing characters, or an empty string are
+**          rejected instead of being read as zero or a wrapped value.
+** @param   pText       Text of the count
+** @param   maxValue    Largest count accepted
+** @param   value       Count, set if it is valid
+** @return  true if the text is a count from 1 to maxValue
+********************************************************************************
+*/
+static bool parseCount(const char* pText, const UINT32& maxValue,
+                       UINT32& value)
+{
+    unsigned long count;
+
+    char* pEnd;
+
+    if (pText[0] < '0' || pText[0] > '9')
+    {
+        return(false);
+    }
+
+    errno = 0;
+    count = strtoul(pText,&pEnd,10);
+    if (0 != errno || '\0' != *pEnd || count < 1 || count > maxValue)
+    {
+        return(false);
+    }
+
+    value = count;
+
+    return(true);
+}
+
+/**
+********************************************************************************
+** @details Print the program usage
+** @param   progName    Name of the executable
+********************************************************************************
+*/
+static void printUsage(const char* progName)
+{
+    printf("Usage: %s [-m method] [-k blockSize] [-t threads] [-p] "
+           "[-b count]\n"
+           "       [-i file | -c file | -s stream] [-o file] "
+           "[-d socket | -r socket]\n"
+           "\n"
+           "  -m method     Orthonormalization method:\n"
+           "                  mgs      Modified Gram-Schmidt (default)\n"
+           "                  bgs      Block Gram-Schmidt\n"
+           "                  cholqr2  CholeskyQR2 from the Grammian\n"
+           "                  pmgs     Column pivoted Modified Gram-Schmidt,\n"
+           "                           which finds the rank without the\n"
+           "                           Grammian\n"
+           "                  tsqr     Parallel tall-skinny QR\n"
+           "                  batch    Batched Modified Gram-Schmidt over\n"
+           "                           many copies of the set, reporting\n"
+           "                           the throughput\n"
+           "  -k blockSize  Number of vectors in each block Gram-Schmidt panel\n"
+           "                (default %d)\n"
+           "  -t threads    Number of threads for the parallel methods (default\n"
+           "                one per hardware thread)\n"
+           "  -p            Pin each worker thread to its own core\n"
+           "  -b count      Number of copies of the vector set in the batched\n"
+           "                method (default %d)\n"
+           "  -i file       Vector set file to orthonormalize in place in\n"
+           "                memory, instead of the built-in set\n"
+           "  -c file       Text file of vectors, one per line with the\n"
+           "                elements separated by commas or white space, to\n"
+           "                orthonormalize instead of the built-in set\n"
+           "  -s stream     Stream of problems to solve one after another, or\n"
+           "                - for standard input\n"
+           "  -o file       Vector set file to write the basis, the source\n"
+           "                index of each basis vector, and the rank to,\n"
+           "                instead of printing the basis. With -s, the\n"
+           "                result stream to write, or - for standard output\n"
+           "  -d socket     Serve orthonormalization and rank requests from\n"
+           "                local clients on a Unix domain socket until\n"
+           "                interrupted\n"
+           "  -r socket     Orthonormalize the vector set on the server\n"
+           "                listening on socket, with the method of the\n"
+           "                server\n",
+           progName,ORTH_BLOCK_SIZE,DEFAULT_BATCH_COUNT);
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize many copies of a vector set with the batched engine,
+**          print the throughput, and copy the basis of the first problem back
+**          to the vector set
+** @param   pVecs       Pointer to the vector set
+** @param   lda         Leading dimension of the vector set
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors
+** @param   batchCount  Number of copies in the batch
+** @return  Number of orthonormal basis vectors of the first problem
+********************************************************************************
+*/
+static UINT32 runBatch(double* pVecs, const UINT32& lda, const UINT32& m,
+                       const UINT32& n, const UINT32& batchCount)
+{
+    UINT32 noOfBasis = 0;
+    UINT32 fullRank;
+    UINT32* pRank;
+
+    bool accepted;
+
+    double seconds;
+    double* pBatch;
+
+    struct timespec start;
+    struct timespec stop;
+
+    pBatch = new double [(size_t)m*n*batchCount];
+    pRank = new UINT32 [batchCount];
+
+    for (UINT32 j = 0; j < n; j++)
+    {
+        for (UINT32 i = 0; i < m; i++)
+        {
+            for (UINT32 p = 0; p < batchCount; p++)
+            {
+                pBatch[batchIndex(p,j,i,m,batchCount)] =
+                    pVecs[(size_t)j*lda + i];
+            }
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC,&start);
+    fullRank = orthonormalizeBatched(pBatch,m,n,batchCount,pRank);
+    clock_gettime(CLOCK_MONOTONIC,&stop);
+
+    seconds = (stop.tv_sec - start.tv_sec) +
+              1E-9*(stop.tv_nsec - start.tv_nsec);
+    printf("Batch of %u problems (%u full rank) in %.6f s: %.0f problems/s\n",
+           batchCount,fullRank,seconds,batchCount/seconds);
+
+    /*
+    ** The batched engine sets each rejected vector to zero, so only the
+    ** accepted vectors of the first problem are copied back
+    */
+    for (UINT32 j = 0; j < n && noOfBasis < pRank[0]; j++)
+    {
+        accepted = false;
+        for (UINT32 i = 0; i < m; i++)
+        {
+            pVecs[(size_t)noOfBasis*lda + i] =
+                pBatch[batchIndex(0,j,i,m,batchCount)];
+            accepted = accepted || (0 != pVecs[(size_t)noOfBasis*lda + i]);
+        }
+
+        if (accepted)
+        {
+            noOfBasis++;
+        }
+    }
+
+    delete[] pRank;
+    delete[] pBatch;
+
+    return(noOfBasis);
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize a vector set in place with one of the methods that
+**          solve a single problem. The Grammian and its rank are calculated
+**          first, except for the pivoted and tall-skinny QR methods, which
+**          find the rank themselves. Rounding can make the Grammian of a
+**          dependent set look full rank, so its rank is clamped to the size
+**          of the set.
+**
+**          A set that cannot be solved is reported instead of ending the
+**          process, so one bad problem of a stream or a server request does
+**          not lose the others. That is a malformed set, a set too large for
+**          its Grammian, or a set with fewer vectors independent to FLOAT_TOL
+**          than the rank of its Grammian.
+** @param   method      Orthonormalization method, other than ORTH_BATCHED
+** @param   pVecs       Pointer to the vector set
+** @param   lda         Leading dimension of the vector set
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors
+** @param   blockSize   Number of vectors in each block Gram-Schmidt panel
+** @param   pOrthVecInd Array of n elements that receives the index of the
+**                      input vector of each basis vector
+** @param   noOfBasis   Number of orthonormal basis vectors, or zero if the
+**                      set was not solved
+** @return  true if the set was solved
+********************************************************************************
+*/
+static bool orthonormalizeSet(const OrthMethod& method, double* pVecs,
+                              const UINT32& lda, const UINT32& m,
+                              const UINT32& n, const UINT32& blockSize,
+                              UINT32* pOrthVecInd, UINT32& noOfBasis)
+{
+    UINT32 gramRank = 0;
+
+    double* pGram = NULL;
+
+    bool useGram = (ORTH_PIVOTED != method && ORTH_TSQR != method);
+
+    noOfBasis = 0;
+
+    if (m < 1 || n < 1 || lda < m || blockSize < 1 ||
+        (useGram && n > MAX_GRAM_VECS))
+    {
+        return(false);
+    }
+
+    if (useGram)
+    {
+        pGram = new (std::nothrow) double [(size_t)n*n];
+        if (NULL == pGram)
+        {
+            return(false);
+        }
+
+        grammian(pVecs,lda,m,n,pGram);
+        gramRank = std::min(rankFixed(pGram,n,n),std::min(m,n));
+    }
+
+    /*
+    ** CholeskyQR2 factors the Grammian already calculated above
+    */
+    switch (method)
+    {
+        case ORTH_BGS:
+            noOfBasis = orthonormalizeBlocked(pVecs,lda,m,n,gramRank,
+                                              blockSize,pOrthVecInd);
+            break;
+
+        case ORTH_CHOLQR2:
+            noOfBasis = orthonormalizeCholQR2(pVecs,lda,m,n,pGram,gramRank,
+                                              pOrthVecInd);
+            break;
+
+        case ORTH_PIVOTED:
+            noOfBasis = orthonormalizePivoted(pVecs,lda,m,n,pOrthVecInd);
+            break;
+
+        case ORTH_TSQR:
+            noOfBasis = orthonormalizeTSQR(pVecs,lda,m,n,0,pOrthVecInd);
+            break;
+
+        default:
+            /*
+            ** The fixed-dimension kernels need unpadded vectors
+            */
+            if (lda == m)
+            {
+                noOfBasis = orthonormalizeFixed(pVecs,m,n,gramRank,
+                                                pOrthVecInd);
+            }
+            else
+            {
+                noOfBasis = orthonormalize(pVecs,lda,m,n,gramRank,
+                                           pOrthVecInd);
+            }
+            break;
+    }
+
+    delete[] pGram;
+
+    if (useGram && noOfBasis != gramRank)
+    {
+        noOfBasis = 0;
+        return(false);
+    }
+
+    return(true);
+}
+
+/**
+********************************************************************************
+** @details Solve a stream of problems in one process. A background thread
+**          reads the next batch of problems while the current one is solved,
+**          with the problems of a batch solved in parallel, one per task. The
+**          results are written in problem order to a result stream, or
+**          printed, and the throughput is reported unless the results go to
+**          standard output.
+** @param   pStream     Name of the problem stream, or "-" for standard input
+** @param   pOutFile    Name of the result stream, "-" for standard output, or
+**                      NULL to print the bases
+** @param   method      Orthonormalization method, other than ORTH_BATCHED
+** @param   blockSize   Number of vectors in each block Gram-Schmidt panel
+********************************************************************************
+*/
+static void runStream(const char* pStream, const char* pOutFile,
+                      const OrthMethod& method, const UINT32& blockSize)
+{
+    UINT64 noOfProbs = 0;
+
+    double seconds;
+
+    struct timespec start;
+    struct timespec stop;
+
+    VecStreamReader reader;
+    VecStreamWriter writer;
+    VecBatch* pBatch;
+
+    clock_gettime(CLOCK_MONOTONIC,&start);
+
+    reader.open(pStream);
+    if (NULL != pOutFile)
+    {
+        writer.open(pOutFile);
+    }
+
+    while (NULL != (pBatch = reader.next()))
+    {
+        ThreadPool::instance().parallelFor(0,pBatch->noOfProbs,1,
+            [&](UINT32 first, UINT32 last)
+            {
+                for (UINT32 p = first; p < last; p++)
+                {
+                    VecProblem& prob = pBatch->pProbs[p];
+
+                    if (!prob.loaded)
+                    {
+                        continue;
+                    }
+
+                    prob.status =
+                        orthonormalizeSet(method,
+                                          pBatch->pData + prob.dataOffset,
+                                          prob.ndims,prob.ndims,prob.noOfVecs,
+                                          blockSize,
+                                          pBatch->pIndices + prob.indexOffset,
+                                          prob.noOfBasis) ?
+                        VECRESULT_SOLVED : VECRESULT_UNSOLVED;
+                }
+            });
+
+        if (NULL != pOutFile)
+        {
+            writer.write(*pBatch);
+        }
+        else
+        {
+            for (UINT32 p = 0; p < pBatch->noOfProbs; p++)
+            {
+                const VecProblem& prob = pBatch->pProbs[p];
+
+                if (VECRESULT_SOLVED != prob.status)
+                {
+                    printf("Problem %llu of %u vectors with dimension %u "
+                           "could not be solved\n",
+                           (unsigned long long)(noOfProbs + p),prob.noOfVecs,
+                           prob.ndims);
+                    continue;
+                }
+
+                printf("Number of orthogonal vectors: %d\n",prob.noOfBasis);
+                writeVecText(stdout,pBatch->pData + prob.dataOffset,prob.ndims,
+                             prob.ndims,prob.noOfBasis);
+            }
+        }
+
+        noOfProbs += pBatch->noOfProbs;
+        reader.release(pBatch);
+    }
+
+    writer.close();
+    reader.close();
+
+    clock_gettime(CLOCK_MONOTONIC,&stop);
+
+    seconds = (stop.tv_sec - start.tv_sec) +
+              1E-9*(stop.tv_nsec - start.tv_nsec);
+    if (NULL == pOutFile || 0 != strcmp(pOutFile,"-"))
+    {
+        printf("Stream of %llu problems in %.6f s: %.0f problems/s\n",
+               (unsigned long long)noOfProbs,seconds,noOfProbs/seconds);
+    }
+}
+
+/**
+********************************************************************************
+** @var     pDaemon
+** @brief   Server stopped by the signal handler in daemon mode
+********************************************************************************
+*/
+static VecServer* pDaemon = NULL;
+
+/**
+********************************************************************************
+** @details Signal handler that stops the server in daemon mode
+** @param   signum  Signal number
+********************************************************************************
+*/
+static void stopDaemon(int signum)
+{
+    if (NULL != pDaemon)
+    {
+        pDaemon->requestStop();
+    }
+}
+
+/**
+********************************************************************************
+** @details Serve orthonormalization and rank requests from local clients
+**          until SIGINT or SIGTERM. Requests arriving together are solved in
+**          parallel micro-batches, one problem per task, on the vectors in
+**          the shared memory of each client.
+** @param   pSocket     Socket path to listen on
+** @param   method      Orthonormalization method, other than ORTH_BATCHED
+** @param   blockSize   Number of vectors in each block Gram-Schmidt panel
+********************************************************************************
+*/
+static void runDaemon(const char* pSocket, const OrthMethod& method,
+                      const UINT32& blockSize)
+{
+    VecServer server;
+
+    pDaemon = &server;
+    signal(SIGINT,stopDaemon);
+    signal(SIGTERM,stopDaemon);
+
+    printf("Serving on %s with %u threads\n",pSocket,
+           ThreadPool::instance().getThreadCount());
+    fflush(stdout);
+
+    server.run(pSocket,
+        [&](const VecRequest& request, double* pVecs, UINT32* pIndices,
+            UINT32& result)
+        {
+            if (VECSVC_RANK == request.op)
+            {
+                result = MatrixView(pVecs,request.noOfVecs,request.ndims,
+                                    request.lda).rank();
+                return((UINT32)VECSVC_OK);
+            }
+
+            if (!orthonormalizeSet(method,pVecs,request.lda,request.ndims,
+                                   request.noOfVecs,blockSize,pIndices,result))
+            {
+                return((UINT32)VECSVC_UNSOLVED);
+            }
+
+            return((UINT32)VECSVC_OK);
+        });
+
+    signal(SIGINT,SIG_DFL);
+    signal(SIGTERM,SIG_DFL);
+    pDaemon = NULL;
+
+    printf("Served %llu requests in %llu micro-batches\n",
+           (unsigned long long)server.getRequestCount(),
+           (unsigned long long)server.getBatchCount());
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize a vector set in place on a server. The set is
+**          copied into the shared memory of the connection, solved there by
+**          the server, and the basis copied back.
+** @param   pSocket     Socket path of the server
+** @param   pVecs       Pointer to the vector set
+** @param   lda         Leading dimension of the vector set
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors
+** @param   pOrthVecInd Array of n elements that receives the index of the
+**                      input vector of each basis vector
+** @return  Number of orthonormal basis vectors
+********************************************************************************
+*/
+static UINT32 runRemote(const char* pSocket, double* pVecs, const UINT32& lda,
+                        const UINT32& m, const UINT32& n, UINT32* pOrthVecInd)
+{
+    UINT32 noOfBasis;
+
+    size_t vecBytes = (size_t)n*lda*sizeof(double);
+
+    VecClient client;
+
+    client.connect(pSocket,vecBytes + n*sizeof(UINT32));
+
+    memcpy(client.getShared(),pVecs,vecBytes);
+    noOfBasis = client.orthonormalize(0,lda,m,n,vecBytes);
+    memcpy(pVecs,client.getShared(),(size_t)noOfBasis*lda*sizeof(double));
+    memcpy(pOrthVecInd,client.getShared() + vecBytes,
+           noOfBasis*sizeof(UINT32));
+
+    client.close();
+
+    return(noOfBasis);
+}
+
 /**
 ********************************************************************************
 ** @details This is the entry point for the GramSchmidt C++ program.
@@ -64,18 +611,184 @@ int main(int argc, char* argv[])
     */
     UINT32 noOfVecs = 4;
     UINT32 ndims = 4;
-    UINT32 gramRank;
-    UINT32 vecsToGo;
+    UINT32 lda;
+    UINT32 noOfBasis;
+    UINT32 blockSize = ORTH_BLOCK_SIZE;
+    UINT32 batchCount = DEFAULT_BATCH_COUNT;
+    UINT32 threadCount;
     UINT32* pOrthVecInd;
 
+    INT32 opt;
+
+    OrthMethod method = ORTH_MGS;
+
+    const char* pInFile = NULL;
+    const char* pTextFile = NULL;
+    const char* pOutFile = NULL;
+    const char* pStream = NULL;
+    const char* pDaemonSocket = NULL;
+    const char* pRemoteSocket = NULL;
+
     double vecSet[noOfVecs][ndims];
-    double matArray[noOfVecs*noOfVecs];
+    double* pVecs;
+
+    VecFile inFile;
+    TextLoader textFile;
+
+    /*
+    ** Parse the command line options
+    */
+    while ((opt = getopt(argc,argv,"m:k:t:pb:i:c:s:o:d:r:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'm':
+                if (0 == strcmp(optarg,"mgs"))
+                {
+                    method = ORTH_MGS;
+                }
+                else if (0 == strcmp(optarg,"bgs"))
+                {
+                    method = ORTH_BGS;
+                }
+                else if (0 == strcmp(optarg,"cholqr2"))
+                {
+                    method = ORTH_CHOLQR2;
+                }
+                else if (0 == strcmp(optarg,"pmgs"))
+                {
+                    method = ORTH_PIVOTED;
+                }
+                else if (0 == strcmp(optarg,"tsqr"))
+                {
+                    method = ORTH_TSQR;
+                }
+                else if (0 == strcmp(optarg,"batch"))
+                {
+                    method = ORTH_BATCHED;
+                }
+                else
+                {
+                    printf("Error - Unknown method: %s\n",optarg);
+                    printUsage(argv[0]);
+                    return(EXIT_FAILURE);
+                }
+                break;
+
+            case 'k':
+                if (!parseCount(optarg,~(UINT32)0,blockSize))
+                {
+                    printf("Error - Block size must be at least 1\n");
+                    return(EXIT_FAILURE);
+                }
+                break;
+
+            case 't':
+                if (!parseCount(optarg,MAX_THREADS,threadCount))
+                {
+                    printf("Error - Thread count must be from 1 to %d\n",
+                           MAX_THREADS);
+                    return(EXIT_FAILURE);
+                }
+                ThreadPool::instance().setThreadCount(threadCount);
+                break;
+
+            case 'p':
+                ThreadPool::instance().setPinning(true);
+                break;
+
+            case 'b':
+                if (!parseCount(optarg,~(UINT32)0,batchCount))
+                {
+                    printf("Error - Batch count must be at least 1\n");
+                    return(EXIT_FAILURE);
+                }
+                break;
+
+            case 'i':
+                pInFile = optarg;
+                break;
+
+            case 'c':
+                pTextFile = optarg;
+                break;
+
+            case 's':
+                pStream = optarg;
+                break;
+
+            case 'o':
+                pOutFile = optarg;
+                break;
+
+            case 'd':
+                pDaemonSocket = optarg;
+                break;
+
+            case 'r':
+                pRemoteSocket = optarg;
+                break;
+
+            default:
+                printUsage(argv[0]);
+                return('h' == opt ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+    }
+
+    if ((NULL != pInFile) + (NULL != pTextFile) + (NULL != pStream) > 1)
+    {
+        printf("Error - Only one of -i, -c, and -s may be given\n");
+        return(EXIT_FAILURE);
+    }
+
+    /*
+    ** A daemon solves the requests of other processes until it is stopped
+    */
+    if (NULL != pDaemonSocket)
+    {
+        if (NULL != pInFile || NULL != pTextFile || NULL != pStream ||
+            NULL != pOutFile || NULL != pRemoteSocket)
+        {
+            printf("Error - -d cannot be combined with -i, -c, -s, -o, "
+                   "or -r\n");
+            return(EXIT_FAILURE);
+        }
+        else if (ORTH_BATCHED == method)
+        {
+            printf("Error - The batch method cannot serve requests\n");
+            return(EXIT_FAILURE);
+        }
+
+        runDaemon(pDaemonSocket,method,blockSize);
+        return(EXIT_SUCCESS);
+    }
 
-    Vector vec[noOfVecs];
-    Vector zeroVec(ndims);
+    if (NULL != pRemoteSocket &&
+        (NULL != pStream || ORTH_BATCHED == method))
+    {
+        printf("Error - -r cannot be combined with -s or the batch method\n");
+        return(EXIT_FAILURE);
+    }
 
     /*
-    ** Instantiate each vector in the set and define their values
+    ** A stream of problems is solved in this process, one batch at a time
+    */
+    if (NULL != pStream)
+    {
+        if (ORTH_BATCHED == method)
+        {
+            printf("Error - The batch method cannot solve a stream\n");
+            return(EXIT_FAILURE);
+        }
+
+        runStream(pStream,pOutFile,method,blockSize);
+        return(EXIT_SUCCESS);
+    }
+
+    /*
+    ** Define the values of each vector in the set. The vectors are stored
+    ** contiguously, one after another, so the set can be handed directly to
+    ** the orthonormalization routine.
     */
     vecSet[0][0] = 1;
     vecSet[0][1] = 2;
@@ -97,76 +810,86 @@ int main(int argc, char* argv[])
     vecSet[3][2] = 1;
     vecSet[3][3] = 9;
 
-    for (UINT32 i = 0; i < noOfVecs; i++)
-    {
-        vec[i].setVector(vecSet[i],ndims);
-    }
+    pVecs = vecSet[0];
+    lda = ndims;
 
     /*
-    ** Calculate the Grammian matrix and determine it's rank
+    ** A vector set file is mapped privately and used in place, so the set is
+    ** neither parsed nor copied, and the file itself is left unchanged
     */
-    for (UINT32 i = 0; i < noOfVecs; i++)
+    if (NULL != pInFile)
     {
-        for (UINT32 j = 0; j < noOfVecs; j++)
-        {
-            matArray[i*noOfVecs + j] = vec[i]*vec[j];
-        }
+        inFile.open(pInFile);
+
+        pVecs = inFile.getVecs();
+        lda = inFile.getLeadDim();
+        ndims = inFile.getDims();
+        noOfVecs = inFile.getCount();
     }
 
-    Matrix grammian(matArray,noOfVecs,noOfVecs);
-    gramRank = grammian.rank();
-    vecsToGo = gramRank;
+    /*
+    ** A text file is parsed in parallel straight into aligned vector storage
+    */
+    if (NULL != pTextFile)
+    {
+        textFile.load(pTextFile);
 
-    pOrthVecInd = new UINT32 [gramRank];
+        pVecs = textFile.getVecs();
+        lda = textFile.getLeadDim();
+        ndims = textFile.getDims();
+        noOfVecs = textFile.getCount();
+    }
 
     /*
-    ** Perform the Modified Gram-Schmidt algorithm
+    ** Perform the selected orthonormalization algorithm
     */
-    if (gramRank > 0)
+    pOrthVecInd = new UINT32 [noOfVecs];
+    if (NULL != pRemoteSocket)
     {
-        for (UINT32 i = 0; i < noOfVecs; i++)
+        noOfBasis = runRemote(pRemoteSocket,pVecs,lda,ndims,noOfVecs,
+                              pOrthVecInd);
+    }
+    else if (ORTH_BATCHED == method)
+    {
+        noOfBasis = runBatch(pVecs,lda,ndims,noOfVecs,batchCount);
+    }
+    else
+    {
+        if (!orthonormalizeSet(method,pVecs,lda,ndims,noOfVecs,blockSize,
+                               pOrthVecInd,noOfBasis))
         {
-            /*
-            ** Subtract the current vector component from every vector still
-            ** left and calculate the next unit vector
-            */
-            if (i > 0)
-            {
-                for (UINT32 j = i; j < noOfVecs; j++)
-                {
-                    vec[j] = vec[j] - (vec[i-1]*vec[j])*vec[i-1];
-                }
-            }
-
-            if (vec[i].mag() >= FLOAT_TOL || vecsToGo == noOfVecs-i)
-            {
-                vec[i] = vec[i].unit();
-                pOrthVecInd[gramRank-vecsToGo] = i;
-                vecsToGo--;
-            }
-            else
-            {
-                vec[i] = zeroVec;
-            }
-
-            /*
-            ** If all of the orthogonal vectors have been found, end the loop
-            */
-            if (0 == vecsToGo)
-            {
-                break;
-            }
+            printf("Error - %s\n"
+                   "        The set of %u vectors with dimension %u could not\n"
+                   "        be orthonormalized\n",
+                   __PRETTY_FUNCTION__,noOfVecs,ndims);
+            exit(EXIT_FAILURE);
         }
     }
 
     /*
-    ** Print the orthogonal vectors
+    ** Write the orthogonal vectors to a file at full precision, or print them.
+    ** The batched engine does not report which vectors it kept.
     */
-    printf("Number of orthogonal vectors: %d\n",gramRank);
-    for (UINT32 i = 0; i < gramRank; i++)
+    printf("Number of orthogonal vectors: %d\n",noOfBasis);
+    if (NULL != pOutFile)
     {
-        vec[pOrthVecInd[i]].objPrint();
+        if (noOfBasis > 0)
+        {
+            writeVecFile(pOutFile,pVecs,lda,ndims,noOfBasis,
+                         (ORTH_BATCHED == method) ? NULL : pOrthVecInd,
+                         noOfBasis,noOfVecs);
+        }
+        else
+        {
+            printf("No basis vectors, %s not written\n",pOutFile);
+        }
+    }
+    else
+    {
+        writeVecText(stdout,pVecs,lda,ndims,noOfBasis);
     }
 
+    delete[] pOrthVecInd;
+
     return 0;
 }
@@ -0,0 +1,671 @@
+/**
+********************************************************************************
+** @file    MathTest.cc
+**
+** @brief   Regression tests of the math library
+**
+** @details Each test checks one behaviour of libutlmath that has broken
+**          before and reports whether it passed. The program exits with a
+**          failure status if any test fails, so it can gate a build.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  MathTest.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <utility>
+#include <vector>
+
+#include "StdTypes.hh"
+#include "Arena.hh"
+#include "Vector.hh"
+#include "Matrix.hh"
+#include "Orthonormal.hh"
+#include "FixedDispatch.hh"
+#include "FixedMatrix.hh"
+#include "Gemm.hh"
+#include "ThreadPool.hh"
+#include "Batched.hh"
+#include "VecKernels.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @details Overwrite the memory an arena handed out to earlier scopes, so
+**          storage still pointing into the arena reads the wrong values
+** @param   arena   Arena to fill
+** @param   n       Number of doubles to fill
+********************************************************************************
+*/
+static void clobberArena(Arena& arena, const UINT32& n)
+{
+    ArenaScope scope(arena);
+
+    double* pFill = arena.allocDoubles(n);
+
+    for (UINT32 i = 0; i < n; i++)
+    {
+        pFill[i] = -1;
+    }
+}
+
+/**
+********************************************************************************
+** @details Check the elements of a Vector moved out of an arena scope, by
+**          construction and by assignment, survive the end of the scope
+** @return  true if the test passed
+********************************************************************************
+*/
+static bool testVectorArenaMove(void)
+{
+    UINT32 n = 4*VECTOR_INLINE_SIZE;
+
+    bool pass = true;
+
+    Arena arena;
+    Vector assigned(n);
+    Vector* pBuilt = NULL;
+
+    {
+        ArenaScope scope(arena);
+
+        Vector inner(n);
+        Vector other(n);
+
+        for (UINT32 i = 0; i < n; i++)
+        {
+            inner[i] = i;
+            other[i] = 2*i;
+        }
+
+        assigned = std::move(inner);
+        pBuilt = new Vector(std::move(other));
+    }
+
+    clobberArena(arena,2*n);
+
+    for (UINT32 i = 0; i < n; i++)
+    {
+        pass = pass && (assigned[i] == i) && ((*pBuilt)[i] == 2*i);
+    }
+
+    delete pBuilt;
+
+    return(pass);
+}
+
+/**
+********************************************************************************
+** @details Check the elements of a Matrix moved out of an arena scope, by
+**          construction and by assignment, survive the end of the scope
+** @return  true if the test passed
+********************************************************************************
+*/
+static bool testMatrixArenaMove(void)
+{
+    UINT32 m = 5;
+    UINT32 n = 3;
+
+    bool pass = true;
+
+    Arena arena;
+    Matrix assigned(m,n,MATRIX_COL_MAJOR);
+    Matrix* pBuilt = NULL;
+
+    {
+        ArenaScope scope(arena);
+
+        Matrix inner(m,n);
+        Matrix other(m,n);
+
+        for (UINT32 i = 0; i < m; i++)
+        {
+            for (UINT32 j = 0; j < n; j++)
+            {
+                inner[i][j] = i*n + j;
+                other[i][j] = 3*(i*n + j);
+            }
+        }
+
+        assigned = std::move(inner);
+        pBuilt = new Matrix(std::move(other));
+    }
+
+    clobberArena(arena,4*m*n);
+
+    for (UINT32 i = 0; i < m; i++)
+    {
+        for (UINT32 j = 0; j < n; j++)
+        {
+            pass = pass && (assigned[i][j] == i*n + j) &&
+                   ((*pBuilt)[i][j] == 3*(i*n + j));
+        }
+    }
+
+    delete pBuilt;
+
+    return(pass);
+}
+
+/**
+********************************************************************************
+** @details Check a Matrix adopting a buffer whose rows would need padding
+**          uses the buffer in place, unpadded, and that its rank, a copy and
+**          a subtraction from padded storage follow its leading dimension
+** @return  true if the test passed
+********************************************************************************
+*/
+static bool testMatrixAdoptPadding(void)
+{
+    const UINT32 m = 3;
+    const UINT32 n = 3;
+
+    bool pass;
+
+    double values[m*n];
+    double* pBuffer = new double [m*n];
+
+    for (UINT32 k = 0; k < m*n; k++)
+    {
+        values[k] = k + 1;
+        pBuffer[k] = k + 1;
+    }
+
+    Matrix adopted(pBuffer,m,n,ADOPT_BUFFER);
+    Matrix copied(adopted);
+
+    pass = (adopted.view().getData() == pBuffer) &&
+           (adopted.getLeadDim() == n) &&
+           (copied.getLeadDim() == padLeadDim(n)) &&
+           (2 == adopted.rank());
+
+    for (UINT32 i = 0; i < m; i++)
+    {
+        for (UINT32 j = 0; j < n; j++)
+        {
+            pass = pass && (adopted[i][j] == values[i*n + j]) &&
+                   (copied[i][j] == values[i*n + j]);
+        }
+    }
+
+    copied -= adopted;
+    for (UINT32 i = 0; i < m; i++)
+    {
+        for (UINT32 j = 0; j < n; j++)
+        {
+            pass = pass && (0 == copied[i][j]);
+        }
+    }
+
+    return(pass);
+}
+
+/**
+********************************************************************************
+** @details Check the first vectors of a set are orthonormal
+** @param   pVecs   Pointer to the vector set
+** @param   lda     Leading dimension of the vector set
+** @param   m       Dimension of each vector
+** @param   n       Number of vectors to check
+** @return  true if every inner product is within 1E-12 of the identity
+********************************************************************************
+*/
+static bool isOrthonormal(const double* pVecs, const UINT32& lda,
+                          const UINT32& m, const UINT32& n)
+{
+    double dot;
+
+    for (UINT32 i = 0; i < n; i++)
+    {
+        for (UINT32 j = 0; j < n; j++)
+        {
+            dot = 0;
+            for (UINT32 k = 0; k < m; k++)
+            {
+                dot += pVecs[(size_t)i*lda + k]*pVecs[(size_t)j*lda + k];
+            }
+
+            if (fabs(dot - ((i == j) ? 1 : 0)) > 1E-12)
+            {
+                return(false);
+            }
+        }
+    }
+
+    return(true);
+}
+
+/**
+********************************************************************************
+** @details Fill a set of three vectors whose second vector is twice the
+**          first, so its rank is two
+** @param   pVecs   Pointer to the vector set
+** @param   lda     Leading dimension of the vector set
+** @param   m       Dimension of each vector, at least 3
+********************************************************************************
+*/
+static void fillDependentSet(double* pVecs, const UINT32& lda, const UINT32& m)
+{
+    for (UINT32 k = 0; k < 3*lda; k++)
+    {
+        pVecs[k] = 0;
+    }
+
+    for (UINT32 k = 0; k < m; k++)
+    {
+        pVecs[k] = k + 1;
+        pVecs[lda + k] = 2*(k + 1);
+    }
+    pVecs[2*lda + 1] = 1;
+    pVecs[2*lda + 2] = -1;
+}
+
+/**
+********************************************************************************
+** @details Check the Modified Gram-Schmidt routines return the basis they
+**          found, with its source indices, when the given rank overstates the
+**          rank of the set. The unblocked and block routines are checked on
+**          padded vectors, and the fixed dimension code on unpadded ones.
+** @return  true if the test passed
+********************************************************************************
+*/
+static bool testRankOverstated(void)
+{
+    const UINT32 m = 5;
+    const UINT32 lda = 8;
+    const UINT32 n = 3;
+
+    UINT32 pOrthVecInd[n];
+    UINT32 noOfBasis;
+
+    bool pass = true;
+
+    double pVecs[n*lda];
+
+    fillDependentSet(pVecs,lda,m);
+    noOfBasis = orthonormalize(pVecs,lda,m,n,n,pOrthVecInd);
+    pass = pass && (2 == noOfBasis) && (0 == pOrthVecInd[0]) &&
+           (2 == pOrthVecInd[1]) && isOrthonormal(pVecs,lda,m,noOfBasis);
+
+    fillDependentSet(pVecs,lda,m);
+    noOfBasis = orthonormalizeBlocked(pVecs,lda,m,n,n,2,pOrthVecInd);
+    pass = pass && (2 == noOfBasis) && (0 == pOrthVecInd[0]) &&
+           (2 == pOrthVecInd[1]) && isOrthonormal(pVecs,lda,m,noOfBasis);
+
+    /* Dimension 3 has fixed dimension code */
+    fillDependentSet(pVecs,3,3);
+    noOfBasis = orthonormalizeFixed(pVecs,3,n,n,pOrthVecInd);
+    pass = pass && (2 == noOfBasis) && (0 == pOrthVecInd[0]) &&
+           (2 == pOrthVecInd[1]) && isOrthonormal(pVecs,3,3,noOfBasis);
+
+    return(pass);
+}
+
+/**
+********************************************************************************
+** @details Check two values are equal to within 1E-12
+** @param   x   First value
+** @param   y   Second value
+** @return  true if the values are equal to within 1E-12
+********************************************************************************
+*/
+static constexpr bool isNear(const double& x, const double& y)
+{
+    return(x - y <= 1E-12 && y - x <= 1E-12);
+}
+
+/**
+********************************************************************************
+** @details Run the fixed dimension norm, MGS and determinant, which all take
+**          square roots. This is evaluated by the static_assert below, so the
+**          build fails on a compiler that cannot evaluate them in a constant
+**          expression.
+** @return  true if the results are right
+********************************************************************************
+*/
+static constexpr bool testFixedConstant(void)
+{
+    const double vals[9] = {3, 4, 0,
+                            6, 8, 0,
+                            0, 0, 2};
+    const double diag[9] = {2, 0, 0,
+                            0, 3, 0,
+                            0, 0, 4};
+
+    FixedVector<3> vec(vals);
+    FixedMatrix<3,3> vecs(vals);
+    FixedMatrix<3,3> diagMat(diag);
+    UINT32 pOrthVecInd[3] = {};
+    UINT32 noOfBasis = vecs.orthonormalize(3,pOrthVecInd);
+
+    return(isNear(vec.mag(),5) && (2 == noOfBasis) &&
+           (0 == pOrthVecInd[0]) && (2 == pOrthVecInd[1]) &&
+           isNear(vecs[0][0],0.6) && isNear(vecs[0][1],0.8) &&
+           isNear(vecs[1][1],0) && isNear(vecs[1][2],1) &&
+           isNear(diagMat.determinant(),24));
+}
+
+static_assert(testFixedConstant(),
+              "Fixed dimension routines give wrong constant results");
+
+/**
+********************************************************************************
+** @details Return the next value of a linear congruential generator, so the
+**          random tests give the same values on every run
+** @param   state   Generator state, updated
+** @return  Value in [-1,1)
+********************************************************************************
+*/
+static double nextRandom(UINT64& state)
+{
+    state = state*6364136223846793005ULL + 1442695040888963407ULL;
+
+    return((double)(state >> 11)/(double)(1ULL << 52) - 1);
+}
+
+/**
+********************************************************************************
+** @details Check one product of gemm() with random operands against a naive
+**          triple loop. The operands and C have leading dimensions larger
+**          than their rows, and C starts as NaN when beta is zero, since it
+**          must then not be read.
+** @param   transA  Operation applied to A
+** @param   transB  Operation applied to B
+** @param   m       Number of rows of op(A) and C
+** @param   n       Number of columns of op(B) and C
+** @param   k       Number of columns of op(A) and rows of op(B)
+** @param   alpha   Scalar multiplier of op(A)*op(B)
+** @param   beta    Scalar multiplier of C
+** @param   state   Random generator state, updated
+** @return  true if every element is within rounding of the reference
+********************************************************************************
+*/
+static bool checkGemm(const GemmTrans& transA, const GemmTrans& transB,
+                      const UINT32& m, const UINT32& n, const UINT32& k,
+                      const double& alpha, const double& beta, UINT64& state)
+{
+    UINT32 lda = ((GEMM_NO_TRANS == transA) ? k : m) + 3;
+    UINT32 ldb = ((GEMM_NO_TRANS == transB) ? n : k) + 5;
+    UINT32 ldc = n + 1;
+    UINT32 aRows = (GEMM_NO_TRANS == transA) ? m : k;
+    UINT32 bRows = (GEMM_NO_TRANS == transB) ? k : n;
+
+    double sum;
+    double aVal;
+    double bVal;
+    double expected;
+
+    bool pass = true;
+
+    std::vector<double> a((size_t)aRows*lda);
+    std::vector<double> b((size_t)bRows*ldb);
+    std::vector<double> c((size_t)m*ldc);
+    std::vector<double> c0((size_t)m*ldc);
+
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        a[i] = nextRandom(state);
+    }
+    for (size_t i = 0; i < b.size(); i++)
+    {
+        b[i] = nextRandom(state);
+    }
+    for (size_t i = 0; i < c.size(); i++)
+    {
+        c0[i] = (0 == beta) ? NAN : nextRandom(state);
+        c[i] = c0[i];
+    }
+
+    gemm(transA,transB,m,n,k,alpha,a.data(),lda,b.data(),ldb,beta,c.data(),
+         ldc);
+
+    for (UINT32 i = 0; i < m; i++)
+    {
+        for (UINT32 j = 0; j < n; j++)
+        {
+            sum = 0;
+            for (UINT32 p = 0; p < k; p++)
+            {
+                aVal = (GEMM_NO_TRANS == transA) ? a[(size_t)i*lda + p] :
+                                                   a[(size_t)p*lda + i];
+                bVal = (GEMM_NO_TRANS == transB) ? b[(size_t)p*ldb + j] :
+                                                   b[(size_t)j*ldb + p];
+                sum += aVal*bVal;
+            }
+
+            expected = alpha*sum;
+            if (0 != beta)
+            {
+                expected += beta*c0[(size_t)i*ldc + j];
+            }
+
+            pass = pass && (fabs(c[(size_t)i*ldc + j] - expected) <=
+                            1E-13*(k + 1));
+        }
+    }
+
+    return(pass);
+}
+
+/**
+********************************************************************************
+** @details Check gemm() against a naive product on random operands, with
+**          every combination of transposes. The sizes cover a single
+**          element, edges smaller than the register and cache blocks, more
+**          than one cache block in each dimension, and a small C with a long
+**          inner dimension, which is split over the threads of the pool.
+** @return  true if the test passed
+********************************************************************************
+*/
+static bool testGemmRandom(void)
+{
+    const UINT32 sizes[][3] = {{1,1,1},
+                               {7,9,5},
+                               {97,1030,300},
+                               {13,17,1200}};
+    const double scales[][2] = {{1,0},
+                                {-0.5,0.75}};
+
+    UINT64 state = 12345;
+    UINT32 trial = 0;
+
+    bool pass = true;
+
+    ThreadPool::instance().setThreadCount(4);
+
+    for (UINT32 s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++)
+    {
+        for (UINT32 t = 0; t < 4; t++)
+        {
+            pass = checkGemm((t & 1) ? GEMM_TRANS : GEMM_NO_TRANS,
+                             (t & 2) ? GEMM_TRANS : GEMM_NO_TRANS,
+                             sizes[s][0],sizes[s][1],sizes[s][2],
+                             scales[trial%2][0],scales[trial%2][1],
+                             state) && pass;
+            trial++;
+        }
+    }
+
+    ThreadPool::instance().setThreadCount(0);
+
+    return(pass);
+}
+
+/**
+********************************************************************************
+** @details Check every batched kernel the CPU supports against
+**          orthonormalize() on the same batch. The number of problems leaves
+**          a partial group for each lane width, and every third problem has a
+**          dependent vector and every third a zero vector, so the rejected
+**          vectors are checked as well as the basis.
+** @return  true if the test passed
+********************************************************************************
+*/
+static bool testBatchedKernels(void)
+{
+    const UINT32 m = 6;
+    const UINT32 n = 4;
+    const UINT32 noOfProblems = 29;
+    const VecKernelIsa isas[] = {VEC_ISA_GENERIC,
+                                 VEC_ISA_SSE2,
+                                 VEC_ISA_AVX2,
+                                 VEC_ISA_AVX512};
+
+    VecKernelIsa startIsa = vecKernelTable.isa;
+    UINT64 state = 777;
+    UINT32 noOfBasis;
+    UINT32 b;
+
+    bool accepted;
+    bool pass = true;
+
+    std::vector<double> batch((size_t)m*n*noOfProblems);
+    std::vector<double> result(batch.size());
+    std::vector<UINT32> rank(noOfProblems);
+    std::vector<double> ref((size_t)m*n);
+    UINT32 pOrthVecInd[n];
+
+    for (size_t k = 0; k < batch.size(); k++)
+    {
+        batch[k] = nextRandom(state);
+    }
+    for (UINT32 p = 0; p < noOfProblems; p++)
+    {
+        for (UINT32 i = 0; i < m; i++)
+        {
+            if (1 == p%3)
+            {
+                batch[batchIndex(p,2,i,m,noOfProblems)] =
+                    batch[batchIndex(p,0,i,m,noOfProblems)] -
+                    0.5*batch[batchIndex(p,1,i,m,noOfProblems)];
+            }
+            else if (2 == p%3)
+            {
+                batch[batchIndex(p,1,i,m,noOfProblems)] = 0;
+            }
+        }
+    }
+
+    for (UINT32 s = 0; s < sizeof(isas)/sizeof(isas[0]); s++)
+    {
+        if (!setVecKernelIsa(isas[s]))
+        {
+            continue;
+        }
+
+        result = batch;
+        orthonormalizeBatched(&result[0],m,n,noOfProblems,&rank[0]);
+
+        for (UINT32 p = 0; p < noOfProblems; p++)
+        {
+            for (UINT32 j = 0; j < n; j++)
+            {
+                for (UINT32 i = 0; i < m; i++)
+                {
+                    ref[(size_t)j*m + i] =
+                        batch[batchIndex(p,j,i,m,noOfProblems)];
+                }
+            }
+            noOfBasis = orthonormalize(&ref[0],m,m,n,n,pOrthVecInd);
+            pass = pass && (noOfBasis == rank[p]) &&
+                   (((0 == p%3) ? n : n - 1) == noOfBasis);
+
+            /*
+            ** The batched basis keeps the input order, with the rejected
+            ** vectors set to zero
+            */
+            b = 0;
+            for (UINT32 j = 0; j < n; j++)
+            {
+                accepted = (b < noOfBasis) && (j == pOrthVecInd[b]);
+
+                for (UINT32 i = 0; i < m; i++)
+                {
+                    pass = pass &&
+                           (fabs(result[batchIndex(p,j,i,m,noOfProblems)] -
+                                 (accepted ? ref[(size_t)b*m + i] : 0)) <=
+                            1E-12);
+                }
+                if (accepted)
+                {
+                    b++;
+                }
+            }
+        }
+    }
+
+    setVecKernelIsa(startIsa);
+
+    return(pass);
+}
+
+/**
+********************************************************************************
+** @details Print the result of a test
+** @param   pName   Name of the test
+** @param   pass    Result of the test
+** @return  1 if the test failed, and 0 otherwise
+********************************************************************************
+*/
+static UINT32 report(const char* pName, const bool& pass)
+{
+    printf("%s %s\n",pass ? "PASS" : "FAIL",pName);
+
+    return(pass ? 0 : 1);
+}
+
+/**
+********************************************************************************
+** @details This is the entry point for the library regression tests.
+** @return  EXIT_SUCCESS if every test passed, and EXIT_FAILURE otherwise
+********************************************************************************
+*/
+int main(void)
+{
+    UINT32 noOfFailed = 0;
+
+    noOfFailed += report("Vector move out of an arena scope",
+                         testVectorArenaMove());
+    noOfFailed += report("Matrix move out of an arena scope",
+                         testMatrixArenaMove());
+    noOfFailed += report("Matrix adopting an unpadded buffer",
+                         testMatrixAdoptPadding());
+    noOfFailed += report("Orthonormalization with an overstated rank",
+                         testRankOverstated());
+    noOfFailed += report("GEMM against a naive product",
+                         testGemmRandom());
+    noOfFailed += report("Batched kernels against orthonormalize()",
+                         testBatchedKernels());
+
+    return((0 == noOfFailed) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,136 @@
+/**
+********************************************************************************
+** @file    TextLoader.hh
+**
+** @brief   Declaration of the text vector set loader
+**
+** @details Vector sets written as text, with one vector per line and the
+**          elements separated by commas or white space, are loaded into
+**          contiguous vector storage by the TextLoader class declared here.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  TextLoader.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _TEXT_LOADER_HH_
+#define _TEXT_LOADER_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstddef>
+
+#include "StdTypes.hh"
+#include "VecFile.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/*
+** Text vector set format
+**
+** Each line of the file holds one vector, and every vector has the same
+** number of elements. The elements are decimal numbers, optionally in
+** exponent notation, separated by any mix of commas, spaces, and tabs. Lines
+** with no elements are skipped, and both Unix and DOS line endings are read.
+**
+**   1, 2, 3, 4
+**   -1 2 4 1
+**   2.0e0,0,5,-7
+*/
+
+/**
+********************************************************************************
+** @def   TEXTLOAD_CHUNK_SIZE
+** @brief Nominal number of bytes of text parsed by each task
+********************************************************************************
+*/
+#define TEXTLOAD_CHUNK_SIZE (4 << 20)
+
+/**
+********************************************************************************
+** @class   TextLoader
+** @brief   Parallel loader of text vector sets
+** @details The file is mapped and parsed in windows of one chunk per task.
+**          Each window is parsed twice by the thread pool: the first pass
+**          counts the vectors in each chunk, which gives every chunk the index
+**          of its first vector, and the second pass parses the elements
+**          straight into their place in the vector storage. The text of a
+**          window is still in memory for the second pass, so the file is only
+**          read from disk once. The vectors are stored as in a vector set
+**          file, aligned and padded with zeros, until the loader is cleared.
+********************************************************************************
+*/
+class TextLoader
+{
+    private:
+        char* pStore;       /* Start of the vector storage mapping */
+        size_t storeSize;   /* Number of bytes of vector storage mapped */
+
+        double* pVecs;      /* First vector of the set */
+        UINT32 ndims;       /* Dimension of each vector */
+        UINT32 noOfVecs;    /* Number of vectors */
+        UINT32 ld;          /* Leading dimension in elements */
+
+        /*
+        ** Copy constructor and assignment (disabled)
+        */
+        TextLoader(const TextLoader& loader);
+        TextLoader& operator=(const TextLoader& rhs);
+
+    public:
+
+        /*
+        ** Constructor (no parameters)
+        */
+        TextLoader();
+
+        /*
+        ** Destructor
+        */
+        ~TextLoader();
+
+        /*
+        ** Load a text vector set file
+        */
+        void load(const char* path, const UINT32& align = VECFILE_ALIGN);
+
+        /*
+        ** Release the vector storage
+        */
+        void clear(void);
+
+        /*
+        ** Access methods
+        */
+        double* getVecs(void) const;
+        UINT32 getDims(void) const;
+        UINT32 getCount(void) const;
+        UINT32 getLeadDim(void) const;
+};
+
+#endif
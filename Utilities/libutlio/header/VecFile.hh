@@ -0,0 +1,259 @@
+/**
+********************************************************************************
+** @file    VecFile.hh
+**
+** @brief   Declaration of the vector set file container
+**
+** @details A vector set file holds a header describing the set followed by
+**          the raw vector elements, laid out exactly as the
+**          orthonormalization routines expect them in memory. A file is
+**          memory-mapped, so the routines run directly on the mapped pages
+**          without parsing or copying the elements.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  VecFile.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _VEC_FILE_HH_
+#define _VEC_FILE_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstddef>
+
+#include "StdTypes.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/*
+** Vector set file format
+**
+** A vector set file starts with a VECFILE_HEADER_SIZE byte header, stored as
+** the VecFileHeader structure in the byte order of the machine that wrote it.
+** The vector data starts at byte dataOffset, which is a multiple of align.
+** The elements of vector j are contiguous and start at element j*ld of the
+** data, where the leading dimension ld is at least ndims and ld*8 is a
+** multiple of align, so every vector starts on an aligned boundary. The
+** elements between ndims and ld of each vector are padding and are zero. The
+** file is mapped from a page boundary, so align is at most the page size.
+**
+** A result file written by writeVecFile() also records the rank of the
+** source vector set and the number of vectors in it. When indexOffset is not
+** zero, it is the byte offset of noOfVecs UINT32 values after the vector data,
+** giving the index in the source set of each vector in the file. Input files
+** leave these fields zero.
+**
+**   Offset  Size  Field
+**        0     8  magic       "GSVECSET"
+**        8     4  version     VECFILE_VERSION
+**       12     4  byteOrder   VECFILE_BYTE_ORDER as written by the producer
+**       16     4  dtype       VecFileDtype of the elements
+**       20     4  layout      VecFileLayout of the elements
+**       24     4  align       Alignment in bytes, a power of two of at least 8
+**       28     4  ndims       Dimension of each vector
+**       32     4  noOfVecs    Number of vectors
+**       36     4  ld          Leading dimension in elements
+**       40     8  dataOffset  Byte offset of the vector data
+**       48     4  rank        Rank of the source set, or zero
+**       52     4  srcCount    Number of vectors in the source set, or zero
+**       56     8  indexOffset Byte offset of the source indices, or zero
+**       64    64  reserved    Zero
+*/
+
+/**
+********************************************************************************
+** @def   VECFILE_MAGIC
+** @brief First eight bytes of every vector set file
+********************************************************************************
+*/
+#define VECFILE_MAGIC "GSVECSET"
+
+/**
+********************************************************************************
+** @def   VECFILE_VERSION
+** @brief Version of the vector set file format
+********************************************************************************
+*/
+#define VECFILE_VERSION 1
+
+/**
+********************************************************************************
+** @def   VECFILE_BYTE_ORDER
+** @brief Marker that reads back unchanged only on a machine with the byte
+**        order of the producer
+********************************************************************************
+*/
+#define VECFILE_BYTE_ORDER 0x01020304
+
+/**
+********************************************************************************
+** @def   VECFILE_HEADER_SIZE
+** @brief Number of bytes in the file header
+********************************************************************************
+*/
+#define VECFILE_HEADER_SIZE 128
+
+/**
+********************************************************************************
+** @def   VECFILE_ALIGN
+** @brief Default alignment in bytes of the vectors in a new file
+********************************************************************************
+*/
+#define VECFILE_ALIGN 64
+
+/**
+********************************************************************************
+** @enum    VecFileDtype
+** @brief   Element types of a vector set file
+********************************************************************************
+*/
+enum VecFileDtype {VECFILE_FLOAT64 = 1};    /**< IEEE 754 double */
+
+/**
+********************************************************************************
+** @enum    VecFileLayout
+** @brief   Element layouts of a vector set file
+********************************************************************************
+*/
+enum VecFileLayout {VECFILE_BY_VECTOR = 1}; /**< Vectors are contiguous */
+
+/**
+********************************************************************************
+** @enum    VecFileMode
+** @brief   Ways to map an existing vector set file
+********************************************************************************
+*/
+enum VecFileMode {VECFILE_PRIVATE,  /**< Changes stay in memory, and only the
+                                    **   pages written are copied */
+                  VECFILE_SHARED};  /**< Changes are written to the file */
+
+/**
+********************************************************************************
+** @struct  VecFileHeader
+** @brief   Header at the start of a vector set file
+********************************************************************************
+*/
+struct VecFileHeader
+{
+    char magic[8];       /* VECFILE_MAGIC, without a terminating null */
+    UINT32 version;      /* VECFILE_VERSION */
+    UINT32 byteOrder;    /* VECFILE_BYTE_ORDER */
+    UINT32 dtype;        /* Element type */
+    UINT32 layout;       /* Element layout */
+    UINT32 align;        /* Alignment in bytes */
+    UINT32 ndims;        /* Dimension of each vector */
+    UINT32 noOfVecs;     /* Number of vectors */
+    UINT32 ld;           /* Leading dimension in elements */
+    UINT64 dataOffset;   /* Byte offset of the vector data */
+    UINT32 rank;         /* Rank of the source set */
+    UINT32 srcCount;     /* Number of vectors in the source set */
+    UINT64 indexOffset;  /* Byte offset of the source indices */
+    UINT32 reserved[16]; /* Zero */
+};
+
+static_assert(sizeof(VecFileHeader) == VECFILE_HEADER_SIZE,
+              "VecFileHeader does not match the file format");
+
+/**
+********************************************************************************
+** @class   VecFile
+** @brief   Memory-mapped vector set file
+** @details An existing file is mapped with open() and a new one is created and
+**          mapped with create(). The vectors are accessed in place through
+**          getVecs() and getLeadDim() until the file is closed.
+********************************************************************************
+*/
+class VecFile
+{
+    private:
+        INT32 fd;               /* File descriptor, or -1 */
+
+        char* pMap;             /* Start of the mapping */
+        size_t mapSize;         /* Number of bytes mapped */
+
+        VecFileHeader* pHeader; /* Header of the mapped file */
+        double* pVecs;          /* First vector of the mapped file */
+
+        /*
+        ** Map the open file
+        */
+        void map(const char* path, const bool& shared);
+
+        /*
+        ** Check the header of the mapped file
+        */
+        void checkHeader(const char* path) const;
+
+        /*
+        ** Copy constructor and assignment (disabled)
+        */
+        VecFile(const VecFile& file);
+        VecFile& operator=(const VecFile& rhs);
+
+    public:
+
+        /*
+        ** Constructor (no parameters)
+        */
+        VecFile();
+
+        /*
+        ** Destructor
+        */
+        ~VecFile();
+
+        /*
+        ** Map an existing file
+        */
+        void open(const char* path, const VecFileMode& mode = VECFILE_PRIVATE);
+
+        /*
+        ** Create and map a new file of zero vectors
+        */
+        void create(const char* path, const UINT32& m, const UINT32& n,
+                    const UINT32& align = VECFILE_ALIGN);
+
+        /*
+        ** Unmap and close the file
+        */
+        void close(void);
+
+        /*
+        ** Access methods
+        */
+        double* getVecs(void) const;
+        UINT32 getDims(void) const;
+        UINT32 getCount(void) const;
+        UINT32 getLeadDim(void) const;
+        UINT32 getRank(void) const;
+        UINT32 getSourceCount(void) const;
+        const UINT32* getIndices(void) const;
+};
+
+#endif
@@ -0,0 +1,417 @@
+/**
+********************************************************************************
+** @file    VecService.hh
+**
+** @brief   Declaration of the orthonormalization service
+**
+** @details A resident server that solves vector set problems for other
+**          processes over a Unix domain socket, with the vectors passed in
+**          shared memory, is declared here along with the client used to
+**          reach it.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  VecService.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _VEC_SERVICE_HH_
+#define _VEC_SERVICE_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstddef>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "StdTypes.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/*
+** Service protocol
+**
+** Clients connect to the server with a SOCK_SEQPACKET Unix domain socket and
+** exchange fixed size messages in the byte order of the machine. Every
+** VecRequest is answered with a VecReply carrying the tag of the request.
+**
+** A client first attaches a block of shared memory to its connection with a
+** VECSVC_ATTACH request, passing a memfd sealed with F_SEAL_SHRINK as
+** SCM_RIGHTS ancillary data and its size in the size field. The server maps
+** it once, and later requests name their vectors by byte offset into it, so
+** the vectors are never copied. The elements of vector j of a request start
+** at dataOffset + 8*j*lda, and the result of a VECSVC_ORTHONORMALIZE request
+** is written in place: the basis replaces the first vectors and the index of
+** the source vector of each basis vector is written as a UINT32 at
+** indexOffset. A VECSVC_RANK request leaves the vectors unchanged. A request
+** of more than VECSVC_MAX_VECS vectors or with a leading dimension above
+** VECSVC_MAX_DIMS is answered with VECSVC_INVALID, and vectors the solver
+** cannot resolve with VECSVC_UNSOLVED.
+**
+** Requests from every connection are queued and solved in micro-batches on
+** the thread pool. When the queue is full the server stops reading from the
+** sockets until it drains, so clients block in send instead of failing.
+*/
+
+/**
+********************************************************************************
+** @def   VECSVC_QUEUE_DEPTH
+** @brief Largest number of requests queued for solving
+********************************************************************************
+*/
+#define VECSVC_QUEUE_DEPTH 4096
+
+/**
+********************************************************************************
+** @def   VECSVC_BATCH_SIZE
+** @brief Largest number of requests in a micro-batch
+********************************************************************************
+*/
+#define VECSVC_BATCH_SIZE 256
+
+/**
+********************************************************************************
+** @def   VECSVC_BATCH_USEC
+** @brief Microseconds a partial micro-batch waits for more requests
+********************************************************************************
+*/
+#define VECSVC_BATCH_USEC 100
+
+/**
+********************************************************************************
+** @def   VECSVC_CONN_DEPTH
+** @brief Largest number of requests of one connection queued or being solved,
+**        so one client cannot fill the queue or the socket buffer of its
+**        replies
+********************************************************************************
+*/
+#define VECSVC_CONN_DEPTH 64
+
+/**
+********************************************************************************
+** @def   VECSVC_MAX_CONNS
+** @brief Largest number of client connections
+********************************************************************************
+*/
+#define VECSVC_MAX_CONNS 256
+
+/**
+********************************************************************************
+** @def   VECSVC_MAX_VECS
+** @brief Largest number of vectors in a request, which bounds the n x n
+**        Grammian a solver may form to 128 MB
+********************************************************************************
+*/
+#define VECSVC_MAX_VECS 4096
+
+/**
+********************************************************************************
+** @def   VECSVC_MAX_DIMS
+** @brief Largest vector dimension or leading dimension of a request
+********************************************************************************
+*/
+#define VECSVC_MAX_DIMS (1 << 24)
+
+/**
+********************************************************************************
+** @enum    VecServiceOp
+** @brief   Operations of a service request
+********************************************************************************
+*/
+enum VecServiceOp {VECSVC_ATTACH = 1,           /**< Attach shared memory */
+                   VECSVC_ORTHONORMALIZE,       /**< Orthonormalize in place */
+                   VECSVC_RANK};                /**< Rank of the vectors */
+
+/**
+********************************************************************************
+** @enum    VecServiceStatus
+** @brief   Status of a service reply
+********************************************************************************
+*/
+enum VecServiceStatus {VECSVC_OK,               /**< Request was solved */
+                       VECSVC_INVALID,          /**< Request was malformed or
+                                                **   outside shared memory */
+                       VECSVC_FAILED,           /**< Server could not map the
+                                                **   shared memory or allocate
+                                                **   the solver workspace */
+                       VECSVC_UNSOLVED};        /**< Vectors are numerically
+                                                **   rank deficient beyond what
+                                                **   the solver can resolve */
+
+/**
+********************************************************************************
+** @struct  VecRequest
+** @brief   Message from a client to the server
+********************************************************************************
+*/
+struct VecRequest
+{
+    UINT32 op;          /* VecServiceOp */
+    UINT32 ndims;       /* Dimension of each vector */
+    UINT32 noOfVecs;    /* Number of vectors */
+    UINT32 lda;         /* Leading dimension of the vectors */
+    UINT64 dataOffset;  /* Byte offset of the vectors in shared memory */
+    UINT64 indexOffset; /* Byte offset of the source indices */
+    UINT64 size;        /* Bytes of shared memory, for VECSVC_ATTACH */
+    UINT64 tag;         /* Returned in the reply */
+};
+
+/**
+********************************************************************************
+** @struct  VecReply
+** @brief   Message from the server to a client
+********************************************************************************
+*/
+struct VecReply
+{
+    UINT64 tag;         /* Tag of the request */
+    UINT32 status;      /* VecServiceStatus */
+    UINT32 result;      /* Number of basis vectors, or rank */
+};
+
+/*
+** Solver of one request, called on any thread of the pool with the vectors
+** and, for VECSVC_ORTHONORMALIZE, the source indices in shared memory. It
+** returns the VecServiceStatus of the reply and sets its result, and must not
+** end the process for a request it cannot solve.
+*/
+typedef std::function<UINT32(const VecRequest& request, double* pVecs,
+                             UINT32* pIndices, UINT32& result)> VecHandler;
+
+/**
+********************************************************************************
+** @struct  VecConnection
+** @brief   Client connection of the server
+********************************************************************************
+*/
+struct VecConnection
+{
+    INT32 sock;                         /* Socket, or -1 for a free slot */
+    char* pShared;                      /* Attached shared memory, or NULL */
+    size_t sharedSize;                  /* Bytes of shared memory */
+    std::atomic<UINT32> outstanding;    /* Requests queued or being solved */
+    bool closing;                       /* Close once nothing is outstanding */
+};
+
+/**
+********************************************************************************
+** @struct  VecPending
+** @brief   Request waiting to be solved, and its reply
+********************************************************************************
+*/
+struct VecPending
+{
+    VecRequest request;     /* Request */
+    VecConnection* pConn;   /* Connection of the request */
+    VecReply reply;         /* Reply, filled in by the solver */
+};
+
+/**
+********************************************************************************
+** @class   VecServer
+** @brief   Orthonormalization server on a Unix domain socket
+** @details run() reads requests from every client on the calling thread and
+**          queues them. A dispatch thread takes them off the queue in
+**          micro-batches of up to VECSVC_BATCH_SIZE, waiting up to
+**          VECSVC_BATCH_USEC for a partial batch to fill, solves each batch
+**          in parallel on the thread pool, and sends the replies.
+********************************************************************************
+*/
+class VecServer
+{
+    private:
+        INT32 listenSock;                   /* Listening socket */
+        INT32 wakeFd;                       /* eventfd that wakes run() */
+        const char* path;                   /* Socket path */
+        VecHandler handler;                 /* Request solver */
+
+        VecConnection* pConns;              /* Connection slots */
+
+        VecPending* pQueue;                 /* Ring of queued requests */
+        UINT32 queueHead;                   /* First queued request */
+        UINT32 queueCount;                  /* Number of queued requests */
+        std::mutex queueLock;               /* Protects the queue */
+        std::condition_variable queued;     /* Signals queued requests */
+
+        std::thread dispatcher;             /* Dispatch thread */
+        std::atomic<bool> stopping;         /* Server is asked to stop */
+
+        std::atomic<UINT64> noOfRequests;   /* Requests solved */
+        std::atomic<UINT64> noOfBatches;    /* Micro-batches solved */
+
+        /*
+        ** Wake run() from another thread or a signal handler
+        */
+        void wake(void);
+
+        /*
+        ** Send a reply on a connection
+        */
+        static void sendReply(VecConnection& conn, const VecReply& reply);
+
+        /*
+        ** Accept a new client connection
+        */
+        void acceptClient(void);
+
+        /*
+        ** Read and handle the requests waiting on a connection
+        */
+        void readRequests(VecConnection& conn);
+
+        /*
+        ** Attach shared memory to a connection
+        */
+        UINT32 attach(VecConnection& conn, const VecRequest& request,
+                      const INT32& memFd);
+
+        /*
+        ** Check a request is within the size limits and the shared memory of
+        ** its connection
+        */
+        static bool checkRequest(const VecConnection& conn,
+                                 const VecRequest& request);
+
+        /*
+        ** Close a connection and release its shared memory
+        */
+        static void closeConn(VecConnection& conn);
+
+        /*
+        ** Body of the dispatch thread
+        */
+        void dispatchLoop(void);
+
+        /*
+        ** Copy constructor and assignment (disabled)
+        */
+        VecServer(const VecServer& server);
+        VecServer& operator=(const VecServer& rhs);
+
+    public:
+
+        /*
+        ** Constructor (no parameters)
+        */
+        VecServer();
+
+        /*
+        ** Destructor
+        */
+        ~VecServer();
+
+        /*
+        ** Serve requests on a socket until requestStop() is called
+        */
+        void run(const char* socketPath, const VecHandler& solver);
+
+        /*
+        ** Ask run() to return, which is safe from a signal handler
+        */
+        void requestStop(void);
+
+        /*
+        ** Access methods
+        */
+        UINT64 getRequestCount(void) const;
+        UINT64 getBatchCount(void) const;
+};
+
+/**
+********************************************************************************
+** @class   VecClient
+** @brief   Client of the orthonormalization server
+** @details connect() creates and attaches the shared memory of the client.
+**          The vectors of each request are written to getShared() and solved
+**          in place with one blocking call per request.
+********************************************************************************
+*/
+class VecClient
+{
+    private:
+        INT32 sock;             /* Connection to the server */
+        char* pShared;          /* Shared memory */
+        size_t sharedSize;      /* Bytes of shared memory */
+        UINT64 nextTag;         /* Tag of the next request */
+
+        /*
+        ** Send a request and wait for its reply
+        */
+        UINT32 call(VecRequest& request, const INT32& memFd = -1);
+
+        /*
+        ** Copy constructor and assignment (disabled)
+        */
+        VecClient(const VecClient& client);
+        VecClient& operator=(const VecClient& rhs);
+
+    public:
+
+        /*
+        ** Constructor (no parameters)
+        */
+        VecClient();
+
+        /*
+        ** Destructor
+        */
+        ~VecClient();
+
+        /*
+        ** Connect to a server and attach shared memory of a given size
+        */
+        void connect(const char* socketPath, const size_t& size);
+
+        /*
+        ** Orthonormalize vectors in shared memory in place
+        */
+        UINT32 orthonormalize(const size_t& dataOffset, const UINT32& lda,
+                              const UINT32& m, const UINT32& n,
+                              const size_t& indexOffset);
+
+        /*
+        ** Rank of vectors in shared memory
+        */
+        UINT32 rank(const size_t& dataOffset, const UINT32& lda,
+                    const UINT32& m, const UINT32& n);
+
+        /*
+        ** Disconnect from the server
+        */
+        void close(void);
+
+        /*
+        ** Access methods
+        */
+        char* getShared(void) const;
+        size_t getSharedSize(void) const;
+};
+
+#endif
@@ -0,0 +1,375 @@
+/**
+********************************************************************************
+** @file    VecStream.hh
+**
+** @brief   Declaration of the problem stream reader and result stream writer
+**
+** @details A stream of length-prefixed vector set problems is read ahead by a
+**          background thread into batches, and the results of each batch are
+**          written to a result stream in problem order, by the classes
+**          declared here.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  VecStream.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _VEC_STREAM_HH_
+#define _VEC_STREAM_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstddef>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "StdTypes.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/*
+** Problem and result stream formats
+**
+** A problem stream starts with a VecStreamHeader holding VECSTREAM_MAGIC, and
+** a result stream with one holding VECRESULT_MAGIC. Both are followed by one
+** record per problem, in the byte order of the machine that wrote them.
+**
+** Each problem record is a VecRecordHeader followed by the ndims*noOfVecs
+** elements of the vector set as doubles, one vector after another. A record
+** header of two zeros, or the end of the input, ends the stream.
+**
+** Each result record, in the order of the problems, is a VecResultHeader
+** followed by the index in the problem of each of the rank basis vectors as
+** UINT32 values, four zero bytes if rank is odd, and the rank*ndims elements
+** of the basis as doubles, one vector after another. A problem that could not
+** be solved has the status VECRESULT_UNSOLVED and a rank of zero. That
+** includes a problem with no elements, and one too large to be read, whose
+** elements are skipped.
+*/
+
+/**
+********************************************************************************
+** @def   VECSTREAM_MAGIC
+** @brief First eight bytes of a problem stream
+********************************************************************************
+*/
+#define VECSTREAM_MAGIC "GSSTREAM"
+
+/**
+********************************************************************************
+** @def   VECRESULT_MAGIC
+** @brief First eight bytes of a result stream
+********************************************************************************
+*/
+#define VECRESULT_MAGIC "GSRESULT"
+
+/**
+********************************************************************************
+** @def   VECSTREAM_VERSION
+** @brief Version of the problem and result stream formats
+********************************************************************************
+*/
+#define VECSTREAM_VERSION 1
+
+/**
+********************************************************************************
+** @def   VECRESULT_SOLVED
+** @brief Status of a result record whose problem was solved
+********************************************************************************
+*/
+#define VECRESULT_SOLVED 0
+
+/**
+********************************************************************************
+** @def   VECRESULT_UNSOLVED
+** @brief Status of a result record whose problem is malformed, too large, or
+**        numerically rank deficient beyond what its method can resolve
+********************************************************************************
+*/
+#define VECRESULT_UNSOLVED 1
+
+/**
+********************************************************************************
+** @def   VECSTREAM_BATCH_PROBS
+** @brief Largest number of problems in a batch
+********************************************************************************
+*/
+#define VECSTREAM_BATCH_PROBS 4096
+
+/**
+********************************************************************************
+** @def   VECSTREAM_BATCH_BYTES
+** @brief Number of bytes of elements after which a batch is closed. A single
+**        larger problem gets a batch of its own.
+********************************************************************************
+*/
+#define VECSTREAM_BATCH_BYTES (32 << 20)
+
+/**
+********************************************************************************
+** @def   VECSTREAM_STAGE_SIZE
+** @brief Number of bytes read from the input at a time
+********************************************************************************
+*/
+#define VECSTREAM_STAGE_SIZE (1 << 20)
+
+/**
+********************************************************************************
+** @def   VECSTREAM_BUFFERS
+** @brief Number of batches, so one is read while the others are solved
+********************************************************************************
+*/
+#define VECSTREAM_BUFFERS 2
+
+/**
+********************************************************************************
+** @struct  VecStreamHeader
+** @brief   Header at the start of a problem or result stream
+********************************************************************************
+*/
+struct VecStreamHeader
+{
+    char magic[8];      /* VECSTREAM_MAGIC or VECRESULT_MAGIC */
+    UINT32 version;     /* VECSTREAM_VERSION */
+    UINT32 byteOrder;   /* VECFILE_BYTE_ORDER */
+};
+
+/**
+********************************************************************************
+** @struct  VecRecordHeader
+** @brief   Header of a problem record
+********************************************************************************
+*/
+struct VecRecordHeader
+{
+    UINT32 ndims;       /* Dimension of each vector */
+    UINT32 noOfVecs;    /* Number of vectors */
+};
+
+/**
+********************************************************************************
+** @struct  VecResultHeader
+** @brief   Header of a result record
+********************************************************************************
+*/
+struct VecResultHeader
+{
+    UINT32 ndims;       /* Dimension of each vector */
+    UINT32 rank;        /* Number of basis vectors */
+    UINT32 srcCount;    /* Number of vectors in the problem */
+    UINT32 status;      /* VECRESULT_SOLVED or VECRESULT_UNSOLVED */
+};
+
+/**
+********************************************************************************
+** @struct  VecProblem
+** @brief   Problem of a batch and its result
+********************************************************************************
+*/
+struct VecProblem
+{
+    UINT32 ndims;       /* Dimension of each vector */
+    UINT32 noOfVecs;    /* Number of vectors */
+    size_t dataOffset;  /* First element in the batch data */
+    size_t indexOffset; /* First index in the batch indices */
+    UINT32 noOfBasis;   /* Number of basis vectors, set by the solver */
+    UINT32 status;      /* Result status, set by the solver */
+    bool loaded;        /* Elements were read into the batch */
+};
+
+/**
+********************************************************************************
+** @struct  VecBatch
+** @brief   Batch of problems read from a stream
+** @details The vectors of each problem are stored unpadded in the batch data
+**          and are orthonormalized in place. A problem that is not loaded has
+**          no elements in the batch and is reported unsolved. The solver
+**          writes the source index of each basis vector to the batch indices.
+********************************************************************************
+*/
+struct VecBatch
+{
+    VecProblem* pProbs;     /* Problems of the batch */
+    UINT32 noOfProbs;       /* Number of problems */
+    UINT32 probCapacity;    /* Number of problems allocated */
+
+    double* pData;          /* Elements of every problem */
+    size_t dataSize;        /* Number of elements */
+    size_t dataCapacity;    /* Number of elements allocated */
+
+    UINT32* pIndices;       /* Source indices of every problem */
+    size_t indexSize;       /* Number of indices */
+    size_t indexCapacity;   /* Number of indices allocated */
+};
+
+/**
+********************************************************************************
+** @class   VecStreamReader
+** @brief   Problem stream reader with asynchronous read ahead
+** @details A background thread reads the stream into a ring of
+**          VECSTREAM_BUFFERS batches. next() hands out the batches in stream
+**          order, and the reader fills each one again once it is released, so
+**          the next batch is read while the current one is solved.
+********************************************************************************
+*/
+class VecStreamReader
+{
+    private:
+        INT32 fd;                           /* Input file descriptor */
+        bool ownFd;                         /* Close fd when finished */
+        const char* path;                   /* Name of the input */
+
+        char* pStage;                       /* Input read but not parsed */
+        size_t stageStart;                  /* First unparsed byte */
+        size_t stageEnd;                    /* One past the last byte read */
+
+        VecBatch batches[VECSTREAM_BUFFERS];/* Ring of batches */
+        bool full[VECSTREAM_BUFFERS];       /* Batch is ready to be solved */
+        UINT32 nextTake;                    /* Next batch for next() */
+
+        std::thread reader;                 /* Read ahead thread */
+        std::mutex lock;                    /* Protects the ring state */
+        std::condition_variable changed;    /* Signals ring state changes */
+        bool finished;                      /* No more batches will fill */
+        bool stopping;                      /* Reader is asked to stop */
+        char error[256];                    /* Read error, or empty */
+
+        /*
+        ** Read bytes from the input through the staging buffer
+        */
+        size_t readBytes(void* pDst, const size_t& size);
+
+        /*
+        ** Discard bytes of the input
+        */
+        UINT64 skipBytes(const UINT64& size);
+
+        /*
+        ** Fill a batch with the next problems of the stream
+        */
+        bool fillBatch(VecBatch& batch);
+
+        /*
+        ** Body of the read ahead thread
+        */
+        void readLoop(void);
+
+        /*
+        ** Copy constructor and assignment (disabled)
+        */
+        VecStreamReader(const VecStreamReader& streamReader);
+        VecStreamReader& operator=(const VecStreamReader& rhs);
+
+    public:
+
+        /*
+        ** Constructor (no parameters)
+        */
+        VecStreamReader();
+
+        /*
+        ** Destructor
+        */
+        ~VecStreamReader();
+
+        /*
+        ** Open a problem stream, or standard input for "-", and start
+        ** reading ahead
+        */
+        void open(const char* streamPath);
+
+        /*
+        ** Wait for the next batch, or return NULL at the end of the stream
+        */
+        VecBatch* next(void);
+
+        /*
+        ** Hand a solved batch back to be filled again
+        */
+        void release(VecBatch* pBatch);
+
+        /*
+        ** Stop reading and close the stream
+        */
+        void close(void);
+};
+
+/**
+********************************************************************************
+** @class   VecStreamWriter
+** @brief   Result stream writer
+** @details The results of a batch are gathered with writev straight from the
+**          batch, so the basis vectors are not copied on the way out.
+********************************************************************************
+*/
+class VecStreamWriter
+{
+    private:
+        INT32 fd;                   /* Output file descriptor */
+        bool ownFd;                 /* Close fd when finished */
+        const char* path;           /* Name of the output */
+
+        VecResultHeader* pHeaders;  /* Record headers of the current batch */
+        UINT32 headerCapacity;      /* Number of record headers allocated */
+
+        /*
+        ** Copy constructor and assignment (disabled)
+        */
+        VecStreamWriter(const VecStreamWriter& streamWriter);
+        VecStreamWriter& operator=(const VecStreamWriter& rhs);
+
+    public:
+
+        /*
+        ** Constructor (no parameters)
+        */
+        VecStreamWriter();
+
+        /*
+        ** Destructor
+        */
+        ~VecStreamWriter();
+
+        /*
+        ** Create a result stream, or write to standard output for "-"
+        */
+        void open(const char* streamPath);
+
+        /*
+        ** Write the results of a solved batch
+        */
+        void write(const VecBatch& batch);
+
+        /*
+        ** Close the stream
+        */
+        void close(void);
+};
+
+#endif
@@ -0,0 +1,105 @@
+/**
+********************************************************************************
+** @file    VecWriter.hh
+**
+** @brief   Declaration of the vector set output routines
+**
+** @details Routines that write an orthonormal basis to a binary vector set
+**          file, or format it as fixed-width text much faster than printing
+**          one element at a time, are declared here.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  VecWriter.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _VEC_WRITER_HH_
+#define _VEC_WRITER_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstdio>
+#include <climits>
+
+#include <sys/uio.h>
+
+#include "StdTypes.hh"
+#include "VecFile.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @def   VECTEXT_BLOCK_SIZE
+** @brief Nominal number of elements formatted by each task
+********************************************************************************
+*/
+#define VECTEXT_BLOCK_SIZE 16384
+
+/**
+********************************************************************************
+** @struct  IovList
+** @brief   Pieces of a file gathered for writev
+********************************************************************************
+*/
+struct IovList
+{
+    struct iovec vec[IOV_MAX];  /* Pieces not yet written */
+    UINT32 count;               /* Number of pieces */
+    INT32 fd;                   /* File descriptor */
+    const char* path;           /* Name of the file, for error messages */
+};
+
+/*
+** Write every gathered piece to a file
+*/
+void flushIov(IovList& list);
+
+/*
+** Gather a piece of a file, writing the gathered pieces first if the list is
+** full
+*/
+void appendIov(IovList& list, const void* pData, const size_t& size);
+
+/*
+** Write a vector set, and optionally the source index of each vector and the
+** rank of the source set, to a vector set file
+*/
+void writeVecFile(const char* path, const double* pVecs, const UINT32& lda,
+                  const UINT32& m, const UINT32& n, const UINT32* pIndices,
+                  const UINT32& rank, const UINT32& srcCount,
+                  const UINT32& align = VECFILE_ALIGN);
+
+/*
+** Write a vector set as fixed-width text, in the layout of Vector::objPrint()
+*/
+void writeVecText(FILE* pFile, const double* pVecs, const UINT32& lda,
+                  const UINT32& m, const UINT32& n, const UINT32& width = 12,
+                  const UINT32& decimals = 3);
+
+#endif
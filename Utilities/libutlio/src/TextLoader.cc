@@ -0,0 +1,998 @@
+/**
+********************************************************************************
+** @file    TextLoader.cc
+**
+** @brief   Implementation of the text vector set loader
+**
+** @details The text is split into chunks at line boundaries and the chunks
+**          are parsed in parallel by the thread pool. Elements are converted
+**          by a parser that handles the common case of a short decimal number
+**          exactly with one double multiply or divide, and only hands long or
+**          out of range numbers to strtod.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  TextLoader.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "TextLoader.hh"
+#include "ThreadPool.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @struct  TextChunk
+** @brief   Range of lines of the text parsed by one task
+********************************************************************************
+*/
+struct TextChunk
+{
+    const char* pBegin;     /* First character of the chunk */
+    const char* pEnd;       /* One past the last character of the chunk */
+    UINT64 first;           /* Index of the first vector of the chunk */
+    UINT64 count;           /* Number of vectors in the chunk */
+    UINT64 parsed;          /* Number of vectors parsed */
+    const char* pError;     /* Description of a parse error, or NULL */
+};
+
+/*
+** Powers of ten that are exactly representable as doubles
+*/
+static const double exactPow10[] = {1E0,  1E1,  1E2,  1E3,  1E4,  1E5,
+                                    1E6,  1E7,  1E8,  1E9,  1E10, 1E11,
+                                    1E12, 1E13, 1E14, 1E15, 1E16, 1E17,
+                                    1E18, 1E19, 1E20, 1E21, 1E22};
+
+/*
+** Range of decimal exponents converted with the table of powers of five
+*/
+#define POW5_MIN -64
+#define POW5_MAX 64
+
+/*
+** Number of 32-bit words in the integers used to build the table
+*/
+#define WIDE_WORDS 16
+
+/*
+** Powers of five, normalized to 128 bits as a high and low word
+*/
+static UINT64 pow5Table[POW5_MAX - POW5_MIN + 1][2];
+
+/*---------------------------[Wide Integer Helpers]---------------------------*/
+/**
+********************************************************************************
+** @details Number of significant bits in a wide integer
+** @param   pWide   Wide integer, least significant word first
+** @return  Number of bits
+********************************************************************************
+*/
+static UINT32 wideBitLength(const UINT32* pWide)
+{
+    for (INT32 w = WIDE_WORDS - 1; w >= 0; w--)
+    {
+        if (0 != pWide[w])
+        {
+            return(32*w + 32 - __builtin_clz(pWide[w]));
+        }
+    }
+
+    return(0);
+}
+
+/**
+********************************************************************************
+** @details Shift a wide integer one bit left or right in place
+** @param   pWide   Wide integer, least significant word first
+** @param   left    Shift left if true, otherwise right
+********************************************************************************
+*/
+static void wideShift(UINT32* pWide, const bool& left)
+{
+    if (left)
+    {
+        for (INT32 w = WIDE_WORDS - 1; w > 0; w--)
+        {
+            pWide[w] = (pWide[w] << 1) | (pWide[w - 1] >> 31);
+        }
+        pWide[0] <<= 1;
+    }
+    else
+    {
+        for (UINT32 w = 0; w < WIDE_WORDS - 1; w++)
+        {
+            pWide[w] = (pWide[w] >> 1) | (pWide[w + 1] << 31);
+        }
+        pWide[WIDE_WORDS - 1] >>= 1;
+    }
+}
+
+/**
+********************************************************************************
+** @details Multiply a wide integer by a small integer and add another in place
+** @param   pWide   Wide integer, least significant word first
+** @param   mul     Multiplier
+** @param   add     Addend
+********************************************************************************
+*/
+static void wideMulAdd(UINT32* pWide, const UINT32& mul, const UINT32& add)
+{
+    UINT64 carry = add;
+
+    for (UINT32 w = 0; w < WIDE_WORDS; w++)
+    {
+        carry += (UINT64)pWide[w]*mul;
+        pWide[w] = (UINT32)carry;
+        carry >>= 32;
+    }
+}
+
+/**
+********************************************************************************
+** @details Subtract a wide integer from another in place, if it is not larger
+** @param   pWide   Wide integer, least significant word first
+** @param   pSub    Wide integer to subtract
+** @return  true if pSub was subtracted
+********************************************************************************
+*/
+static bool wideSubtract(UINT32* pWide, const UINT32* pSub)
+{
+    INT64 borrow = 0;
+
+    for (INT32 w = WIDE_WORDS - 1; w >= 0; w--)
+    {
+        if (pWide[w] != pSub[w])
+        {
+            if (pWide[w] < pSub[w])
+            {
+                return(false);
+            }
+            break;
+        }
+    }
+
+    for (UINT32 w = 0; w < WIDE_WORDS; w++)
+    {
+        borrow += (INT64)pWide[w] - pSub[w];
+        pWide[w] = (UINT32)borrow;
+        borrow = (borrow < 0) ? -1 : 0;
+    }
+
+    return(true);
+}
+
+/**
+********************************************************************************
+** @details Build the table of powers of five used by the Eisel-Lemire
+**          conversion. Each entry holds the 128 most significant bits of
+**          5^q. For negative q it holds 2^b/5^-q rounded up, truncated to 128
+**          bits, as the conversion expects.
+** @return  true once the table is built
+********************************************************************************
+*/
+static bool buildPow5Table(void)
+{
+    UINT32 pow5[WIDE_WORDS];
+    UINT32 quotient[WIDE_WORDS];
+    UINT32 remainder[WIDE_WORDS];
+    UINT32 bits;
+
+    for (INT32 q = POW5_MIN; q <= POW5_MAX; q++)
+    {
+        memset(pow5,0,sizeof(pow5));
+        pow5[0] = 1;
+        for (INT32 k = 0; k < abs(q); k++)
+        {
+            wideMulAdd(pow5,5,0);
+        }
+
+        if (q >= 0)
+        {
+            memcpy(quotient,pow5,sizeof(quotient));
+        }
+        else
+        {
+            /*
+            ** Long division of 2^bits by 5^-q, one bit at a time
+            */
+            bits = wideBitLength(pow5);
+            bits = (q >= -27) ? bits + 127 : 2*bits + 128;
+            memset(quotient,0,sizeof(quotient));
+            memset(remainder,0,sizeof(remainder));
+            for (INT32 i = bits; i >= 0; i--)
+            {
+                wideShift(remainder,true);
+                remainder[0] |= (i == (INT32)bits);
+                wideShift(quotient,true);
+                quotient[0] |= wideSubtract(remainder,pow5);
+            }
+            wideMulAdd(quotient,1,1);
+        }
+
+        while (wideBitLength(quotient) < 128)
+        {
+            wideShift(quotient,true);
+        }
+
+        while (wideBitLength(quotient) > 128)
+        {
+            wideShift(quotient,false);
+        }
+
+        pow5Table[q - POW5_MIN][0] = ((UINT64)quotient[3] << 32) | quotient[2];
+        pow5Table[q - POW5_MIN][1] = ((UINT64)quotient[1] << 32) | quotient[0];
+    }
+
+    return(true);
+}
+
+static const bool pow5Ready = buildPow5Table();
+
+/*---------------------------[Number Conversion]------------------------------*/
+/**
+********************************************************************************
+** @details Check whether a character separates the elements of a vector
+** @param   c   Character
+** @return  true if c is a separator
+********************************************************************************
+*/
+static inline bool isSeparator(const char& c)
+{
+    return(',' == c || ' ' == c || '\t' == c || '\r' == c);
+}
+
+/**
+********************************************************************************
+** @details Check whether a character is a decimal digit
+** @param   c   Character
+** @return  true if c is a digit
+********************************************************************************
+*/
+static inline bool isDigit(const char& c)
+{
+    return((UINT32)(c - '0') < 10);
+}
+
+/**
+********************************************************************************
+** @details Find the start of the line following a position in the text
+** @param   pChar   Position in the text
+** @param   pEnd    One past the last character of the text
+** @return  Start of the next line, or pEnd
+********************************************************************************
+*/
+static const char* nextLine(const char* pChar, const char* pEnd)
+{
+    const void* pNewLine;
+
+    if (pChar >= pEnd)
+    {
+        return(pEnd);
+    }
+
+    pNewLine = memchr(pChar,'\n',pEnd - pChar);
+
+    return((NULL == pNewLine) ? pEnd
+                              : static_cast<const char*>(pNewLine) + 1);
+}
+
+/**
+********************************************************************************
+** @details Convert a number the fast parser does not handle with strtod. The
+**          number is copied out of the text first, since the text is not null
+**          terminated. Short numbers are copied to the stack, and numbers of
+**          any other length, such as long mantissas written by other tools,
+**          to the heap.
+** @param   pChar   Start of the number, advanced past it on success
+** @param   pEnd    One past the last character of the text
+** @param   value   Converted number
+** @return  true if the whole number was converted
+********************************************************************************
+*/
+static bool parseDoubleSlow(const char*& pChar, const char* pEnd,
+                            double& value)
+{
+    char local[64];
+    char* pNumber;
+    char* pStop;
+
+    size_t length = 0;
+
+    bool converted;
+
+    while (pChar + length < pEnd && '\n' != pChar[length] &&
+           !isSeparator(pChar[length]))
+    {
+        length++;
+    }
+
+    if (0 == length)
+    {
+        return(false);
+    }
+
+    pNumber = (length < sizeof(local)) ? local : new char [length + 1];
+    memcpy(pNumber,pChar,length);
+    pNumber[length] = '\0';
+
+    value = strtod(pNumber,&pStop);
+    converted = (pStop == pNumber + length);
+
+    if (pNumber != local)
+    {
+        delete[] pNumber;
+    }
+
+    if (converted)
+    {
+        pChar += length;
+    }
+
+    return(converted);
+}
+
+/**
+********************************************************************************
+** @details Convert a decimal number of up to 19 significant digits with the
+**          Eisel-Lemire algorithm. The mantissa is normalized and multiplied
+**          by the 128-bit power of five of the exponent, which gives enough
+**          bits of the product to round it to a double correctly, including
+**          ties to even.
+** @param   mantissa    Nonzero decimal mantissa
+** @param   exponent    Decimal exponent, from POW5_MIN to POW5_MAX
+** @return  Correctly rounded value of mantissa*10^exponent
+********************************************************************************
+*/
+static double convertLemire(const UINT64& mantissa, const INT32& exponent)
+{
+    const UINT64* pPow5 = pow5Table[exponent - POW5_MIN];
+
+    unsigned __int128 product;
+
+    UINT64 scaled;
+    UINT64 high;
+    UINT64 low;
+    UINT64 extra;
+    UINT64 bits;
+    INT32 leadZeros;
+    INT32 upperBit;
+    INT32 shift;
+    INT32 power2;
+
+    double value;
+
+    leadZeros = __builtin_clzll(mantissa);
+    scaled = mantissa << leadZeros;
+
+    product = (unsigned __int128)scaled*pPow5[0];
+    high = (UINT64)(product >> 64);
+    low = (UINT64)product;
+
+    /*
+    ** Only when the bits below the rounding position are all ones can the low
+    ** word of the power change the result
+    */
+    if (0x1FF == (high & 0x1FF))
+    {
+        extra = (UINT64)(((unsigned __int128)scaled*pPow5[1]) >> 64);
+        low += extra;
+        high += (extra > low);
+    }
+
+    upperBit = (INT32)(high >> 63);
+    shift = upperBit + 64 - 52 - 3;
+    bits = high >> shift;
+    power2 = (((152170 + 65536)*exponent) >> 16) + 63 + upperBit - leadZeros +
+             1023;
+
+    /*
+    ** An exact halfway case rounds to even
+    */
+    if (low <= 1 && exponent >= -4 && exponent <= 23 && 1 == (bits & 3) &&
+        (bits << shift) == high)
+    {
+        bits &= ~1ULL;
+    }
+
+    bits += (bits & 1);
+    bits >>= 1;
+    if (bits >= (2ULL << 52))
+    {
+        bits = 1ULL << 52;
+        power2++;
+    }
+
+    bits = (bits & ~(1ULL << 52)) | ((UINT64)power2 << 52);
+    memcpy(&value,&bits,sizeof(value));
+
+    return(value);
+}
+
+/**
+********************************************************************************
+** @details Convert a decimal number in the text. Up to 19 significant digits
+**          are gathered in a 64-bit integer mantissa with a decimal exponent.
+**          When the mantissa is below 2^53 and the exponent is within 22 of
+**          zero, both the mantissa and the power of ten are exact doubles, so
+**          one multiply or divide gives the correctly rounded value. Longer
+**          mantissas, such as those of numbers printed with %.17g, are
+**          converted with the Eisel-Lemire algorithm. Every other number,
+**          including inf and nan, is converted by strtod.
+** @param   pChar   Start of the number, advanced past it on success
+** @param   pEnd    One past the last character of the text
+** @param   value   Converted number
+** @return  true if the number was converted and is followed by a separator,
+**          a new line, or the end of the text
+********************************************************************************
+*/
+static bool parseDouble(const char*& pChar, const char* pEnd, double& value)
+{
+    const char* p = pChar;
+
+    UINT64 mantissa = 0;
+    UINT32 noOfDigits = 0;
+    UINT32 sigDigits = 0;
+    INT32 exponent = 0;
+    INT32 expValue = 0;
+
+    bool negative = false;
+    bool expNegative = false;
+    bool truncated = false;
+
+    if (p < pEnd && ('-' == *p || '+' == *p))
+    {
+        negative = ('-' == *p);
+        p++;
+    }
+
+    for (; p < pEnd && isDigit(*p); p++, noOfDigits++)
+    {
+        if (sigDigits < 19)
+        {
+            mantissa = 10*mantissa + (*p - '0');
+            sigDigits += (0 != mantissa);
+        }
+        else
+        {
+            truncated = true;
+            exponent++;
+        }
+    }
+
+    if (p < pEnd && '.' == *p)
+    {
+        for (p++; p < pEnd && isDigit(*p); p++, noOfDigits++)
+        {
+            if (sigDigits < 19)
+            {
+                mantissa = 10*mantissa + (*p - '0');
+                sigDigits += (0 != mantissa);
+                exponent--;
+            }
+            else
+            {
+                truncated = true;
+            }
+        }
+    }
+
+    if (0 == noOfDigits)
+    {
+        return(parseDoubleSlow(pChar,pEnd,value));
+    }
+
+    if (p < pEnd && ('e' == *p || 'E' == *p))
+    {
+        p++;
+        if (p < pEnd && ('-' == *p || '+' == *p))
+        {
+            expNegative = ('-' == *p);
+            p++;
+        }
+
+        if (p == pEnd || !isDigit(*p))
+        {
+            return(false);
+        }
+
+        for (; p < pEnd && isDigit(*p); p++)
+        {
+            if (expValue < 100000)
+            {
+                expValue = 10*expValue + (*p - '0');
+            }
+        }
+
+        exponent += expNegative ? -expValue : expValue;
+    }
+
+    if (p < pEnd && '\n' != *p && !isSeparator(*p))
+    {
+        return(false);
+    }
+
+    if (mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22)
+    {
+        value = (exponent < 0) ? mantissa/exactPow10[-exponent]
+                               : mantissa*exactPow10[exponent];
+    }
+    else if (!truncated && 0 != mantissa && exponent >= POW5_MIN &&
+             exponent <= POW5_MAX)
+    {
+        value = convertLemire(mantissa,exponent);
+    }
+    else
+    {
+        return(parseDoubleSlow(pChar,pEnd,value));
+    }
+
+    value = negative ? -value : value;
+    pChar = p;
+
+    return(true);
+}
+
+/**
+********************************************************************************
+** @details Count the elements on the first line of the text that has any
+** @param   pChar   Start of the text
+** @param   pEnd    One past the last character of the text
+** @return  Number of elements, or 0 if the text has none
+********************************************************************************
+*/
+static UINT32 countElements(const char* pChar, const char* pEnd)
+{
+    UINT32 count = 0;
+
+    while (pChar < pEnd && 0 == count)
+    {
+        while (pChar < pEnd && '\n' != *pChar)
+        {
+            if (isSeparator(*pChar))
+            {
+                pChar++;
+            }
+            else
+            {
+                count++;
+                while (pChar < pEnd && '\n' != *pChar && !isSeparator(*pChar))
+                {
+                    pChar++;
+                }
+            }
+        }
+
+        if (pChar < pEnd)
+        {
+            pChar++;
+        }
+    }
+
+    return(count);
+}
+
+/**
+********************************************************************************
+** @details Count the vectors in a chunk, which are its lines with anything
+**          other than separators on them
+** @param   chunk   Chunk of text
+** @return  Number of vectors
+********************************************************************************
+*/
+static UINT64 countVecs(const TextChunk& chunk)
+{
+    const char* pChar = chunk.pBegin;
+    const char* pLineEnd;
+
+    UINT64 count = 0;
+
+    while (pChar < chunk.pEnd)
+    {
+        pLineEnd = nextLine(pChar,chunk.pEnd);
+        while (pChar < pLineEnd && isSeparator(*pChar))
+        {
+            pChar++;
+        }
+
+        if (pChar < pLineEnd && '\n' != *pChar)
+        {
+            count++;
+        }
+
+        pChar = pLineEnd;
+    }
+
+    return(count);
+}
+
+/**
+********************************************************************************
+** @details Parse the vectors in a chunk into the vector storage. Parsing stops
+**          at the first error, which is recorded in the chunk.
+** @param   chunk   Chunk of text
+** @param   pVec    Storage of the first vector of the chunk
+** @param   ndims   Dimension of each vector
+** @param   ld      Leading dimension of the vector storage
+********************************************************************************
+*/
+static void parseVecs(TextChunk& chunk, double* pVec, const UINT32& ndims,
+                      const UINT32& ld)
+{
+    const char* pChar = chunk.pBegin;
+    const char* pEnd = chunk.pEnd;
+
+    UINT32 noOfValues;
+
+    chunk.parsed = 0;
+    chunk.pError = NULL;
+
+    while (pChar < pEnd)
+    {
+        noOfValues = 0;
+        for (;;)
+        {
+            while (pChar < pEnd && isSeparator(*pChar))
+            {
+                pChar++;
+            }
+
+            if (pChar == pEnd || '\n' == *pChar)
+            {
+                break;
+            }
+
+            if (noOfValues == ndims)
+            {
+                chunk.pError = "more elements than the first vector";
+                return;
+            }
+
+            if (!parseDouble(pChar,pEnd,pVec[noOfValues]))
+            {
+                chunk.pError = "an invalid number";
+                return;
+            }
+
+            noOfValues++;
+        }
+
+        if (noOfValues > 0)
+        {
+            if (noOfValues < ndims)
+            {
+                chunk.pError = "fewer elements than the first vector";
+                return;
+            }
+
+            pVec += ld;
+            chunk.parsed++;
+        }
+
+        if (pChar < pEnd)
+        {
+            pChar++;
+        }
+    }
+}
+
+/*----------------------------[TextLoader Methods]----------------------------*/
+/**
+********************************************************************************
+** @details TextLoader class constructor
+********************************************************************************
+*/
+TextLoader::TextLoader()
+{
+    pStore = NULL;
+    storeSize = 0;
+    pVecs = NULL;
+    ndims = 0;
+    noOfVecs = 0;
+    ld = 0;
+}
+
+/**
+********************************************************************************
+** @details TextLoader destructor
+********************************************************************************
+*/
+TextLoader::~TextLoader()
+{
+    clear();
+}
+
+/**
+********************************************************************************
+** @details Load a text vector set file. The dimension of the vectors is set by
+**          the first vector in the file. Each vector takes at least two
+**          characters per element, which bounds the number of vectors, so the
+**          vector storage is reserved once as an anonymous mapping of that
+**          size and the unused end is released when the whole file has been
+**          parsed. Only the pages the vectors are written to are ever backed
+**          by memory.
+** @param   path    Name of the file
+** @param   align   Alignment in bytes of each vector, a power of two of at
+**                  least 8
+********************************************************************************
+*/
+void TextLoader::load(const char* path, const UINT32& align)
+{
+    struct stat fileStat;
+
+    INT32 fd;
+    UINT32 noOfChunks;
+
+    size_t textSize;
+    size_t windowSize;
+    size_t pageSize;
+    size_t used;
+    UINT64 maxVecs;
+    UINT64 total;
+
+    const char* pText;
+    const char* pEnd;
+    const char* pPos;
+    const char* pWindow;
+    void* pMem;
+
+    TextChunk* pChunks;
+
+    clear();
+
+    if (align < sizeof(double) || 0 != (align & (align - 1)))
+    {
+        printf("Error - %s\n"
+               "        Invalid vector alignment %u\n",
+               __PRETTY_FUNCTION__,align);
+        exit(EXIT_FAILURE);
+    }
+
+    fd = ::open(path,O_RDONLY);
+    if (fd < 0 || 0 != fstat(fd,&fileStat))
+    {
+        printf("Error - %s\n"
+               "        Unable to open %s: %s\n",
+               __PRETTY_FUNCTION__,path,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    textSize = fileStat.st_size;
+    pMem = (0 == textSize) ? MAP_FAILED
+                           : mmap(NULL,textSize,PROT_READ,MAP_PRIVATE,fd,0);
+    ::close(fd);
+
+    if (MAP_FAILED == pMem)
+    {
+        printf("Error - %s\n"
+               "        Unable to map %s: %s\n",
+               __PRETTY_FUNCTION__,path,
+               (0 == textSize) ? "empty file" : strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    madvise(pMem,textSize,MADV_SEQUENTIAL);
+    pText = static_cast<const char*>(pMem);
+    pEnd = pText + textSize;
+
+    /*
+    ** Size the vector storage from the first vector
+    */
+    ndims = countElements(pText,pEnd);
+    if (0 == ndims)
+    {
+        printf("Error - %s\n"
+               "        %s: no vectors in the file\n",
+               __PRETTY_FUNCTION__,path);
+        exit(EXIT_FAILURE);
+    }
+
+    ld = (ndims*sizeof(double) + align - 1)/align*align/sizeof(double);
+    pageSize = sysconf(_SC_PAGESIZE);
+    maxVecs = (textSize + 1)/(2*(UINT64)ndims);
+    storeSize = (maxVecs*ld*sizeof(double) + pageSize - 1)/pageSize*pageSize;
+
+    pMem = mmap(NULL,storeSize,PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,-1,0);
+    if (MAP_FAILED == pMem)
+    {
+        printf("Error - %s\n"
+               "        Unable to reserve %zu bytes for %s: %s\n",
+               __PRETTY_FUNCTION__,storeSize,path,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    pStore = static_cast<char*>(pMem);
+    pVecs = reinterpret_cast<double*>(pStore);
+
+    /*
+    ** Parse the text a window of chunks at a time, asking the kernel to start
+    ** reading the next window while the current one is parsed
+    */
+    noOfChunks = 2*ThreadPool::instance().getThreadCount();
+    pChunks = new TextChunk [noOfChunks];
+    windowSize = (size_t)noOfChunks*TEXTLOAD_CHUNK_SIZE;
+
+    total = 0;
+    pPos = pText;
+    while (pPos < pEnd)
+    {
+        for (UINT32 c = 0; c < noOfChunks; c++)
+        {
+            pChunks[c].pBegin = pPos;
+            pPos = (pEnd - pPos > TEXTLOAD_CHUNK_SIZE)
+                 ? nextLine(pPos + TEXTLOAD_CHUNK_SIZE - 1,pEnd) : pEnd;
+            pChunks[c].pEnd = pPos;
+        }
+
+        if (pPos < pEnd)
+        {
+            pWindow = pText + (pPos - pText)/pageSize*pageSize;
+            madvise(const_cast<char*>(pWindow),
+                    std::min(windowSize,(size_t)(pEnd - pWindow)),
+                    MADV_WILLNEED);
+        }
+
+        ThreadPool::instance().parallelFor(0,noOfChunks,1,
+            [&](UINT32 first, UINT32 last)
+            {
+                for (UINT32 c = first; c < last; c++)
+                {
+                    pChunks[c].count = countVecs(pChunks[c]);
+                }
+            });
+
+        for (UINT32 c = 0; c < noOfChunks; c++)
+        {
+            pChunks[c].first = total;
+            total += pChunks[c].count;
+        }
+
+        if (total > 0xFFFFFFFFULL)
+        {
+            printf("Error - %s\n"
+                   "        %s: too many vectors\n",
+                   __PRETTY_FUNCTION__,path);
+            exit(EXIT_FAILURE);
+        }
+
+        ThreadPool::instance().parallelFor(0,noOfChunks,1,
+            [&](UINT32 first, UINT32 last)
+            {
+                for (UINT32 c = first; c < last; c++)
+                {
+                    parseVecs(pChunks[c],pVecs + pChunks[c].first*ld,
+                              ndims,ld);
+                }
+            });
+
+        for (UINT32 c = 0; c < noOfChunks; c++)
+        {
+            if (NULL != pChunks[c].pError)
+            {
+                printf("Error - %s\n"
+                       "        %s: vector %llu has %s\n",
+                       __PRETTY_FUNCTION__,path,
+                       (unsigned long long)(pChunks[c].first +
+                                            pChunks[c].parsed + 1),
+                       pChunks[c].pError);
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    delete[] pChunks;
+    munmap(const_cast<char*>(pText),textSize);
+
+    /*
+    ** Release the storage past the last vector
+    */
+    noOfVecs = total;
+    used = (total*ld*sizeof(double) + pageSize - 1)/pageSize*pageSize;
+    if (used < storeSize)
+    {
+        munmap(pStore + used,storeSize - used);
+        storeSize = used;
+    }
+}
+
+/**
+********************************************************************************
+** @details Release the vector storage, if any
+********************************************************************************
+*/
+void TextLoader::clear(void)
+{
+    if (NULL != pStore)
+    {
+        munmap(pStore,storeSize);
+    }
+
+    pStore = NULL;
+    storeSize = 0;
+    pVecs = NULL;
+    ndims = 0;
+    noOfVecs = 0;
+    ld = 0;
+}
+
+/**
+********************************************************************************
+** @details Return a pointer to the first vector of the set
+** @return  Pointer to the vector set
+********************************************************************************
+*/
+double* TextLoader::getVecs(void) const
+{
+    return(pVecs);
+}
+
+/**
+********************************************************************************
+** @details Return the dimension of each vector in the set
+** @return  Vector dimension
+********************************************************************************
+*/
+UINT32 TextLoader::getDims(void) const
+{
+    return(ndims);
+}
+
+/**
+********************************************************************************
+** @details Return the number of vectors in the set
+** @return  Number of vectors
+********************************************************************************
+*/
+UINT32 TextLoader::getCount(void) const
+{
+    return(noOfVecs);
+}
+
+/**
+********************************************************************************
+** @details Return the leading dimension of the vectors in the set
+** @return  Leading dimension in elements
+********************************************************************************
+*/
+UINT32 TextLoader::getLeadDim(void) const
+{
+    return(ld);
+}
@@ -0,0 +1,390 @@
+/**
+********************************************************************************
+** @file    VecFile.cc
+**
+** @brief   Implementation of the memory-mapped vector set file
+**
+** @details Files are mapped whole with mmap. Opening a file checks its header
+**          against the size of the file before any vector is touched, so a
+**          truncated or foreign file is reported instead of faulting later in
+**          the math routines.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  VecFile.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "VecFile.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/*-----------------------------[VecFile Methods]------------------------------*/
+/**
+********************************************************************************
+** @details VecFile class constructor
+********************************************************************************
+*/
+VecFile::VecFile()
+{
+    fd = -1;
+    pMap = NULL;
+    mapSize = 0;
+    pHeader = NULL;
+    pVecs = NULL;
+}
+
+/**
+********************************************************************************
+** @details VecFile destructor
+********************************************************************************
+*/
+VecFile::~VecFile()
+{
+    close();
+}
+
+/**
+********************************************************************************
+** @details Map the whole of the open file
+** @param   path    Name of the file, for error messages
+** @param   shared  Write changes to the file instead of keeping them private
+********************************************************************************
+*/
+void VecFile::map(const char* path, const bool& shared)
+{
+    void* pMem;
+
+    pMem = mmap(NULL,mapSize,PROT_READ | PROT_WRITE,
+                shared ? MAP_SHARED : MAP_PRIVATE,fd,0);
+    if (MAP_FAILED == pMem)
+    {
+        printf("Error - %s\n"
+               "        Unable to map %s: %s\n",
+               __PRETTY_FUNCTION__,path,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    pMap = static_cast<char*>(pMem);
+    pHeader = reinterpret_cast<VecFileHeader*>(pMap);
+}
+
+/**
+********************************************************************************
+** @details Check the header of the mapped file describes a vector set the
+**          orthonormalization routines can use, and that the vector data
+**          lies within the file. The data offset is checked against the
+**          alignment, which only aligns the data in memory when the alignment
+**          is at most the page size, since the mapping starts on a page.
+** @param   path    Name of the file, for error messages
+********************************************************************************
+*/
+void VecFile::checkHeader(const char* path) const
+{
+    const char* pError = NULL;
+
+    UINT64 dataSize;
+
+    if (0 != memcmp(pHeader->magic,VECFILE_MAGIC,sizeof(pHeader->magic)))
+    {
+        pError = "not a vector set file";
+    }
+    else if (VECFILE_BYTE_ORDER != pHeader->byteOrder)
+    {
+        pError = "written with a different byte order";
+    }
+    else if (VECFILE_VERSION != pHeader->version)
+    {
+        pError = "unsupported format version";
+    }
+    else if (VECFILE_FLOAT64 != pHeader->dtype)
+    {
+        pError = "unsupported element type";
+    }
+    else if (VECFILE_BY_VECTOR != pHeader->layout)
+    {
+        pError = "unsupported element layout";
+    }
+    else if (pHeader->align < sizeof(double) ||
+             pHeader->align > (UINT64)sysconf(_SC_PAGESIZE) ||
+             0 != (pHeader->align & (pHeader->align - 1)) ||
+             0 != pHeader->dataOffset % pHeader->align ||
+             0 != (pHeader->ld*sizeof(double)) % pHeader->align)
+    {
+        pError = "vector data is not aligned";
+    }
+    else if (0 == pHeader->ndims || 0 == pHeader->noOfVecs ||
+             pHeader->ld < pHeader->ndims)
+    {
+        pError = "invalid vector set dimensions";
+    }
+    else
+    {
+        dataSize = (UINT64)pHeader->ld*pHeader->noOfVecs*sizeof(double);
+        if (pHeader->dataOffset < VECFILE_HEADER_SIZE ||
+            pHeader->dataOffset > mapSize ||
+            dataSize > mapSize - pHeader->dataOffset)
+        {
+            pError = "vector data extends past the end of the file";
+        }
+        else if (0 != pHeader->indexOffset &&
+                 (0 != pHeader->indexOffset % sizeof(UINT32) ||
+                  pHeader->indexOffset < pHeader->dataOffset + dataSize ||
+                  pHeader->indexOffset > mapSize ||
+                  (UINT64)pHeader->noOfVecs*sizeof(UINT32) >
+                  mapSize - pHeader->indexOffset))
+        {
+            pError = "source indices extend past the end of the file";
+        }
+    }
+
+    if (NULL != pError)
+    {
+        printf("Error - %s\n"
+               "        %s: %s\n",
+               __PRETTY_FUNCTION__,path,pError);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+********************************************************************************
+** @details Open and map an existing vector set file. With a private mapping
+**          the vectors may be changed in place, as the orthonormalization
+**          routines do, without changing the file. Pages are only read from
+**          the file when first touched, and only the pages written are copied.
+** @param   path    Name of the file
+** @param   mode    Mapping mode
+********************************************************************************
+*/
+void VecFile::open(const char* path, const VecFileMode& mode)
+{
+    struct stat fileStat;
+
+    close();
+
+    fd = ::open(path,(VECFILE_SHARED == mode) ? O_RDWR : O_RDONLY);
+    if (fd < 0 || 0 != fstat(fd,&fileStat))
+    {
+        printf("Error - %s\n"
+               "        Unable to open %s: %s\n",
+               __PRETTY_FUNCTION__,path,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    if ((size_t)fileStat.st_size < VECFILE_HEADER_SIZE)
+    {
+        printf("Error - %s\n"
+               "        %s: too small for a vector set file\n",
+               __PRETTY_FUNCTION__,path);
+        exit(EXIT_FAILURE);
+    }
+
+    mapSize = fileStat.st_size;
+    map(path,VECFILE_SHARED == mode);
+    checkHeader(path);
+
+    pVecs = reinterpret_cast<double*>(pMap + pHeader->dataOffset);
+}
+
+/**
+********************************************************************************
+** @details Create a vector set file of n zero vectors of dimension m and map
+**          it for writing. The vectors written through getVecs() are stored in
+**          the file when it is closed.
+** @param   path    Name of the file, which is replaced if it exists
+** @param   m       Dimension of each vector
+** @param   n       Number of vectors
+** @param   align   Alignment in bytes of each vector, a power of two of at
+**                  least 8 and at most the page size
+********************************************************************************
+*/
+void VecFile::create(const char* path, const UINT32& m, const UINT32& n,
+                     const UINT32& align)
+{
+    UINT32 ld;
+    UINT64 dataOffset;
+
+    close();
+
+    if (0 == m || 0 == n || align < sizeof(double) ||
+        align > (UINT64)sysconf(_SC_PAGESIZE) ||
+        0 != (align & (align - 1)))
+    {
+        printf("Error - %s\n"
+               "        Invalid vector set file of %u vectors of dimension "
+               "%u\n"
+               "        with alignment %u\n",
+               __PRETTY_FUNCTION__,n,m,align);
+        exit(EXIT_FAILURE);
+    }
+
+    ld = (m*sizeof(double) + align - 1)/align*align/sizeof(double);
+    dataOffset = (VECFILE_HEADER_SIZE + align - 1)/align*align;
+    mapSize = dataOffset + (UINT64)ld*n*sizeof(double);
+
+    fd = ::open(path,O_RDWR | O_CREAT | O_TRUNC,0644);
+    if (fd < 0 || 0 != ftruncate(fd,mapSize))
+    {
+        printf("Error - %s\n"
+               "        Unable to create %s: %s\n",
+               __PRETTY_FUNCTION__,path,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    map(path,true);
+
+    memcpy(pHeader->magic,VECFILE_MAGIC,sizeof(pHeader->magic));
+    pHeader->version = VECFILE_VERSION;
+    pHeader->byteOrder = VECFILE_BYTE_ORDER;
+    pHeader->dtype = VECFILE_FLOAT64;
+    pHeader->layout = VECFILE_BY_VECTOR;
+    pHeader->align = align;
+    pHeader->ndims = m;
+    pHeader->noOfVecs = n;
+    pHeader->ld = ld;
+    pHeader->dataOffset = dataOffset;
+
+    pVecs = reinterpret_cast<double*>(pMap + dataOffset);
+}
+
+/**
+********************************************************************************
+** @details Unmap and close the file, if one is open
+********************************************************************************
+*/
+void VecFile::close(void)
+{
+    if (NULL != pMap)
+    {
+        munmap(pMap,mapSize);
+    }
+
+    if (fd >= 0)
+    {
+        ::close(fd);
+    }
+
+    fd = -1;
+    pMap = NULL;
+    mapSize = 0;
+    pHeader = NULL;
+    pVecs = NULL;
+}
+
+/**
+********************************************************************************
+** @details Return a pointer to the first vector of the mapped file
+** @return  Pointer to the vector set
+********************************************************************************
+*/
+double* VecFile::getVecs(void) const
+{
+    return(pVecs);
+}
+
+/**
+********************************************************************************
+** @details Return the dimension of each vector in the file
+** @return  Vector dimension
+********************************************************************************
+*/
+UINT32 VecFile::getDims(void) const
+{
+    return((NULL == pHeader) ? 0 : pHeader->ndims);
+}
+
+/**
+********************************************************************************
+** @details Return the number of vectors in the file
+** @return  Number of vectors
+********************************************************************************
+*/
+UINT32 VecFile::getCount(void) const
+{
+    return((NULL == pHeader) ? 0 : pHeader->noOfVecs);
+}
+
+/**
+********************************************************************************
+** @details Return the leading dimension of the vectors in the file
+** @return  Leading dimension in elements
+********************************************************************************
+*/
+UINT32 VecFile::getLeadDim(void) const
+{
+    return((NULL == pHeader) ? 0 : pHeader->ld);
+}
+
+/**
+********************************************************************************
+** @details Return the rank of the source set of a result file
+** @return  Rank, or 0 if the file does not record one
+********************************************************************************
+*/
+UINT32 VecFile::getRank(void) const
+{
+    return((NULL == pHeader) ? 0 : pHeader->rank);
+}
+
+/**
+********************************************************************************
+** @details Return the number of vectors in the source set of a result file
+** @return  Number of source vectors, or 0 if the file does not record it
+********************************************************************************
+*/
+UINT32 VecFile::getSourceCount(void) const
+{
+    return((NULL == pHeader) ? 0 : pHeader->srcCount);
+}
+
+/**
+********************************************************************************
+** @details Return the index in the source set of each vector of a result file
+** @return  Pointer to getCount() indices, or NULL if the file has none
+********************************************************************************
+*/
+const UINT32* VecFile::getIndices(void) const
+{
+    if (NULL == pHeader || 0 == pHeader->indexOffset)
+    {
+        return(NULL);
+    }
+
+    return(reinterpret_cast<const UINT32*>(pMap + pHeader->indexOffset));
+}
@@ -0,0 +1,1027 @@
+/**
+********************************************************************************
+** @file    VecService.cc
+**
+** @brief   Implementation of the orthonormalization server and client
+**
+** @details The server reads requests from every client on one thread with
+**          poll(), solves them in micro-batches on the thread pool, and
+**          replies on the dispatch thread. Vectors are solved in place in
+**          shared memory the client attached to its connection, so only the
+**          small request and reply messages cross the socket.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  VecService.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <new>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "VecService.hh"
+#include "ThreadPool.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @union   FdControl
+** @brief   Ancillary data buffer for passing one file descriptor
+********************************************************************************
+*/
+union FdControl
+{
+    struct cmsghdr align;                   /* Forces cmsghdr alignment */
+    char buf[CMSG_SPACE(sizeof(INT32))];    /* Ancillary data */
+};
+
+/**
+********************************************************************************
+** @details Fill in the address of a Unix domain socket
+** @param   addr        Address, filled in
+** @param   socketPath  Socket path
+********************************************************************************
+*/
+static void setSocketAddr(struct sockaddr_un& addr, const char* socketPath)
+{
+    if (strlen(socketPath) >= sizeof(addr.sun_path))
+    {
+        printf("Error - %s\n"
+               "        Socket path %s is too long\n",
+               __PRETTY_FUNCTION__,socketPath);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(&addr,0,sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path,socketPath);
+}
+
+/**
+********************************************************************************
+** @details Remove a socket left at a path by a server that has exited. The
+**          path is refused if it is anything other than a socket, or if a
+**          server still accepts connections on it, so a running server or an
+**          unrelated file is never removed.
+** @param   addr        Address of the socket path
+** @param   socketPath  Socket path
+********************************************************************************
+*/
+static void removeStaleSocket(const struct sockaddr_un& addr,
+                              const char* socketPath)
+{
+    INT32 probe;
+    bool live;
+
+    struct stat info;
+
+    if (0 != lstat(socketPath,&info))
+    {
+        return;
+    }
+    else if (!S_ISSOCK(info.st_mode))
+    {
+        printf("Error - %s\n"
+               "        %s exists and is not a socket\n",
+               __PRETTY_FUNCTION__,socketPath);
+        exit(EXIT_FAILURE);
+    }
+
+    probe = socket(AF_UNIX,SOCK_SEQPACKET|SOCK_CLOEXEC,0);
+    live = (probe >= 0 &&
+            0 == connect(probe,(const struct sockaddr*)&addr,sizeof(addr)));
+    if (probe >= 0)
+    {
+        ::close(probe);
+    }
+
+    if (live)
+    {
+        printf("Error - %s\n"
+               "        A server is already running on %s\n",
+               __PRETTY_FUNCTION__,socketPath);
+        exit(EXIT_FAILURE);
+    }
+
+    unlink(socketPath);
+}
+
+/*----------------------------[VecServer Methods]-----------------------------*/
+/**
+********************************************************************************
+** @details VecServer class constructor
+********************************************************************************
+*/
+VecServer::VecServer()
+{
+    listenSock = -1;
+    wakeFd = -1;
+    path = NULL;
+    pConns = NULL;
+    pQueue = NULL;
+    queueHead = 0;
+    queueCount = 0;
+    stopping = false;
+    noOfRequests = 0;
+    noOfBatches = 0;
+}
+
+/**
+********************************************************************************
+** @details VecServer destructor
+********************************************************************************
+*/
+VecServer::~VecServer()
+{
+}
+
+/**
+********************************************************************************
+** @details Wake run() from poll(). Only write() is used, so this is safe from
+**          a signal handler.
+********************************************************************************
+*/
+void VecServer::wake(void)
+{
+    UINT64 one = 1;
+
+    if (write(wakeFd,&one,sizeof(one)) < 0)
+    {
+        /* The eventfd counter is already non-zero, so run() will wake */
+    }
+}
+
+/**
+********************************************************************************
+** @details Send a reply without blocking. A client whose socket buffer is
+**          full is not reading its replies, so its connection is shut down
+**          rather than stalling every other client.
+** @param   conn    Connection
+** @param   reply   Reply
+********************************************************************************
+*/
+void VecServer::sendReply(VecConnection& conn, const VecReply& reply)
+{
+    ssize_t sent;
+
+    do
+    {
+        sent = send(conn.sock,&reply,sizeof(reply),MSG_NOSIGNAL|MSG_DONTWAIT);
+    } while (sent < 0 && EINTR == errno);
+
+    if (sent != (ssize_t)sizeof(reply))
+    {
+        shutdown(conn.sock,SHUT_RDWR);
+    }
+}
+
+/**
+********************************************************************************
+** @details Accept a new client connection into a free slot
+********************************************************************************
+*/
+void VecServer::acceptClient(void)
+{
+    INT32 sock;
+
+    UINT32 c = 0;
+
+    sock = accept4(listenSock,NULL,NULL,SOCK_NONBLOCK|SOCK_CLOEXEC);
+    if (sock < 0)
+    {
+        return;
+    }
+
+    while (c < VECSVC_MAX_CONNS && pConns[c].sock >= 0)
+    {
+        c++;
+    }
+
+    if (VECSVC_MAX_CONNS == c)
+    {
+        ::close(sock);
+        return;
+    }
+
+    pConns[c].sock = sock;
+    pConns[c].pShared = NULL;
+    pConns[c].sharedSize = 0;
+    pConns[c].outstanding = 0;
+    pConns[c].closing = false;
+}
+
+/**
+********************************************************************************
+** @details Read the requests waiting on a connection. Attach requests and
+**          invalid requests are answered at once, and the rest are queued for
+**          the dispatch thread. Reading stops when the queue or the share of
+**          the connection is full, and resumes once the dispatch thread has
+**          taken requests off the queue.
+** @param   conn    Connection
+********************************************************************************
+*/
+void VecServer::readRequests(VecConnection& conn)
+{
+    VecRequest request;
+    VecReply reply;
+    FdControl control;
+    struct msghdr msg;
+    struct iovec iov;
+    struct cmsghdr* pCmsg;
+    ssize_t got;
+    INT32 memFd;
+    bool full;
+    bool notify;
+    bool isQueued;
+
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> guard(queueLock);
+            full = (VECSVC_QUEUE_DEPTH == queueCount);
+        }
+
+        if (full || conn.outstanding >= VECSVC_CONN_DEPTH)
+        {
+            return;
+        }
+
+        memset(&msg,0,sizeof(msg));
+        iov.iov_base = &request;
+        iov.iov_len = sizeof(request);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+
+        got = recvmsg(conn.sock,&msg,MSG_DONTWAIT|MSG_CMSG_CLOEXEC);
+        if (got < 0 && EINTR == errno)
+        {
+            continue;
+        }
+        else if (got < 0 && (EAGAIN == errno || EWOULDBLOCK == errno))
+        {
+            return;
+        }
+        else if (got <= 0)
+        {
+            conn.closing = true;
+            return;
+        }
+
+        memFd = -1;
+        pCmsg = CMSG_FIRSTHDR(&msg);
+        if (NULL != pCmsg && SOL_SOCKET == pCmsg->cmsg_level &&
+            SCM_RIGHTS == pCmsg->cmsg_type &&
+            CMSG_LEN(sizeof(INT32)) == pCmsg->cmsg_len)
+        {
+            memcpy(&memFd,CMSG_DATA(pCmsg),sizeof(INT32));
+        }
+
+        reply.tag = request.tag;
+        reply.status = VECSVC_INVALID;
+        reply.result = 0;
+        isQueued = false;
+
+        if (sizeof(request) != (size_t)got || 0 != (msg.msg_flags & MSG_TRUNC))
+        {
+            reply.tag = 0;
+        }
+        else if (VECSVC_ATTACH == request.op)
+        {
+            reply.status = attach(conn,request,memFd);
+            memFd = -1;
+        }
+        else if ((VECSVC_ORTHONORMALIZE == request.op ||
+                  VECSVC_RANK == request.op) && checkRequest(conn,request))
+        {
+            conn.outstanding++;
+            {
+                std::lock_guard<std::mutex> guard(queueLock);
+                VecPending& pending =
+                    pQueue[(queueHead + queueCount)%VECSVC_QUEUE_DEPTH];
+                pending.request = request;
+                pending.pConn = &conn;
+                queueCount++;
+                notify = (1 == queueCount ||
+                          VECSVC_BATCH_SIZE == queueCount);
+            }
+
+            /* Only these counts can end a wait of the dispatch thread */
+            if (notify)
+            {
+                queued.notify_one();
+            }
+            isQueued = true;
+        }
+
+        if (memFd >= 0)
+        {
+            ::close(memFd);
+        }
+
+        if (!isQueued)
+        {
+            sendReply(conn,reply);
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Attach the shared memory of a client to its connection. The memfd
+**          must be sealed against shrinking, so the client cannot truncate it
+**          under the server while it is mapped.
+** @param   conn    Connection
+** @param   request Attach request
+** @param   memFd   Memory file descriptor passed with the request, or -1,
+**                  which is closed before returning
+** @return  Status of the reply
+********************************************************************************
+*/
+UINT32 VecServer::attach(VecConnection& conn, const VecRequest& request,
+                         const INT32& memFd)
+{
+    struct stat info;
+    void* pMem;
+    INT32 seals;
+
+    UINT32 status = VECSVC_INVALID;
+
+    if (memFd >= 0 && NULL == conn.pShared && request.size > 0)
+    {
+        seals = fcntl(memFd,F_GET_SEALS);
+        if (seals >= 0 && 0 != (seals & F_SEAL_SHRINK) &&
+            0 == fstat(memFd,&info) && (UINT64)info.st_size >= request.size)
+        {
+            pMem = mmap(NULL,request.size,PROT_READ|PROT_WRITE,MAP_SHARED,
+                        memFd,0);
+            if (MAP_FAILED == pMem)
+            {
+                status = VECSVC_FAILED;
+            }
+            else
+            {
+                conn.pShared = (char*)pMem;
+                conn.sharedSize = request.size;
+                status = VECSVC_OK;
+            }
+        }
+    }
+
+    if (memFd >= 0)
+    {
+        ::close(memFd);
+    }
+
+    return(status);
+}
+
+/**
+********************************************************************************
+** @details Check a request is within the size limits of the service and names
+**          vectors, and for orthonormalization indices, that lie within the
+**          shared memory of its connection
+** @param   conn    Connection
+** @param   request Request
+** @return  true if the request can be solved
+********************************************************************************
+*/
+bool VecServer::checkRequest(const VecConnection& conn,
+                             const VecRequest& request)
+{
+    UINT64 elems;
+
+    if (NULL == conn.pShared || 0 == request.ndims || 0 == request.noOfVecs ||
+        request.lda < request.ndims || request.lda > VECSVC_MAX_DIMS ||
+        request.noOfVecs > VECSVC_MAX_VECS ||
+        0 != request.dataOffset%sizeof(double) ||
+        request.dataOffset > conn.sharedSize)
+    {
+        return(false);
+    }
+
+    /* Cannot overflow, since each factor is below 2^32 */
+    elems = (UINT64)(request.noOfVecs - 1)*request.lda + request.ndims;
+    if (elems > (conn.sharedSize - request.dataOffset)/sizeof(double))
+    {
+        return(false);
+    }
+
+    if (VECSVC_ORTHONORMALIZE == request.op &&
+        (0 != request.indexOffset%sizeof(UINT32) ||
+         request.indexOffset > conn.sharedSize ||
+         request.noOfVecs >
+            (conn.sharedSize - request.indexOffset)/sizeof(UINT32)))
+    {
+        return(false);
+    }
+
+    return(true);
+}
+
+/**
+********************************************************************************
+** @details Close a connection and release its shared memory
+** @param   conn    Connection
+********************************************************************************
+*/
+void VecServer::closeConn(VecConnection& conn)
+{
+    if (NULL != conn.pShared)
+    {
+        munmap(conn.pShared,conn.sharedSize);
+    }
+    ::close(conn.sock);
+
+    conn.sock = -1;
+    conn.pShared = NULL;
+    conn.sharedSize = 0;
+    conn.closing = false;
+}
+
+/**
+********************************************************************************
+** @details Body of the dispatch thread. Once a request is queued, up to
+**          VECSVC_BATCH_USEC is spent waiting for a full micro-batch, so
+**          requests arriving together from many clients share one parallel
+**          solve, while a lone request is only delayed by the window. The
+**          queue is drained before the thread exits.
+********************************************************************************
+*/
+void VecServer::dispatchLoop(void)
+{
+    VecPending* pBatch;
+    UINT32 noOfPending;
+    bool wasFull;
+
+    pBatch = new VecPending [VECSVC_BATCH_SIZE];
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> guard(queueLock);
+            queued.wait(guard,[&]{return(queueCount > 0 || stopping);});
+            if (0 == queueCount)
+            {
+                break;
+            }
+
+            queued.wait_for(guard,
+                            std::chrono::microseconds(VECSVC_BATCH_USEC),
+                            [&]{return(queueCount >= VECSVC_BATCH_SIZE ||
+                                       stopping);});
+
+            wasFull = (VECSVC_QUEUE_DEPTH == queueCount);
+            noOfPending = std::min<UINT32>(queueCount,VECSVC_BATCH_SIZE);
+            for (UINT32 i = 0; i < noOfPending; i++)
+            {
+                pBatch[i] = pQueue[(queueHead + i)%VECSVC_QUEUE_DEPTH];
+            }
+            queueHead = (queueHead + noOfPending)%VECSVC_QUEUE_DEPTH;
+            queueCount -= noOfPending;
+        }
+
+        /* Let run() read from the sockets again */
+        if (wasFull)
+        {
+            wake();
+        }
+
+        ThreadPool::instance().parallelFor(0,noOfPending,1,
+            [&](UINT32 first, UINT32 last)
+            {
+                for (UINT32 i = first; i < last; i++)
+                {
+                    VecPending& pending = pBatch[i];
+                    const VecRequest& request = pending.request;
+                    char* pShared = pending.pConn->pShared;
+
+                    pending.reply.tag = request.tag;
+                    pending.reply.result = 0;
+
+                    /* A failed request must not take down the server */
+                    try
+                    {
+                        pending.reply.status = handler(request,
+                            (double*)(pShared + request.dataOffset),
+                            (VECSVC_ORTHONORMALIZE == request.op) ?
+                            (UINT32*)(pShared + request.indexOffset) : NULL,
+                            pending.reply.result);
+                    }
+                    catch (const std::bad_alloc&)
+                    {
+                        pending.reply.status = VECSVC_FAILED;
+                        pending.reply.result = 0;
+                    }
+                }
+            });
+
+        /* The connection may be closed once outstanding reaches zero */
+        for (UINT32 i = 0; i < noOfPending; i++)
+        {
+            sendReply(*pBatch[i].pConn,pBatch[i].reply);
+            pBatch[i].pConn->outstanding--;
+        }
+
+        noOfRequests += noOfPending;
+        noOfBatches++;
+        wake();
+    }
+
+    delete[] pBatch;
+}
+
+/**
+********************************************************************************
+** @details Serve requests on a Unix domain socket until requestStop() is
+**          called. A stale socket file at the path is replaced, but the
+**          server refuses to start on any other file or on the socket of a
+**          server that is still running. Sockets are only polled for
+**          reading while the queue has room, which pushes back on the clients
+**          when the server falls behind.
+** @param   socketPath  Socket path
+** @param   solver      Solver called for each request
+********************************************************************************
+*/
+void VecServer::run(const char* socketPath, const VecHandler& solver)
+{
+    struct sockaddr_un addr;
+    struct pollfd* pPoll;
+    UINT32* pPollConn;
+    UINT32 noOfPoll;
+    UINT64 count;
+    bool room;
+    bool freeSlot;
+
+    path = socketPath;
+    handler = solver;
+    setSocketAddr(addr,path);
+
+    removeStaleSocket(addr,path);
+
+    listenSock = socket(AF_UNIX,SOCK_SEQPACKET|SOCK_CLOEXEC,0);
+    if (listenSock < 0 ||
+        0 != bind(listenSock,(struct sockaddr*)&addr,sizeof(addr)) ||
+        0 != listen(listenSock,SOMAXCONN))
+    {
+        printf("Error - %s\n"
+               "        Unable to listen on %s: %s\n",
+               __PRETTY_FUNCTION__,path,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    wakeFd = eventfd(0,EFD_NONBLOCK|EFD_CLOEXEC);
+    if (wakeFd < 0)
+    {
+        printf("Error - %s\n"
+               "        Unable to create an eventfd: %s\n",
+               __PRETTY_FUNCTION__,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    pConns = new VecConnection [VECSVC_MAX_CONNS];
+    for (UINT32 c = 0; c < VECSVC_MAX_CONNS; c++)
+    {
+        pConns[c].sock = -1;
+        pConns[c].pShared = NULL;
+        pConns[c].sharedSize = 0;
+        pConns[c].outstanding = 0;
+        pConns[c].closing = false;
+    }
+
+    pQueue = new VecPending [VECSVC_QUEUE_DEPTH];
+    queueHead = 0;
+    queueCount = 0;
+    noOfRequests = 0;
+    noOfBatches = 0;
+
+    pPoll = new struct pollfd [VECSVC_MAX_CONNS + 2];
+    pPollConn = new UINT32 [VECSVC_MAX_CONNS + 2];
+
+    dispatcher = std::thread(&VecServer::dispatchLoop,this);
+
+    while (!stopping)
+    {
+        {
+            std::lock_guard<std::mutex> guard(queueLock);
+            room = (queueCount < VECSVC_QUEUE_DEPTH);
+        }
+
+        freeSlot = false;
+        noOfPoll = 2;
+        for (UINT32 c = 0; c < VECSVC_MAX_CONNS; c++)
+        {
+            if (pConns[c].sock < 0)
+            {
+                freeSlot = true;
+            }
+            else if (pConns[c].closing && 0 == pConns[c].outstanding)
+            {
+                closeConn(pConns[c]);
+                freeSlot = true;
+            }
+            else if (room && !pConns[c].closing &&
+                     pConns[c].outstanding < VECSVC_CONN_DEPTH)
+            {
+                pPoll[noOfPoll].fd = pConns[c].sock;
+                pPoll[noOfPoll].events = POLLIN;
+                pPollConn[noOfPoll] = c;
+                noOfPoll++;
+            }
+        }
+
+        pPoll[0].fd = wakeFd;
+        pPoll[0].events = POLLIN;
+        pPoll[1].fd = (room && freeSlot) ? listenSock : -1;
+        pPoll[1].events = POLLIN;
+
+        if (poll(pPoll,noOfPoll,-1) < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            printf("Error - %s\n"
+                   "        poll failed: %s\n",
+                   __PRETTY_FUNCTION__,strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+
+        if (0 != pPoll[0].revents && read(wakeFd,&count,sizeof(count)) < 0)
+        {
+            /* Counter was already reset */
+        }
+
+        if (0 != (pPoll[1].revents & POLLIN))
+        {
+            acceptClient();
+        }
+
+        for (UINT32 p = 2; p < noOfPoll; p++)
+        {
+            VecConnection& conn = pConns[pPollConn[p]];
+
+            if (0 != (pPoll[p].revents & POLLIN))
+            {
+                readRequests(conn);
+            }
+            else if (0 != pPoll[p].revents)
+            {
+                conn.closing = true;
+            }
+        }
+    }
+
+    /* The dispatch thread solves what is still queued before it exits */
+    {
+        std::lock_guard<std::mutex> guard(queueLock);
+    }
+    queued.notify_all();
+    dispatcher.join();
+
+    for (UINT32 c = 0; c < VECSVC_MAX_CONNS; c++)
+    {
+        if (pConns[c].sock >= 0)
+        {
+            closeConn(pConns[c]);
+        }
+    }
+
+    ::close(listenSock);
+    ::close(wakeFd);
+    unlink(path);
+
+    delete[] pPoll;
+    delete[] pPollConn;
+    delete[] pQueue;
+    delete[] pConns;
+
+    listenSock = -1;
+    wakeFd = -1;
+    pQueue = NULL;
+    pConns = NULL;
+}
+
+/**
+********************************************************************************
+** @details Ask run() to return once the queued requests are solved
+********************************************************************************
+*/
+void VecServer::requestStop(void)
+{
+    stopping = true;
+    if (wakeFd >= 0)
+    {
+        wake();
+    }
+}
+
+/**
+********************************************************************************
+** @details Return the number of requests solved
+** @return  Number of requests
+********************************************************************************
+*/
+UINT64 VecServer::getRequestCount(void) const
+{
+    return(noOfRequests);
+}
+
+/**
+********************************************************************************
+** @details Return the number of micro-batches solved
+** @return  Number of micro-batches
+********************************************************************************
+*/
+UINT64 VecServer::getBatchCount(void) const
+{
+    return(noOfBatches);
+}
+
+/*----------------------------[VecClient Methods]-----------------------------*/
+/**
+********************************************************************************
+** @details VecClient class constructor
+********************************************************************************
+*/
+VecClient::VecClient()
+{
+    sock = -1;
+    pShared = NULL;
+    sharedSize = 0;
+    nextTag = 1;
+}
+
+/**
+********************************************************************************
+** @details VecClient destructor
+********************************************************************************
+*/
+VecClient::~VecClient()
+{
+    close();
+}
+
+/**
+********************************************************************************
+** @details Send a request, passing a file descriptor with it if given, and
+**          wait for its reply
+** @param   request Request, whose tag is filled in
+** @param   memFd   File descriptor to pass, or -1
+** @return  Result of the reply
+********************************************************************************
+*/
+UINT32 VecClient::call(VecRequest& request, const INT32& memFd)
+{
+    VecReply reply;
+    FdControl control;
+    struct msghdr msg;
+    struct iovec iov;
+    struct cmsghdr* pCmsg;
+    ssize_t got;
+
+    request.tag = nextTag++;
+
+    memset(&msg,0,sizeof(msg));
+    iov.iov_base = &request;
+    iov.iov_len = sizeof(request);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (memFd >= 0)
+    {
+        memset(&control,0,sizeof(control));
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+        pCmsg = CMSG_FIRSTHDR(&msg);
+        pCmsg->cmsg_level = SOL_SOCKET;
+        pCmsg->cmsg_type = SCM_RIGHTS;
+        pCmsg->cmsg_len = CMSG_LEN(sizeof(INT32));
+        memcpy(CMSG_DATA(pCmsg),&memFd,sizeof(INT32));
+    }
+
+    do
+    {
+        got = sendmsg(sock,&msg,MSG_NOSIGNAL);
+    } while (got < 0 && EINTR == errno);
+
+    if (got == (ssize_t)sizeof(request))
+    {
+        do
+        {
+            got = recv(sock,&reply,sizeof(reply),0);
+        } while (got < 0 && EINTR == errno);
+    }
+
+    if (got != (ssize_t)sizeof(reply) || reply.tag != request.tag)
+    {
+        printf("Error - %s\n"
+               "        Lost the connection to the server\n",
+               __PRETTY_FUNCTION__);
+        exit(EXIT_FAILURE);
+    }
+    else if (VECSVC_OK != reply.status)
+    {
+        printf("Error - %s\n"
+               "        Server rejected the request (status %u)\n",
+               __PRETTY_FUNCTION__,reply.status);
+        exit(EXIT_FAILURE);
+    }
+
+    return(reply.result);
+}
+
+/**
+********************************************************************************
+** @details Connect to a server, and create and attach shared memory
+** @param   socketPath  Socket path of the server
+** @param   size        Bytes of shared memory
+********************************************************************************
+*/
+void VecClient::connect(const char* socketPath, const size_t& size)
+{
+    struct sockaddr_un addr;
+    VecRequest request;
+    void* pMem;
+    INT32 memFd;
+
+    close();
+
+    setSocketAddr(addr,socketPath);
+    sock = socket(AF_UNIX,SOCK_SEQPACKET|SOCK_CLOEXEC,0);
+    if (sock < 0 ||
+        0 != ::connect(sock,(struct sockaddr*)&addr,sizeof(addr)))
+    {
+        printf("Error - %s\n"
+               "        Unable to connect to %s: %s\n",
+               __PRETTY_FUNCTION__,socketPath,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    memFd = memfd_create("gsvec",MFD_CLOEXEC|MFD_ALLOW_SEALING);
+    if (memFd < 0 || 0 == size || 0 != ftruncate(memFd,size) ||
+        0 != fcntl(memFd,F_ADD_SEALS,F_SEAL_SHRINK|F_SEAL_SEAL))
+    {
+        printf("Error - %s\n"
+               "        Unable to create %zu bytes of shared memory: %s\n",
+               __PRETTY_FUNCTION__,size,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    pMem = mmap(NULL,size,PROT_READ|PROT_WRITE,MAP_SHARED,memFd,0);
+    if (MAP_FAILED == pMem)
+    {
+        printf("Error - %s\n"
+               "        Unable to map %zu bytes of shared memory: %s\n",
+               __PRETTY_FUNCTION__,size,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    pShared = (char*)pMem;
+    sharedSize = size;
+
+    memset(&request,0,sizeof(request));
+    request.op = VECSVC_ATTACH;
+    request.size = size;
+    call(request,memFd);
+
+    ::close(memFd);
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize vectors in shared memory in place. The basis
+**          replaces the first vectors, and the index of the source vector of
+**          each basis vector is written at indexOffset.
+** @param   dataOffset  Byte offset of the vectors, a multiple of 8
+** @param   lda         Leading dimension of the vectors
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors
+** @param   indexOffset Byte offset of n UINT32 source indices, a multiple
+**                      of 4
+** @return  Number of basis vectors
+********************************************************************************
+*/
+UINT32 VecClient::orthonormalize(const size_t& dataOffset, const UINT32& lda,
+                                 const UINT32& m, const UINT32& n,
+                                 const size_t& indexOffset)
+{
+    VecRequest request;
+
+    memset(&request,0,sizeof(request));
+    request.op = VECSVC_ORTHONORMALIZE;
+    request.ndims = m;
+    request.noOfVecs = n;
+    request.lda = lda;
+    request.dataOffset = dataOffset;
+    request.indexOffset = indexOffset;
+
+    return(call(request));
+}
+
+/**
+********************************************************************************
+** @details Return the rank of vectors in shared memory
+** @param   dataOffset  Byte offset of the vectors, a multiple of 8
+** @param   lda         Leading dimension of the vectors
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors
+** @return  Rank of the vectors
+********************************************************************************
+*/
+UINT32 VecClient::rank(const size_t& dataOffset, const UINT32& lda,
+                       const UINT32& m, const UINT32& n)
+{
+    VecRequest request;
+
+    memset(&request,0,sizeof(request));
+    request.op = VECSVC_RANK;
+    request.ndims = m;
+    request.noOfVecs = n;
+    request.lda = lda;
+    request.dataOffset = dataOffset;
+
+    return(call(request));
+}
+
+/**
+********************************************************************************
+** @details Disconnect from the server and release the shared memory
+********************************************************************************
+*/
+void VecClient::close(void)
+{
+    if (NULL != pShared)
+    {
+        munmap(pShared,sharedSize);
+    }
+    if (sock >= 0)
+    {
+        ::close(sock);
+    }
+
+    sock = -1;
+    pShared = NULL;
+    sharedSize = 0;
+}
+
+/**
+********************************************************************************
+** @details Return the shared memory of the client
+** @return  Shared memory
+********************************************************************************
+*/
+char* VecClient::getShared(void) const
+{
+    return(pShared);
+}
+
+/**
+********************************************************************************
+** @details Return the size of the shared memory
+** @return  Bytes of shared memory
+********************************************************************************
+*/
+size_t VecClient::getSharedSize(void) const
+{
+    return(sharedSize);
+}
@@ -0,0 +1,662 @@
+/**
+********************************************************************************
+** @file    VecStream.cc
+**
+** @brief   Implementation of the problem stream reader and result stream writer
+**
+** @details Problems are read from the input through a staging buffer by a
+**          background thread, so many small records cost few system calls,
+**          and are parsed straight into the storage of the batch being
+**          filled. Each batch is handed to the solver while the next one is
+**          read.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  VecStream.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <new>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "VecStream.hh"
+#include "VecFile.hh"
+#include "VecWriter.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @def   VECSTREAM_MAX_ELEMS
+** @brief Largest number of elements in one problem that is read, 1 GB of
+**        doubles. The elements of a larger problem are skipped.
+********************************************************************************
+*/
+#define VECSTREAM_MAX_ELEMS (1ULL << 27)
+
+/**
+********************************************************************************
+** @details Grow an array to hold at least a number of elements, keeping its
+**          contents. The array is left unchanged if the memory cannot be
+**          allocated.
+** @param   pArray      Array, replaced when it grows
+** @param   capacity    Number of elements allocated, updated when it grows
+** @param   size        Number of elements in use
+** @param   needed      Number of elements needed
+** @return  true if the array holds the elements needed
+********************************************************************************
+*/
+template <typename T, typename S>
+static bool growArray(T*& pArray, S& capacity, const size_t& size,
+                      const size_t& needed)
+{
+    size_t newCapacity;
+
+    T* pNew;
+
+    if (needed > capacity)
+    {
+        newCapacity = std::max<size_t>(2*(size_t)capacity,needed);
+        pNew = new (std::nothrow) T [newCapacity];
+        if (NULL == pNew)
+        {
+            return(false);
+        }
+        if (size > 0)
+        {
+            memcpy(pNew,pArray,size*sizeof(T));
+        }
+        delete[] pArray;
+        pArray = pNew;
+        capacity = newCapacity;
+    }
+
+    return(true);
+}
+
+/*-------------------------[VecStreamReader Methods]--------------------------*/
+/**
+********************************************************************************
+** @details VecStreamReader class constructor
+********************************************************************************
+*/
+VecStreamReader::VecStreamReader()
+{
+    fd = -1;
+    ownFd = false;
+    path = NULL;
+    pStage = NULL;
+    stageStart = 0;
+    stageEnd = 0;
+    memset(batches,0,sizeof(batches));
+    memset(full,0,sizeof(full));
+    nextTake = 0;
+    finished = true;
+    stopping = false;
+    error[0] = '\0';
+}
+
+/**
+********************************************************************************
+** @details VecStreamReader destructor
+********************************************************************************
+*/
+VecStreamReader::~VecStreamReader()
+{
+    close();
+}
+
+/**
+********************************************************************************
+** @details Read bytes from the input. Small reads are served from the staging
+**          buffer, which is refilled a VECSTREAM_STAGE_SIZE block at a time,
+**          and reads larger than the staging buffer go straight to their
+**          destination once the buffer is drained.
+** @param   pDst    Destination of the bytes
+** @param   size    Number of bytes to read
+** @return  Number of bytes read, which is less than size only at the end of
+**          the input or on an error
+********************************************************************************
+*/
+size_t VecStreamReader::readBytes(void* pDst, const size_t& size)
+{
+    char* pOut = static_cast<char*>(pDst);
+
+    size_t done = 0;
+    size_t take;
+
+    ssize_t got;
+
+    while (done < size)
+    {
+        if (stageStart == stageEnd)
+        {
+            if (size - done >= VECSTREAM_STAGE_SIZE)
+            {
+                got = ::read(fd,pOut + done,size - done);
+            }
+            else
+            {
+                got = ::read(fd,pStage,VECSTREAM_STAGE_SIZE);
+                stageStart = 0;
+                stageEnd = std::max<ssize_t>(got,0);
+            }
+
+            if (got < 0 && EINTR == errno)
+            {
+                continue;
+            }
+            else if (got < 0)
+            {
+                snprintf(error,sizeof(error),"Unable to read %s: %s",path,
+                         strerror(errno));
+                break;
+            }
+            else if (0 == got)
+            {
+                break;
+            }
+            else if (stageStart == stageEnd)
+            {
+                done += got;
+                continue;
+            }
+        }
+
+        take = std::min(stageEnd - stageStart,size - done);
+        memcpy(pOut + done,pStage + stageStart,take);
+        stageStart += take;
+        done += take;
+    }
+
+    return(done);
+}
+
+/**
+********************************************************************************
+** @details Discard bytes of the input, such as the elements of a problem that
+**          is not loaded, a VECSTREAM_STAGE_SIZE block at a time
+** @param   size    Number of bytes to discard
+** @return  Number of bytes discarded, which is less than size only at the end
+**          of the input or on an error
+********************************************************************************
+*/
+UINT64 VecStreamReader::skipBytes(const UINT64& size)
+{
+    UINT64 done = 0;
+    UINT64 take;
+
+    ssize_t got;
+
+    while (done < size)
+    {
+        if (stageStart == stageEnd)
+        {
+            got = ::read(fd,pStage,VECSTREAM_STAGE_SIZE);
+            if (got < 0 && EINTR == errno)
+            {
+                continue;
+            }
+            else if (got < 0)
+            {
+                snprintf(error,sizeof(error),"Unable to read %s: %s",path,
+                         strerror(errno));
+                break;
+            }
+            else if (0 == got)
+            {
+                break;
+            }
+
+            stageStart = 0;
+            stageEnd = got;
+        }
+
+        take = std::min<UINT64>(stageEnd - stageStart,size - done);
+        stageStart += take;
+        done += take;
+    }
+
+    return(done);
+}
+
+/**
+********************************************************************************
+** @details Fill a batch with the next problems of the stream, up to
+**          VECSTREAM_BATCH_PROBS problems or VECSTREAM_BATCH_BYTES bytes of
+**          elements. The elements are read straight into the batch data.
+** @param   batch   Batch to fill
+** @return  false once the end of the stream, or an error, is reached
+********************************************************************************
+*/
+bool VecStreamReader::fillBatch(VecBatch& batch)
+{
+    VecRecordHeader record;
+    VecProblem* pProb;
+
+    UINT64 noOfElems;
+    UINT64 done;
+
+    bool loaded;
+
+    batch.noOfProbs = 0;
+    batch.dataSize = 0;
+    batch.indexSize = 0;
+
+    while (batch.noOfProbs < VECSTREAM_BATCH_PROBS &&
+           batch.dataSize*sizeof(double) < VECSTREAM_BATCH_BYTES)
+    {
+        switch (readBytes(&record,sizeof(record)))
+        {
+            case 0:
+                return(false);
+
+            case sizeof(record):
+                break;
+
+            default:
+                if ('\0' == error[0])
+                {
+                    snprintf(error,sizeof(error),"%s: truncated record",path);
+                }
+                return(false);
+        }
+
+        if (0 == record.ndims && 0 == record.noOfVecs)
+        {
+            return(false);
+        }
+
+        if (!growArray(batch.pProbs,batch.probCapacity,batch.noOfProbs,
+                       batch.noOfProbs + 1))
+        {
+            snprintf(error,sizeof(error),"%s: out of memory",path);
+            return(false);
+        }
+
+        noOfElems = (UINT64)record.ndims*record.noOfVecs;
+        if (noOfElems > ~(UINT64)0/sizeof(double))
+        {
+            snprintf(error,sizeof(error),
+                     "%s: invalid problem of %u vectors of dimension %u",path,
+                     record.noOfVecs,record.ndims);
+            return(false);
+        }
+
+        /*
+        ** A problem with no elements, or too large to read, is reported
+        ** unsolved and its elements are skipped
+        */
+        loaded = (0 != noOfElems && noOfElems <= VECSTREAM_MAX_ELEMS &&
+                  growArray(batch.pData,batch.dataCapacity,batch.dataSize,
+                            batch.dataSize + noOfElems) &&
+                  growArray(batch.pIndices,batch.indexCapacity,
+                            batch.indexSize,batch.indexSize + record.noOfVecs));
+
+        if (loaded)
+        {
+            done = readBytes(batch.pData + batch.dataSize,
+                             noOfElems*sizeof(double));
+        }
+        else
+        {
+            done = skipBytes(noOfElems*sizeof(double));
+        }
+
+        if (done != noOfElems*sizeof(double))
+        {
+            if ('\0' == error[0])
+            {
+                snprintf(error,sizeof(error),"%s: truncated record",path);
+            }
+            return(false);
+        }
+
+        pProb = batch.pProbs + batch.noOfProbs;
+        pProb->ndims = record.ndims;
+        pProb->noOfVecs = record.noOfVecs;
+        pProb->dataOffset = batch.dataSize;
+        pProb->indexOffset = batch.indexSize;
+        pProb->noOfBasis = 0;
+        pProb->status = VECRESULT_UNSOLVED;
+        pProb->loaded = loaded;
+
+        batch.noOfProbs++;
+        if (loaded)
+        {
+            batch.dataSize += noOfElems;
+            batch.indexSize += record.noOfVecs;
+        }
+    }
+
+    return(true);
+}
+
+/**
+********************************************************************************
+** @details Body of the read ahead thread. The batches of the ring are filled in
+**          turn, each one as soon as the solver has released it.
+********************************************************************************
+*/
+void VecStreamReader::readLoop(void)
+{
+    UINT32 fill = 0;
+
+    bool more = true;
+
+    while (more)
+    {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            changed.wait(guard,[&]{return(stopping || !full[fill]);});
+            if (stopping)
+            {
+                break;
+            }
+        }
+
+        more = fillBatch(batches[fill]);
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            full[fill] = (batches[fill].noOfProbs > 0);
+            finished = !more;
+        }
+        changed.notify_all();
+
+        fill = (fill + 1)%VECSTREAM_BUFFERS;
+    }
+}
+
+/**
+********************************************************************************
+** @details Open a problem stream, check its header, and start the read ahead
+**          thread
+** @param   streamPath  Name of the stream, or "-" for standard input
+********************************************************************************
+*/
+void VecStreamReader::open(const char* streamPath)
+{
+    VecStreamHeader header;
+
+    close();
+
+    path = streamPath;
+    ownFd = (0 != strcmp(path,"-"));
+    fd = ownFd ? ::open(path,O_RDONLY) : STDIN_FILENO;
+    if (fd < 0)
+    {
+        fprintf(stderr,"Error - %s\n"
+                "        Unable to open %s: %s\n",
+                __PRETTY_FUNCTION__,path,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    pStage = new char [VECSTREAM_STAGE_SIZE];
+    stageStart = 0;
+    stageEnd = 0;
+    error[0] = '\0';
+
+    if (readBytes(&header,sizeof(header)) != sizeof(header) ||
+        0 != memcmp(header.magic,VECSTREAM_MAGIC,sizeof(header.magic)) ||
+        VECFILE_BYTE_ORDER != header.byteOrder ||
+        VECSTREAM_VERSION != header.version)
+    {
+        fprintf(stderr,"Error - %s\n"
+                "        %s: not a problem stream of this byte order and "
+                "version\n",
+                __PRETTY_FUNCTION__,path);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(full,0,sizeof(full));
+    nextTake = 0;
+    finished = false;
+    stopping = false;
+    reader = std::thread(&VecStreamReader::readLoop,this);
+}
+
+/**
+********************************************************************************
+** @details Wait for the next batch of the stream. A read error is reported
+**          once every batch before it has been handed out.
+** @return  Next batch, or NULL at the end of the stream
+********************************************************************************
+*/
+VecBatch* VecStreamReader::next(void)
+{
+    VecBatch* pBatch = NULL;
+
+    std::unique_lock<std::mutex> guard(lock);
+
+    changed.wait(guard,[&]{return(full[nextTake] || finished);});
+    if (full[nextTake])
+    {
+        pBatch = batches + nextTake;
+        nextTake = (nextTake + 1)%VECSTREAM_BUFFERS;
+    }
+    else if ('\0' != error[0])
+    {
+        fprintf(stderr,"Error - %s\n"
+                "        %s\n",
+                __PRETTY_FUNCTION__,error);
+        exit(EXIT_FAILURE);
+    }
+
+    return(pBatch);
+}
+
+/**
+********************************************************************************
+** @details Hand a solved batch back to the read ahead thread
+** @param   pBatch  Batch returned by next()
+********************************************************************************
+*/
+void VecStreamReader::release(VecBatch* pBatch)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        full[pBatch - batches] = false;
+    }
+    changed.notify_all();
+}
+
+/**
+********************************************************************************
+** @details Stop the read ahead thread, close the stream, and free the batches
+********************************************************************************
+*/
+void VecStreamReader::close(void)
+{
+    if (reader.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        changed.notify_all();
+        reader.join();
+    }
+
+    if (ownFd && fd >= 0)
+    {
+        ::close(fd);
+    }
+
+    for (UINT32 b = 0; b < VECSTREAM_BUFFERS; b++)
+    {
+        delete[] batches[b].pProbs;
+        delete[] batches[b].pData;
+        delete[] batches[b].pIndices;
+    }
+
+    delete[] pStage;
+
+    fd = -1;
+    ownFd = false;
+    pStage = NULL;
+    memset(batches,0,sizeof(batches));
+    memset(full,0,sizeof(full));
+    finished = true;
+}
+
+/*-------------------------[VecStreamWriter Methods]--------------------------*/
+/**
+********************************************************************************
+** @details VecStreamWriter class constructor
+********************************************************************************
+*/
+VecStreamWriter::VecStreamWriter()
+{
+    fd = -1;
+    ownFd = false;
+    path = NULL;
+    pHeaders = NULL;
+    headerCapacity = 0;
+}
+
+/**
+********************************************************************************
+** @details VecStreamWriter destructor
+********************************************************************************
+*/
+VecStreamWriter::~VecStreamWriter()
+{
+    close();
+}
+
+/**
+********************************************************************************
+** @details Create a result stream and write its header
+** @param   streamPath  Name of the stream, which is replaced if it exists, or
+**                      "-" for standard output
+********************************************************************************
+*/
+void VecStreamWriter::open(const char* streamPath)
+{
+    VecStreamHeader header;
+    IovList list;
+
+    close();
+
+    path = streamPath;
+    ownFd = (0 != strcmp(path,"-"));
+    fd = ownFd ? ::open(path,O_WRONLY | O_CREAT | O_TRUNC,0644)
+               : STDOUT_FILENO;
+    if (fd < 0)
+    {
+        fprintf(stderr,"Error - %s\n"
+                "        Unable to create %s: %s\n",
+                __PRETTY_FUNCTION__,path,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(header.magic,VECRESULT_MAGIC,sizeof(header.magic));
+    header.version = VECSTREAM_VERSION;
+    header.byteOrder = VECFILE_BYTE_ORDER;
+
+    list.count = 0;
+    list.fd = fd;
+    list.path = path;
+    appendIov(list,&header,sizeof(header));
+    flushIov(list);
+}
+
+/**
+********************************************************************************
+** @details Write the results of a solved batch, in problem order. The basis
+**          vectors and indices are gathered from where the solver left them.
+** @param   batch   Solved batch
+********************************************************************************
+*/
+void VecStreamWriter::write(const VecBatch& batch)
+{
+    static const UINT32 zero = 0;
+
+    const VecProblem* pProb;
+    VecResultHeader* pHeader;
+    IovList* pList;
+
+    growArray(pHeaders,headerCapacity,0,batch.noOfProbs);
+
+    pList = new IovList;
+    pList->count = 0;
+    pList->fd = fd;
+    pList->path = path;
+
+    for (UINT32 p = 0; p < batch.noOfProbs; p++)
+    {
+        pProb = batch.pProbs + p;
+        pHeader = pHeaders + p;
+        pHeader->ndims = pProb->ndims;
+        pHeader->rank = pProb->noOfBasis;
+        pHeader->srcCount = pProb->noOfVecs;
+        pHeader->status = pProb->status;
+
+        appendIov(*pList,pHeader,sizeof(*pHeader));
+        appendIov(*pList,batch.pIndices + pProb->indexOffset,
+                  pProb->noOfBasis*sizeof(UINT32));
+        appendIov(*pList,&zero,(pProb->noOfBasis%2)*sizeof(UINT32));
+        appendIov(*pList,batch.pData + pProb->dataOffset,
+                  (size_t)pProb->noOfBasis*pProb->ndims*sizeof(double));
+    }
+
+    flushIov(*pList);
+
+    delete pList;
+}
+
+/**
+********************************************************************************
+** @details Close the stream
+********************************************************************************
+*/
+void VecStreamWriter::close(void)
+{
+    if (ownFd && fd >= 0 && 0 != ::close(fd))
+    {
+        fprintf(stderr,"Error - %s\n"
+                "        Unable to write %s: %s\n",
+                __PRETTY_FUNCTION__,path,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    delete[] pHeaders;
+
+    fd = -1;
+    ownFd = false;
+    pHeaders = NULL;
+    headerCapacity = 0;
+}
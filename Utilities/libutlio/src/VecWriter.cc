@@ -0,0 +1,486 @@
+/**
+********************************************************************************
+** @file    VecWriter.cc
+**
+** @brief   Implementation of the vector set output routines
+**
+** @details Vector set files are written with writev straight from the vector
+**          storage, so the vectors are not copied into an output buffer. Text
+**          is formatted in parallel blocks by the thread pool, with a fixed-
+**          point formatter that only falls back to snprintf for values it
+**          cannot round exactly.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  VecWriter.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cfloat>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "VecWriter.hh"
+#include "ThreadPool.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @struct  TextBlock
+** @brief   Block of vectors formatted as text by one task
+********************************************************************************
+*/
+struct TextBlock
+{
+    const double* pFirst;   /* First vector of the block */
+    UINT32 noOfVecs;        /* Number of vectors in the block */
+    char* pText;            /* Formatted text */
+    size_t size;            /* Number of characters of text */
+    size_t capacity;        /* Number of characters allocated */
+};
+
+/**
+********************************************************************************
+** @details Write every gathered piece to the file, following partial writes
+** @param   list    Gathered pieces, emptied on return
+********************************************************************************
+*/
+void flushIov(IovList& list)
+{
+    struct iovec* pVec = list.vec;
+
+    ssize_t written;
+
+    while (list.count > 0)
+    {
+        written = writev(list.fd,pVec,list.count);
+        if (written < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            printf("Error - %s\n"
+                   "        Unable to write %s: %s\n",
+                   __PRETTY_FUNCTION__,list.path,strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+
+        while (list.count > 0 && (size_t)written >= pVec->iov_len)
+        {
+            written -= pVec->iov_len;
+            pVec++;
+            list.count--;
+        }
+
+        if (list.count > 0)
+        {
+            pVec->iov_base = static_cast<char*>(pVec->iov_base) + written;
+            pVec->iov_len -= written;
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Gather a piece of the file, writing the gathered pieces first if
+**          the list is full
+** @param   list    Gathered pieces
+** @param   pData   Start of the piece, which must stay valid until flushed
+** @param   size    Number of bytes in the piece
+********************************************************************************
+*/
+void appendIov(IovList& list, const void* pData, const size_t& size)
+{
+    if (0 == size)
+    {
+        return;
+    }
+
+    if (IOV_MAX == list.count)
+    {
+        flushIov(list);
+    }
+
+    list.vec[list.count].iov_base = const_cast<void*>(pData);
+    list.vec[list.count].iov_len = size;
+    list.count++;
+}
+
+/**
+********************************************************************************
+** @details Write a vector set to a vector set file. The file is gathered with
+**          writev from the header, the vectors where they are stored, and a
+**          block of zeros for the padding, so nothing is copied on the way
+**          out. A set stored unpadded with the leading dimension of the file
+**          is written in one piece.
+** @param   path        Name of the file, which is replaced if it exists
+** @param   pVecs       Pointer to the vector set
+** @param   lda         Leading dimension of the vector set
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors
+** @param   pIndices    Index in the source set of each vector, or NULL
+** @param   rank        Rank of the source set
+** @param   srcCount    Number of vectors in the source set
+** @param   align       Alignment in bytes of each vector in the file, a power
+**                      of two of at least 8
+********************************************************************************
+*/
+void writeVecFile(const char* path, const double* pVecs, const UINT32& lda,
+                  const UINT32& m, const UINT32& n, const UINT32* pIndices,
+                  const UINT32& rank, const UINT32& srcCount,
+                  const UINT32& align)
+{
+    VecFileHeader header;
+
+    UINT32 ld;
+    UINT64 dataOffset;
+
+    char* pZeros;
+    IovList* pList;
+
+    if (0 == m || 0 == n || lda < m || align < sizeof(double) ||
+        0 != (align & (align - 1)))
+    {
+        printf("Error - %s\n"
+               "        Invalid vector set file of %u vectors of dimension "
+               "%u\n"
+               "        with alignment %u\n",
+               __PRETTY_FUNCTION__,n,m,align);
+        exit(EXIT_FAILURE);
+    }
+
+    ld = (m*sizeof(double) + align - 1)/align*align/sizeof(double);
+    dataOffset = (VECFILE_HEADER_SIZE + align - 1)/align*align;
+
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,VECFILE_MAGIC,sizeof(header.magic));
+    header.version = VECFILE_VERSION;
+    header.byteOrder = VECFILE_BYTE_ORDER;
+    header.dtype = VECFILE_FLOAT64;
+    header.layout = VECFILE_BY_VECTOR;
+    header.align = align;
+    header.ndims = m;
+    header.noOfVecs = n;
+    header.ld = ld;
+    header.dataOffset = dataOffset;
+    header.rank = rank;
+    header.srcCount = srcCount;
+    header.indexOffset = (NULL == pIndices)
+                       ? 0 : dataOffset + (UINT64)ld*n*sizeof(double);
+
+    pList = new IovList;
+    pList->count = 0;
+    pList->path = path;
+    pList->fd = ::open(path,O_WRONLY | O_CREAT | O_TRUNC,0644);
+    if (pList->fd < 0)
+    {
+        printf("Error - %s\n"
+               "        Unable to create %s: %s\n",
+               __PRETTY_FUNCTION__,path,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    /*
+    ** Padding never exceeds the alignment, so one block of zeros serves both
+    ** the header and every vector
+    */
+    pZeros = new char [align]();
+
+    appendIov(*pList,&header,sizeof(header));
+    appendIov(*pList,pZeros,dataOffset - sizeof(header));
+
+    if (lda == m && m == ld)
+    {
+        appendIov(*pList,pVecs,(size_t)n*ld*sizeof(double));
+    }
+    else
+    {
+        for (UINT32 j = 0; j < n; j++)
+        {
+            appendIov(*pList,pVecs + (size_t)j*lda,m*sizeof(double));
+            appendIov(*pList,pZeros,(ld - m)*sizeof(double));
+        }
+    }
+
+    if (NULL != pIndices)
+    {
+        appendIov(*pList,pIndices,(size_t)n*sizeof(UINT32));
+    }
+
+    flushIov(*pList);
+
+    if (0 != ::close(pList->fd))
+    {
+        printf("Error - %s\n"
+               "        Unable to write %s: %s\n",
+               __PRETTY_FUNCTION__,path,strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    delete[] pZeros;
+    delete pList;
+}
+
+/**
+********************************************************************************
+** @details Make room for more text at the end of a block
+** @param   block   Block of text
+** @param   extra   Number of characters needed
+********************************************************************************
+*/
+static void reserveText(TextBlock& block, const size_t& extra)
+{
+    char* pText;
+
+    if (block.size + extra > block.capacity)
+    {
+        block.capacity = std::max(2*block.capacity,block.size + extra);
+        pText = new char [block.capacity];
+        if (block.size > 0)
+        {
+            memcpy(pText,block.pText,block.size);
+        }
+        delete[] block.pText;
+        block.pText = pText;
+    }
+}
+
+/**
+********************************************************************************
+** @details Format a number as snprintf does with "%*.*f". The number is scaled
+**          by 10^decimals and rounded to an integer, whose digits are then
+**          written with the decimal point in place. The scaled value carries
+**          at most one rounding error, so when it is close enough to halfway
+**          between two integers that the rounding could go either way, or too
+**          large for the integer, snprintf is used instead.
+** @param   pOut        Output position, with room for maxSize characters
+** @param   x           Number to format
+** @param   width       Minimum number of characters
+** @param   decimals    Number of digits after the decimal point
+** @param   scale       10^decimals, or 0 to always use snprintf
+** @param   maxSize     Room at the output position
+** @return  Position after the formatted number
+********************************************************************************
+*/
+static char* formatFixed(char* pOut, const double& x, const UINT32& width,
+                         const UINT32& decimals, const double& scale,
+                         const size_t& maxSize)
+{
+    char digits[32];
+
+    double scaled = fabs(x)*scale;
+    double halfway;
+
+    UINT64 rounded;
+    UINT32 noOfDigits = 0;
+    UINT32 length;
+
+    bool negative = std::signbit(x);
+
+    halfway = scaled - floor(scaled) - 0.5;
+    if (0 == scale || !(scaled < 1E15) || fabs(halfway) <= scaled*1E-15)
+    {
+        return(pOut + snprintf(pOut,maxSize,"%*.*f",width,decimals,x));
+    }
+
+    rounded = (UINT64)(scaled + 0.5);
+    do
+    {
+        digits[noOfDigits++] = '0' + rounded%10;
+        rounded /= 10;
+    } while (rounded > 0 || noOfDigits <= decimals);
+
+    length = noOfDigits + (decimals > 0) + negative;
+    for (; length < width; length++)
+    {
+        *pOut++ = ' ';
+    }
+
+    if (negative)
+    {
+        *pOut++ = '-';
+    }
+
+    for (INT32 k = noOfDigits - 1; k >= 0; k--)
+    {
+        *pOut++ = digits[k];
+        if (k == (INT32)decimals && decimals > 0)
+        {
+            *pOut++ = '.';
+        }
+    }
+
+    return(pOut);
+}
+
+/**
+********************************************************************************
+** @details Format the vectors of a block, replacing its text
+** @param   block       Block of vectors
+** @param   lda         Leading dimension of the vector set
+** @param   m           Dimension of each vector
+** @param   width       Minimum number of characters in each element
+** @param   decimals    Number of digits after the decimal point
+** @param   scale       10^decimals, or 0 to always use snprintf
+********************************************************************************
+*/
+static void formatBlock(TextBlock& block, const UINT32& lda, const UINT32& m,
+                        const UINT32& width, const UINT32& decimals,
+                        const double& scale)
+{
+    const double* pVec;
+    char* pOut;
+
+    /*
+    ** Room for the longest number snprintf can produce, with the leading
+    ** space and the new line
+    */
+    const size_t maxSize = width + decimals + DBL_MAX_10_EXP + 4;
+
+    block.size = 0;
+    for (UINT32 j = 0; j < block.noOfVecs; j++)
+    {
+        reserveText(block,64);
+        block.size += snprintf(block.pText + block.size,64,
+                               "Vector dimension: %u\n%s\n",m,
+                               (1 == m) ? "Vector element" : "Vector elements");
+
+        pVec = block.pFirst + (size_t)j*lda;
+        for (UINT32 i = 0; i < m; i++)
+        {
+            reserveText(block,maxSize);
+            pOut = block.pText + block.size;
+            *pOut++ = ' ';
+            pOut = formatFixed(pOut,pVec[i],width,decimals,scale,maxSize - 2);
+            *pOut++ = '\n';
+            block.size = pOut - block.pText;
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Write a vector set as fixed-width text, in the layout of
+**          Vector::objPrint() with each element printed as " %*.*f". The set
+**          is formatted a window of blocks at a time, with the blocks of a
+**          window formatted in parallel and written in order.
+** @param   pFile       Output file
+** @param   pVecs       Pointer to the vector set
+** @param   lda         Leading dimension of the vector set
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors
+** @param   width       Minimum number of characters in each element
+** @param   decimals    Number of digits after the decimal point
+********************************************************************************
+*/
+void writeVecText(FILE* pFile, const double* pVecs, const UINT32& lda,
+                  const UINT32& m, const UINT32& n, const UINT32& width,
+                  const UINT32& decimals)
+{
+    UINT32 vecsPerBlock;
+    UINT32 noOfBlocks;
+    UINT64 first;
+
+    double scale = 1;
+
+    TextBlock* pBlocks;
+
+    if (0 == m || lda < m)
+    {
+        printf("Error - %s\n"
+               "        Invalid vector set of dimension %u\n",
+               __PRETTY_FUNCTION__,m);
+        exit(EXIT_FAILURE);
+    }
+
+    /*
+    ** Powers of ten up to 10^22 are exact
+    */
+    for (UINT32 k = 0; k < decimals; k++)
+    {
+        scale *= 10;
+    }
+    scale = (decimals <= 22) ? scale : 0;
+
+    /*
+    ** A small set is formatted as one block on the calling thread
+    */
+    vecsPerBlock = std::max(VECTEXT_BLOCK_SIZE/m,1U);
+    noOfBlocks = std::min<UINT64>(2*ThreadPool::instance().getThreadCount(),
+                                  ((UINT64)n + vecsPerBlock - 1)/vecsPerBlock);
+    pBlocks = new TextBlock [noOfBlocks]();
+
+    for (first = 0; first < n; first += (UINT64)noOfBlocks*vecsPerBlock)
+    {
+        for (UINT32 b = 0; b < noOfBlocks; b++)
+        {
+            UINT64 start = std::min<UINT64>(first + (UINT64)b*vecsPerBlock,n);
+
+            pBlocks[b].pFirst = pVecs + start*lda;
+            pBlocks[b].noOfVecs = std::min<UINT64>(n - start,vecsPerBlock);
+        }
+
+        ThreadPool::instance().parallelFor(0,noOfBlocks,1,
+            [&](UINT32 lo, UINT32 hi)
+            {
+                for (UINT32 b = lo; b < hi; b++)
+                {
+                    formatBlock(pBlocks[b],lda,m,width,decimals,scale);
+                }
+            });
+
+        for (UINT32 b = 0; b < noOfBlocks; b++)
+        {
+            if (pBlocks[b].size > 0 &&
+                fwrite(pBlocks[b].pText,1,pBlocks[b].size,pFile) !=
+                pBlocks[b].size)
+            {
+                printf("Error - %s\n"
+                       "        Unable to write the vectors: %s\n",
+                       __PRETTY_FUNCTION__,strerror(errno));
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    for (UINT32 b = 0; b < noOfBlocks; b++)
+    {
+        delete[] pBlocks[b].pText;
+    }
+    delete[] pBlocks;
+}
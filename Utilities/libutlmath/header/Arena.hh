@@ -0,0 +1,310 @@
+/**
+********************************************************************************
+** @file    Arena.hh
+**
+** @brief   Declaration of the Arena memory allocator
+**
+** @details An Arena hands out memory from large blocks by advancing an
+**          offset, and releases everything allocated after a mark by moving
+**          the offset back. An ArenaScope makes an arena the current arena of
+**          its thread, so the Vector and Matrix classes and the scratch arrays
+**          of the library draw from it, and releases the scope in O(1) when it
+**          ends.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Arena.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _ARENA_HH_
+#define _ARENA_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstddef>
+#include <cstdint>
+
+#include "StdTypes.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @def   ARENA_BLOCK_SIZE
+** @brief Default number of bytes in each arena block
+********************************************************************************
+*/
+#define ARENA_BLOCK_SIZE (1 << 20)
+
+/**
+********************************************************************************
+** @def   ARENA_ALIGN
+** @brief Alignment in bytes of every arena allocation
+********************************************************************************
+*/
+#define ARENA_ALIGN 64
+
+/**
+********************************************************************************
+** @details Round a pointer into a heap buffer up to the next ARENA_ALIGN
+**          boundary. The buffer must have ARENA_ALIGN/sizeof(double) - 1 spare
+**          elements.
+** @param   pRaw    Pointer to the buffer
+** @return  First aligned element of the buffer
+********************************************************************************
+*/
+inline double* alignDoubles(double* pRaw)
+{
+    uintptr_t addr = reinterpret_cast<uintptr_t>(pRaw);
+
+    addr = (addr + ARENA_ALIGN - 1) & ~(uintptr_t)(ARENA_ALIGN - 1);
+
+    return(reinterpret_cast<double*>(addr));
+}
+
+/**
+********************************************************************************
+** @struct  ArenaMark
+** @brief   Position in an arena that it can be rewound to
+********************************************************************************
+*/
+struct ArenaMark
+{
+    UINT32 block;   /* Index of the current block */
+    size_t offset;  /* Bytes used in the current block */
+};
+
+/**
+********************************************************************************
+** @class   Arena
+** @brief   Bump allocator that releases memory in O(1)
+** @details Memory is handed out from a list of blocks. A request that does not
+**          fit in the current block moves to the next block, and a new block
+**          is added when no block left is large enough. Rewinding keeps the
+**          blocks, so once an arena has grown to the size a scope needs, later
+**          scopes make no heap allocations. An arena is used by one thread at
+**          a time.
+********************************************************************************
+*/
+class Arena
+{
+    private:
+
+        /*
+        ** Block of arena memory
+        */
+        struct ArenaBlock
+        {
+            char* pRaw;     /* Allocated memory */
+            char* pData;    /* First aligned byte */
+            size_t size;    /* Number of usable bytes */
+        };
+
+        ArenaBlock* pBlocks;    /* Array of blocks */
+        UINT32 noOfBlocks;      /* Number of blocks */
+        UINT32 capacity;        /* Size of the block array */
+
+        size_t blockSize;       /* Default size of a new block */
+
+        ArenaMark top;          /* Next free byte */
+
+        /*
+        ** Add a block of at least the given size
+        */
+        void addBlock(const size_t& size);
+
+        /*
+        ** Copy constructor and assignment (disabled)
+        */
+        Arena(const Arena& arena);
+        Arena& operator=(const Arena& rhs);
+
+    public:
+
+        /*
+        ** Constructor (one parameter)
+        */
+        explicit Arena(const size_t& size = ARENA_BLOCK_SIZE);
+
+        /*
+        ** Destructor
+        */
+        ~Arena();
+
+        /*
+        ** Allocate bytes aligned to ARENA_ALIGN
+        */
+        void* allocate(const size_t& bytes);
+
+        /*
+        ** Allocate an array of doubles
+        */
+        double* allocDoubles(const size_t& n)
+        {
+            return(static_cast<double*>(allocate(n*sizeof(double))));
+        }
+
+        /*
+        ** Make sure the next allocations of up to size bytes need no new block
+        */
+        void reserve(const size_t& size);
+
+        /*
+        ** Return the current position, which can be rewound to later
+        */
+        ArenaMark getMark(void) const
+        {
+            return(top);
+        }
+
+        /*
+        ** Release every allocation made after a mark
+        */
+        void rewind(const ArenaMark& mark)
+        {
+            top = mark;
+        }
+
+        /*
+        ** Release every allocation
+        */
+        void reset(void)
+        {
+            top.block = 0;
+            top.offset = 0;
+        }
+
+        /*
+        ** Get the number of bytes held in all blocks
+        */
+        size_t getCapacity(void) const;
+
+        /*
+        ** Get the arena of the calling thread's innermost scope, or NULL
+        */
+        static Arena* current(void);
+};
+
+/**
+********************************************************************************
+** @class   ArenaScope
+** @brief   Make an arena current for the lifetime of the scope
+** @details While a scope is alive on a thread, Vector and Matrix storage and
+**          the library scratch arrays allocated on that thread come from its
+**          arena. The scope rewinds the arena to where it started and restores
+**          the previous current arena when it ends. Objects that draw from
+**          the arena must not outlive the scope.
+********************************************************************************
+*/
+class ArenaScope
+{
+    private:
+        Arena& arena;       /* Arena of the scope */
+        Arena* pPrevious;   /* Current arena before the scope */
+        ArenaMark start;    /* Arena position at the start of the scope */
+
+        /*
+        ** Copy constructor and assignment (disabled)
+        */
+        ArenaScope(const ArenaScope& scope);
+        ArenaScope& operator=(const ArenaScope& rhs);
+
+    public:
+
+        /*
+        ** Constructor (one parameter)
+        */
+        explicit ArenaScope(Arena& scopeArena);
+
+        /*
+        ** Destructor
+        */
+        ~ArenaScope();
+};
+
+/**
+********************************************************************************
+** @class   ArenaArray
+** @brief   Scratch array of doubles from the current arena
+** @details The array comes from the current arena of the thread if there is
+**          one, and is released with the arena scope. Otherwise it is
+**          allocated on the heap and deleted by the destructor. Either way the
+**          first element is aligned to ARENA_ALIGN.
+********************************************************************************
+*/
+class ArenaArray
+{
+    private:
+        double* pRaw;   /* Heap allocation, or NULL if in an arena */
+        double* pData;  /* Aligned array elements */
+
+        /*
+        ** Copy constructor and assignment (disabled)
+        */
+        ArenaArray(const ArenaArray& array);
+        ArenaArray& operator=(const ArenaArray& rhs);
+
+    public:
+
+        /*
+        ** Constructor (one parameter)
+        */
+        explicit ArenaArray(const size_t& n)
+        {
+            Arena* pArena = Arena::current();
+
+            if (NULL != pArena)
+            {
+                pRaw = NULL;
+                pData = pArena->allocDoubles(n);
+            }
+            else
+            {
+                pRaw = new double [n + ARENA_ALIGN/sizeof(double) - 1];
+                pData = alignDoubles(pRaw);
+            }
+        }
+
+        /*
+        ** Destructor
+        */
+        ~ArenaArray()
+        {
+            delete[] pRaw;
+        }
+
+        /*
+        ** Get the array elements
+        */
+        double* get(void) const
+        {
+            return(pData);
+        }
+};
+
+#endif
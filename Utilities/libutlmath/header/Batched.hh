@@ -0,0 +1,86 @@
+/**
+********************************************************************************
+** @file    Batched.hh
+**
+** @brief   Declaration of the batched orthonormalization routine
+**
+** @details A batch of many small vector sets of the same size is
+**          orthonormalized in one call. The batch is stored as a structure of
+**          arrays, so each SIMD lane of the kernels works on a different
+**          problem and no per-problem objects are allocated.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Batched.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _BATCHED_HH_
+#define _BATCHED_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstddef>
+
+#include "StdTypes.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/*
+** Batch storage
+**
+** A batch of noOfProblems problems, each a set of n vectors of dimension m, is
+** stored as a structure of arrays. The same element of every problem is
+** contiguous, so element i of vector j of problem p is found at
+** pBatch[(j*m + i)*noOfProblems + p].
+*/
+
+/**
+********************************************************************************
+** @details Index of an element in a batch of vector sets
+** @param   p               Problem index
+** @param   j               Vector index
+** @param   i               Element index
+** @param   m               Dimension of each vector
+** @param   noOfProblems    Number of problems in the batch
+** @return  Index of the element
+********************************************************************************
+*/
+inline size_t batchIndex(const UINT32& p, const UINT32& j, const UINT32& i,
+                         const UINT32& m, const UINT32& noOfProblems)
+{
+    return(((size_t)j*m + i)*noOfProblems + p);
+}
+
+/*
+** Orthonormalize every vector set of a batch in place with the Modified
+** Gram-Schmidt algorithm, returning the number of problems with full rank
+*/
+UINT32 orthonormalizeBatched(double* pBatch, const UINT32& m, const UINT32& n,
+                             const UINT32& noOfProblems, UINT32* pRank);
+
+#endif
@@ -0,0 +1,507 @@
+/**
+********************************************************************************
+** @file    Expression.hh
+**
+** @brief   Expression templates for Vector and Matrix arithmetic
+**
+** @details The element-wise Vector and Matrix operators return lightweight
+**          expression objects instead of new objects. An expression is only
+**          evaluated when it is assigned to, or used to construct, a Vector or
+**          Matrix object, so a compound expression such as a - s*b is
+**          calculated in one loop without any temporary objects.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Expression.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _EXPRESSION_HH_
+#define _EXPRESSION_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstdio>
+#include <cstdlib>
+
+#include "StdTypes.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+class Vector;
+class Matrix;
+
+/**
+********************************************************************************
+** @class   VectorExpr
+** @brief   Base class of every Vector expression
+** @details The derived expression type E is given as the template parameter,
+**          so the elements of an expression are evaluated without any virtual
+**          function calls. Each derived type provides eval() and getSize().
+********************************************************************************
+*/
+template <typename E>
+class VectorExpr
+{
+    public:
+
+        /*
+        ** Return the derived expression object
+        */
+        const E& expr(void) const
+        {
+            return(static_cast<const E&>(*this));
+        }
+};
+
+/**
+********************************************************************************
+** @class   MatrixExpr
+** @brief   Base class of every Matrix expression
+** @details The derived expression type E is given as the template parameter.
+**          Each derived type provides eval(), getRows(), and getCols(), where
+**          eval() takes the row and column of an element, so an expression
+**          is evaluated the same way whatever the storage layout and padding
+**          of its operands.
+********************************************************************************
+*/
+template <typename E>
+class MatrixExpr
+{
+    public:
+
+        /*
+        ** Return the derived expression object
+        */
+        const E& expr(void) const
+        {
+            return(static_cast<const E&>(*this));
+        }
+};
+
+/**
+********************************************************************************
+** @class   ExprOperand
+** @brief   Storage type of an expression operand
+** @details Vector and Matrix operands are held by reference, since they
+**          outlive the full expression. Intermediate expressions are small
+**          temporaries and are held by value.
+********************************************************************************
+*/
+template <typename E>
+struct ExprOperand
+{
+    typedef const E type;
+};
+
+template <>
+struct ExprOperand<Vector>
+{
+    typedef const Vector& type;
+};
+
+template <>
+struct ExprOperand<Matrix>
+{
+    typedef const Matrix& type;
+};
+
+/**
+********************************************************************************
+** @brief Element-wise addition
+********************************************************************************
+*/
+struct ExprAdd
+{
+    static double apply(const double& lhs, const double& rhs)
+    {
+        return(lhs + rhs);
+    }
+};
+
+/**
+********************************************************************************
+** @brief Element-wise subtraction
+********************************************************************************
+*/
+struct ExprSub
+{
+    static double apply(const double& lhs, const double& rhs)
+    {
+        return(lhs - rhs);
+    }
+};
+
+/**
+********************************************************************************
+** @details Verify the sizes of two expression operands are equal
+** @param   n1  Number of elements in the first operand
+** @param   n2  Number of elements in the second operand
+********************************************************************************
+*/
+inline void checkExprSize(const UINT32& n1, const UINT32& n2)
+{
+    if (0 == n1 || 0 == n2)
+    {
+        printf("Error - %s\n"
+               "        Zero element operand not allowed in operations\n",
+               __PRETTY_FUNCTION__);
+        exit(EXIT_FAILURE);
+    }
+    else if (n1 != n2)
+    {
+        printf("Error - %s\n"
+               "        Operand sizes are not equal\n",
+               __PRETTY_FUNCTION__);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/*----------------------------[Vector Expressions]----------------------------*/
+/**
+********************************************************************************
+** @class   VectorBinary
+** @brief   Element-wise binary operation of two Vector expressions
+********************************************************************************
+*/
+template <typename L, typename R, typename Op>
+class VectorBinary : public VectorExpr<VectorBinary<L,R,Op> >
+{
+    private:
+        typename ExprOperand<L>::type lhs;  /* Left operand */
+        typename ExprOperand<R>::type rhs;  /* Right operand */
+
+    public:
+
+        /*
+        ** Constructor (two parameters)
+        */
+        VectorBinary(const L& l, const R& r) : lhs(l), rhs(r)
+        {
+            checkExprSize(lhs.getSize(),rhs.getSize());
+        }
+
+        /*
+        ** Evaluate an element of the expression
+        */
+        double eval(const UINT32& i) const
+        {
+            return(Op::apply(lhs.eval(i),rhs.eval(i)));
+        }
+
+        /*
+        ** Return the expression dimension
+        */
+        UINT32 getSize(void) const
+        {
+            return(lhs.getSize());
+        }
+};
+
+/**
+********************************************************************************
+** @class   VectorScale
+** @brief   Vector expression multiplied by a double
+********************************************************************************
+*/
+template <typename E>
+class VectorScale : public VectorExpr<VectorScale<E> >
+{
+    private:
+        double scale;                       /* Scalar multiplier */
+        typename ExprOperand<E>::type vec;  /* Vector operand */
+
+    public:
+
+        /*
+        ** Constructor (two parameters)
+        */
+        VectorScale(const double& s, const E& v) : scale(s), vec(v)
+        {
+        }
+
+        /*
+        ** Evaluate an element of the expression
+        */
+        double eval(const UINT32& i) const
+        {
+            return(scale*vec.eval(i));
+        }
+
+        /*
+        ** Return the expression dimension
+        */
+        UINT32 getSize(void) const
+        {
+            return(vec.getSize());
+        }
+};
+
+/**
+********************************************************************************
+** @class   VectorDivide
+** @brief   Vector expression divided by a double
+********************************************************************************
+*/
+template <typename E>
+class VectorDivide : public VectorExpr<VectorDivide<E> >
+{
+    private:
+        typename ExprOperand<E>::type vec;  /* Vector operand */
+        double divisor;                     /* Scalar divisor */
+
+    public:
+
+        /*
+        ** Constructor (two parameters)
+        */
+        VectorDivide(const E& v, const double& d) : vec(v), divisor(d)
+        {
+        }
+
+        /*
+        ** Evaluate an element of the expression
+        */
+        double eval(const UINT32& i) const
+        {
+            return(vec.eval(i)/divisor);
+        }
+
+        /*
+        ** Return the expression dimension
+        */
+        UINT32 getSize(void) const
+        {
+            return(vec.getSize());
+        }
+};
+
+/**
+********************************************************************************
+** @details Vector expression addition
+** @param   lhs Vector expression
+** @param   rhs Vector expression
+** @return  Expression for the addition of elements
+********************************************************************************
+*/
+template <typename L, typename R>
+inline VectorBinary<L,R,ExprAdd> operator+(const VectorExpr<L>& lhs,
+                                           const VectorExpr<R>& rhs)
+{
+    return(VectorBinary<L,R,ExprAdd>(lhs.expr(),rhs.expr()));
+}
+
+/**
+********************************************************************************
+** @details Vector expression subtraction
+** @param   lhs Vector expression
+** @param   rhs Vector expression
+** @return  Expression for the subtraction of elements
+********************************************************************************
+*/
+template <typename L, typename R>
+inline VectorBinary<L,R,ExprSub> operator-(const VectorExpr<L>& lhs,
+                                           const VectorExpr<R>& rhs)
+{
+    return(VectorBinary<L,R,ExprSub>(lhs.expr(),rhs.expr()));
+}
+
+/**
+********************************************************************************
+** @details Double multiplied by a Vector expression
+** @param   lhs double data type
+** @param   rhs Vector expression
+** @return  Expression with every element multiplied by lhs
+********************************************************************************
+*/
+template <typename E>
+inline VectorScale<E> operator*(const double& lhs, const VectorExpr<E>& rhs)
+{
+    return(VectorScale<E>(lhs,rhs.expr()));
+}
+
+/**
+********************************************************************************
+** @details Vector expression divided by a double
+** @param   lhs Vector expression
+** @param   rhs double data type
+** @return  Expression with every element divided by rhs
+********************************************************************************
+*/
+template <typename E>
+inline VectorDivide<E> operator/(const VectorExpr<E>& lhs, const double& rhs)
+{
+    return(VectorDivide<E>(lhs.expr(),rhs));
+}
+
+/*----------------------------[Matrix Expressions]----------------------------*/
+/**
+********************************************************************************
+** @class   MatrixBinary
+** @brief   Element-wise binary operation of two Matrix expressions
+********************************************************************************
+*/
+template <typename L, typename R, typename Op>
+class MatrixBinary : public MatrixExpr<MatrixBinary<L,R,Op> >
+{
+    private:
+        typename ExprOperand<L>::type lhs;  /* Left operand */
+        typename ExprOperand<R>::type rhs;  /* Right operand */
+
+    public:
+
+        /*
+        ** Constructor (two parameters)
+        */
+        MatrixBinary(const L& l, const R& r) : lhs(l), rhs(r)
+        {
+            if (lhs.getRows() != rhs.getRows() ||
+                lhs.getCols() != rhs.getCols())
+            {
+                printf("Error - %s\n"
+                       "        Matrix dimensions are not equal\n",
+                       __PRETTY_FUNCTION__);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        /*
+        ** Evaluate an element of the expression
+        */
+        double eval(const UINT32& i, const UINT32& j) const
+        {
+            return(Op::apply(lhs.eval(i,j),rhs.eval(i,j)));
+        }
+
+        /*
+        ** Return the number of rows in the expression
+        */
+        UINT32 getRows(void) const
+        {
+            return(lhs.getRows());
+        }
+
+        /*
+        ** Return the number of columns in the expression
+        */
+        UINT32 getCols(void) const
+        {
+            return(lhs.getCols());
+        }
+};
+
+/**
+********************************************************************************
+** @class   MatrixScale
+** @brief   Matrix expression multiplied by a double
+********************************************************************************
+*/
+template <typename E>
+class MatrixScale : public MatrixExpr<MatrixScale<E> >
+{
+    private:
+        double scale;                       /* Scalar multiplier */
+        typename ExprOperand<E>::type mat;  /* Matrix operand */
+
+    public:
+
+        /*
+        ** Constructor (two parameters)
+        */
+        MatrixScale(const double& s, const E& m) : scale(s), mat(m)
+        {
+        }
+
+        /*
+        ** Evaluate an element of the expression
+        */
+        double eval(const UINT32& i, const UINT32& j) const
+        {
+            return(scale*mat.eval(i,j));
+        }
+
+        /*
+        ** Return the number of rows in the expression
+        */
+        UINT32 getRows(void) const
+        {
+            return(mat.getRows());
+        }
+
+        /*
+        ** Return the number of columns in the expression
+        */
+        UINT32 getCols(void) const
+        {
+            return(mat.getCols());
+        }
+};
+
+/**
+********************************************************************************
+** @details Matrix expression subtraction
+** @param   lhs Matrix expression
+** @param   rhs Matrix expression
+** @return  Expression for the subtraction of elements
+********************************************************************************
+*/
+template <typename L, typename R>
+inline MatrixBinary<L,R,ExprSub> operator-(const MatrixExpr<L>& lhs,
+                                           const MatrixExpr<R>& rhs)
+{
+    return(MatrixBinary<L,R,ExprSub>(lhs.expr(),rhs.expr()));
+}
+
+/**
+********************************************************************************
+** @details Double multiplied by a Matrix expression
+** @param   lhs double data type
+** @param   rhs Matrix expression
+** @return  Expression with every element multiplied by lhs
+********************************************************************************
+*/
+template <typename E>
+inline MatrixScale<E> operator*(const double& lhs, const MatrixExpr<E>& rhs)
+{
+    return(MatrixScale<E>(lhs,rhs.expr()));
+}
+
+/**
+********************************************************************************
+** @details Matrix expression multiplied by a double
+** @param   lhs Matrix expression
+** @param   rhs double data type
+** @return  Expression with every element multiplied by rhs
+********************************************************************************
+*/
+template <typename E>
+inline MatrixScale<E> operator*(const MatrixExpr<E>& lhs, const double& rhs)
+{
+    return(MatrixScale<E>(rhs,lhs.expr()));
+}
+
+#endif
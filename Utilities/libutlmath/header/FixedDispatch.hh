@@ -0,0 +1,73 @@
+/**
+********************************************************************************
+** @file    FixedDispatch.hh
+**
+** @brief   Declaration of the fixed dimension dispatch routines
+**
+** @details Routines that take their dimensions at run time and send the
+**          common small dimensions to the fixed dimension code of
+**          FixedVector.hh and FixedMatrix.hh are declared here. Every other dimension uses the
+**          dynamic Matrix class and orthonormalization routines.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  FixedDispatch.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _FIXED_DISPATCH_HH_
+#define _FIXED_DISPATCH_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include "StdTypes.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/*
+** Return true if the dimension has fixed dimension code: 2, 3, 4, 6, 8, or 16
+*/
+bool isFixedDim(const UINT32& n);
+
+/*
+** Orthonormalize a set of n contiguous vectors of dimension m in place with
+** the Modified Gram-Schmidt algorithm
+*/
+UINT32 orthonormalizeFixed(double* pVecs, const UINT32& m, const UINT32& n,
+                           const UINT32& setRank, UINT32* pOrthVecInd);
+
+/*
+** Calculate the rank of a row-major m x n matrix
+*/
+UINT32 rankFixed(const double* pMat, const UINT32& m, const UINT32& n);
+
+/*
+** Calculate the determinant of a row-major n x n matrix
+*/
+double determinantFixed(const double* pMat, const UINT32& n);
+
+#endif
@@ -0,0 +1,481 @@
+/**
+********************************************************************************
+** @file    FixedMatrix.hh
+**
+** @brief   Fixed size matrices with inline storage
+**
+** @details The FixedMatrix class template holds the elements of an M x N
+**          matrix in the object itself. The rank and determinant use the same
+**          Householder QR decomposition as the Matrix class, and the Modified
+**          Gram-Schmidt routine follows orthonormalize(), but with the loop
+**          lengths fixed at compile time and the working storage on the stack.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  FixedMatrix.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _FIXED_MATRIX_HH_
+#define _FIXED_MATRIX_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include "StdTypes.hh"
+#include "FixedVector.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/*-----------------------------[Fixed Routines]-------------------------------*/
+/**
+********************************************************************************
+** @details Orthonormalize a set of n vectors of dimension M in place with the
+**          Modified Gram-Schmidt algorithm. The vectors are contiguous, one
+**          after another, and the results follow orthonormalize(): the first
+**          setRank vectors hold the basis and pOrthVecInd receives the input
+**          index of each basis vector.
+** @param   pVecs       Pointer to the vector set
+** @param   n           Number of vectors
+** @param   setRank     Rank of the vector set
+** @param   pOrthVecInd Array of at least setRank elements that receives the
+**                      index of the input vector of each basis vector
+** @return  Number of orthonormal basis vectors, which is less than setRank
+**          when fewer than setRank vectors of the set are independent to
+**          FLOAT_TOL
+********************************************************************************
+*/
+template <UINT32 M>
+constexpr UINT32 fixedOrthonormalize(double* pVecs, const UINT32& n,
+                                     const UINT32& setRank,
+                                     UINT32* pOrthVecInd)
+{
+    UINT32 vecsToGo = setRank;
+    UINT32 noOfBasis = 0;
+
+    double vecMag = 0;
+
+    double* pVec = nullptr;
+    double* pBasis = nullptr;
+    double* pNext = nullptr;
+
+    if (setRank > M || setRank > n)
+    {
+        fixedError(__PRETTY_FUNCTION__,"Rank exceeds the size of the set");
+    }
+
+    for (UINT32 i = 0; i < n && vecsToGo > 0; i++)
+    {
+        pVec = pVecs + i*M;
+        vecMag = fixedSqrt(fixedDot<M>(pVec,pVec));
+
+        if (vecMag < FLOAT_TOL)
+        {
+            continue;
+        }
+
+        /*
+        ** Normalize the vector into the next basis slot and remove its
+        ** component from every vector left
+        */
+        pBasis = pVecs + noOfBasis*M;
+        fixedScale<M>(1/vecMag,pVec,pBasis);
+
+        pOrthVecInd[noOfBasis] = i;
+        noOfBasis++;
+        vecsToGo--;
+
+        for (UINT32 j = i+1; j < n && vecsToGo > 0; j++)
+        {
+            pNext = pVecs + j*M;
+            fixedAxpy<M>(-fixedDot<M>(pBasis,pNext),pBasis,pNext);
+        }
+    }
+
+    return(noOfBasis);
+}
+
+/**
+********************************************************************************
+** @details Calculate the rank of an M x N matrix, and its determinant if it is
+**          square, with the Householder QR decomposition of Matrix::QRdecomp.
+**          The working copy and reflector vectors are fixed size arrays.
+** @param   pMat        Pointer to the row-major matrix elements
+** @param   detOnly     Stop at the first zero column, as only the determinant
+**                      is needed
+** @param   det         Reference for the determinant, if a square matrix
+** @param   matrixRank  Reference for the rank
+********************************************************************************
+*/
+template <UINT32 M, UINT32 N>
+constexpr void fixedQRdecomp(const double* pMat, const bool& detOnly,
+                             double& det, UINT32& matrixRank)
+{
+    UINT32 row = 0;
+    UINT32 matRank = 0;
+
+    double kVal = 0;
+    double colVal = 0;
+    double matDet = 1;
+    double vScale = 0;
+
+    double a[M*N] = {};
+    double v[M] = {};
+    double w[N] = {};
+
+    fixedScale<M*N>(1,pMat,a);
+
+    for (UINT32 col = 0; col < N && row < M; col++)
+    {
+        kVal = 0;
+        for (UINT32 i = row; i < M; i++)
+        {
+            kVal += a[i*N + col]*a[i*N + col];
+        }
+        kVal = fixedSqrt(kVal);
+
+        if (kVal < FLOAT_TOL)
+        {
+            matDet = 0;
+            if (detOnly)
+            {
+                break;
+            }
+            continue;
+        }
+        matRank++;
+
+        colVal = a[row*N + col];
+        if (row == M-1)
+        {
+            matDet *= colVal;
+            row++;
+            continue;
+        }
+
+        kVal = (colVal < 0) ? kVal : -kVal;
+        matDet *= -kVal;
+
+        v[row] = fixedSqrt((kVal - colVal)/(2*kVal));
+        vScale = -1/(2*kVal*v[row]);
+        for (UINT32 i = row+1; i < M; i++)
+        {
+            v[i] = vScale*a[i*N + col];
+        }
+
+        /*
+        ** Apply the reflector to the trailing columns as the rank-1 update
+        ** w = v'*A, A = A - 2*v*w'
+        */
+        FIXED_UNROLL
+        for (UINT32 j = 0; j < N; j++)
+        {
+            w[j] = 0;
+        }
+
+        for (UINT32 i = row; i < M; i++)
+        {
+            FIXED_UNROLL
+            for (UINT32 j = 0; j < N; j++)
+            {
+                w[j] += (j > col) ? v[i]*a[i*N + j] : 0;
+            }
+        }
+
+        for (UINT32 i = row; i < M; i++)
+        {
+            FIXED_UNROLL
+            for (UINT32 j = 0; j < N; j++)
+            {
+                a[i*N + j] -= 2*v[i]*w[j];
+            }
+        }
+
+        row++;
+    }
+
+    if (M == N)
+    {
+        det = matDet;
+    }
+    matrixRank = matRank;
+}
+
+/*------------------------------[FixedMatrix]---------------------------------*/
+/**
+********************************************************************************
+** @class   FixedMatrix
+** @brief   M x N matrix with inline storage
+** @details The fixed size counterpart of the Matrix class. The elements are
+**          stored by rows, so the rows of a FixedMatrix also form a set of M
+**          vectors of dimension N that can be orthonormalized in place.
+********************************************************************************
+*/
+template <UINT32 M, UINT32 N>
+class FixedMatrix
+{
+    static_assert(M > 0 && N > 0,
+                  "FixedMatrix dimensions must be greater than zero");
+
+    private:
+        double elems[M*N];  /* Matrix elements, stored by rows */
+
+    public:
+
+        /*
+        ** Default constructor, with every element set to zero
+        */
+        constexpr FixedMatrix() : elems{}
+        {
+        }
+
+        /*
+        ** Constructor (one parameter)
+        */
+        constexpr explicit FixedMatrix(const double* matArray) : elems{}
+        {
+            fixedScale<M*N>(1,matArray,elems);
+        }
+
+        /*
+        ** Calculate the rank of the matrix
+        */
+        constexpr UINT32 rank(void) const
+        {
+            UINT32 matRank = 0;
+            double det = 0;
+
+            fixedQRdecomp<M,N>(elems,false,det,matRank);
+
+            return(matRank);
+        }
+
+        /*
+        ** Calculate the determinant of a square matrix
+        */
+        constexpr double determinant(void) const
+        {
+            static_assert(M == N,"Determinant undefined for a non-square "
+                                 "matrix");
+
+            UINT32 matRank = 0;
+            double det = 0;
+
+            fixedQRdecomp<M,N>(elems,true,det,matRank);
+
+            return(det);
+        }
+
+        /*
+        ** Orthonormalize the rows in place with the Modified Gram-Schmidt
+        ** algorithm
+        */
+        constexpr UINT32 orthonormalize(const UINT32& setRank,
+                                        UINT32* pOrthVecInd)
+        {
+            return(fixedOrthonormalize<N>(elems,M,setRank,pOrthVecInd));
+        }
+
+        /*
+        ** Matrix transpose
+        */
+        constexpr FixedMatrix<N,M> transpose(void) const
+        {
+            FixedMatrix<N,M> trans;
+
+            for (UINT32 i = 0; i < M; i++)
+            {
+                FIXED_UNROLL
+                for (UINT32 j = 0; j < N; j++)
+                {
+                    trans[j][i] = elems[i*N + j];
+                }
+            }
+
+            return(trans);
+        }
+
+        /*
+        ** Operators
+        */
+        constexpr FixedMatrix& operator+=(const FixedMatrix& rhs)
+        {
+            fixedAxpy<M*N>(1,rhs.elems,elems);
+            return(*this);
+        }
+
+        constexpr FixedMatrix& operator-=(const FixedMatrix& rhs)
+        {
+            fixedAxpy<M*N>(-1,rhs.elems,elems);
+            return(*this);
+        }
+
+        constexpr FixedMatrix& operator*=(const double& rhs)
+        {
+            fixedScale<M*N>(rhs,elems,elems);
+            return(*this);
+        }
+
+        constexpr double* operator[](const UINT32& i)
+        {
+            return(elems + i*N);
+        }
+
+        constexpr const double* operator[](const UINT32& i) const
+        {
+            return(elems + i*N);
+        }
+
+        /*
+        ** Print object information
+        */
+        void objPrint(void) const
+        {
+            printf("Matrix size: %d x %d\n",M,N);
+
+            if (1 == M*N)
+            {
+                printf("Matrix element\n");
+            }
+            else
+            {
+                printf("Matrix elements\n");
+            }
+
+            for (UINT32 i = 0; i < M; i++)
+            {
+                for (UINT32 j = 0; j < N; j++)
+                {
+                    printf(" %12.3f",elems[i*N + j]);
+                }
+                printf("\n");
+            }
+        }
+
+        /*
+        ** Access methods
+        */
+
+        /*
+        ** Get the matrix elements
+        */
+        constexpr double* data(void)
+        {
+            return(elems);
+        }
+
+        constexpr const double* data(void) const
+        {
+            return(elems);
+        }
+
+        /*
+        ** Get the number of rows
+        */
+        static constexpr UINT32 getRows(void)
+        {
+            return(M);
+        }
+
+        /*
+        ** Get the number of columns
+        */
+        static constexpr UINT32 getCols(void)
+        {
+            return(N);
+        }
+};
+
+/**
+********************************************************************************
+** @details FixedMatrix A multiplied by a FixedMatrix B
+** @param   lhs M x N FixedMatrix A
+** @param   rhs N x P FixedMatrix B
+** @return  M x P product A*B
+********************************************************************************
+*/
+template <UINT32 M, UINT32 N, UINT32 P>
+constexpr FixedMatrix<M,P> operator*(const FixedMatrix<M,N>& lhs,
+                                     const FixedMatrix<N,P>& rhs)
+{
+    FixedMatrix<M,P> prod;
+
+    for (UINT32 i = 0; i < M; i++)
+    {
+        for (UINT32 k = 0; k < N; k++)
+        {
+            fixedAxpy<P>(lhs[i][k],rhs[k],prod[i]);
+        }
+    }
+
+    return(prod);
+}
+
+/**
+********************************************************************************
+** @details FixedMatrix A multiplied by a FixedVector x
+** @param   lhs M x N FixedMatrix A
+** @param   rhs N-dimensional FixedVector x
+** @return  M-dimensional product A*x
+********************************************************************************
+*/
+template <UINT32 M, UINT32 N>
+constexpr FixedVector<M> operator*(const FixedMatrix<M,N>& lhs,
+                                   const FixedVector<N>& rhs)
+{
+    FixedVector<M> prod;
+
+    for (UINT32 i = 0; i < M; i++)
+    {
+        prod[i] = fixedDot<N>(lhs[i],rhs.data());
+    }
+
+    return(prod);
+}
+
+/**
+********************************************************************************
+** @details Outer product of two FixedVectors
+** @param   lhs M-dimensional FixedVector
+** @param   rhs N-dimensional FixedVector
+** @return  M x N outer product
+********************************************************************************
+*/
+template <UINT32 M, UINT32 N>
+constexpr FixedMatrix<M,N> outer(const FixedVector<M>& lhs,
+                                 const FixedVector<N>& rhs)
+{
+    FixedMatrix<M,N> prod;
+
+    for (UINT32 i = 0; i < M; i++)
+    {
+        fixedScale<N>(lhs[i],rhs.data(),prod[i]);
+    }
+
+    return(prod);
+}
+
+#endif
@@ -0,0 +1,466 @@
+/**
+********************************************************************************
+** @file    FixedVector.hh
+**
+** @brief   Fixed dimension vectors with inline storage
+**
+** @details The FixedVector class template holds the elements of an
+**          N-dimensional vector in the object itself, so it is never allocated
+**          on the heap. The dimension is a compile time constant, which lets
+**          every loop be fully unrolled and every method be evaluated in a
+**          constant expression. The element kernels on raw arrays are shared
+**          with the FixedMatrix class template.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  FixedVector.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _FIXED_VECTOR_HH_
+#define _FIXED_VECTOR_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+
+#include "StdTypes.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @def   FIXED_UNROLL
+** @brief Fully unroll the following fixed length loop
+********************************************************************************
+*/
+#define FIXED_UNROLL _Pragma("GCC unroll 16")
+
+/**
+********************************************************************************
+** @def   FIXED_CONSTANT_EVALUATED
+** @brief Defined when the compiler can tell a constant evaluation from a
+**        run-time one, so fixedSqrt() can call sqrt() at run time
+********************************************************************************
+*/
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define FIXED_CONSTANT_EVALUATED
+#endif
+#elif (defined(__GNUC__) && __GNUC__ >= 9) || \
+      (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define FIXED_CONSTANT_EVALUATED
+#endif
+
+/**
+********************************************************************************
+** @details Report an error from a fixed dimension routine and exit. This is
+**          only reached by invalid arguments, so it is never part of a
+**          constant expression.
+** @param   funcName    Name of the reporting function
+** @param   msg         Error message
+********************************************************************************
+*/
+inline void fixedError(const char* funcName, const char* msg)
+{
+    printf("Error - %s\n"
+           "        %s\n",
+           funcName,msg);
+    exit(EXIT_FAILURE);
+}
+
+/*-----------------------------[Element Kernels]------------------------------*/
+/**
+********************************************************************************
+** @details Square root that can be part of a constant expression. Only GCC
+**          evaluates sqrt() in a constant expression, so a constant
+**          evaluation uses Newton's method instead. The argument is scaled
+**          by powers of four into [0.25,4], where the iteration converges in
+**          a few steps, and it stops once the estimate, which decreases from
+**          the first step on, stops decreasing. Run-time calls
+**          use sqrt() when FIXED_CONSTANT_EVALUATED is defined, and Newton's
+**          method otherwise, which is within one unit in the last place.
+** @param   x   Argument
+** @return  Square root of x, or NaN if x is negative
+********************************************************************************
+*/
+constexpr double fixedSqrt(const double& x)
+{
+    double y = x;
+    double scale = 1;
+    double root = 0;
+    double prev = 0;
+
+#ifdef FIXED_CONSTANT_EVALUATED
+    if (!__builtin_is_constant_evaluated())
+    {
+        return(sqrt(x));
+    }
+#endif
+
+    if (x < 0)
+    {
+        return(std::numeric_limits<double>::quiet_NaN());
+    }
+    if (!(x > 0 && x <= std::numeric_limits<double>::max()))
+    {
+        return(x);
+    }
+
+    while (y > 4)
+    {
+        y /= 4;
+        scale *= 2;
+    }
+    while (y < 0.25)
+    {
+        y *= 4;
+        scale /= 2;
+    }
+
+    root = (1 + y)/2;
+    do
+    {
+        prev = root;
+        root = (root + y/root)/2;
+    } while (root < prev);
+
+    return(prev*scale);
+}
+
+/**
+********************************************************************************
+** @details Inner (dot) product of two N element arrays
+** @param   pX  Pointer to the first array
+** @param   pY  Pointer to the second array
+** @return  Dot product
+********************************************************************************
+*/
+template <UINT32 N>
+constexpr double fixedDot(const double* pX, const double* pY)
+{
+    double sum = 0;
+
+    FIXED_UNROLL
+    for (UINT32 i = 0; i < N; i++)
+    {
+        sum += pX[i]*pY[i];
+    }
+
+    return(sum);
+}
+
+/**
+********************************************************************************
+** @details AXPY update y = y + a*x of two N element arrays
+** @param   a   Scalar multiplier of x
+** @param   pX  Pointer to the x array
+** @param   pY  Pointer to the y array, updated in place
+********************************************************************************
+*/
+template <UINT32 N>
+constexpr void fixedAxpy(const double& a, const double* pX, double* pY)
+{
+    FIXED_UNROLL
+    for (UINT32 i = 0; i < N; i++)
+    {
+        pY[i] += a*pX[i];
+    }
+}
+
+/**
+********************************************************************************
+** @details Scaled copy y = a*x of an N element array. The arrays may be the
+**          same array.
+** @param   a   Scalar multiplier of x
+** @param   pX  Pointer to the x array
+** @param   pY  Pointer to the y array
+********************************************************************************
+*/
+template <UINT32 N>
+constexpr void fixedScale(const double& a, const double* pX, double* pY)
+{
+    FIXED_UNROLL
+    for (UINT32 i = 0; i < N; i++)
+    {
+        pY[i] = a*pX[i];
+    }
+}
+
+/*------------------------------[FixedVector]---------------------------------*/
+/**
+********************************************************************************
+** @class   FixedVector
+** @brief   N-dimensional vector with inline storage
+** @details The fixed dimension counterpart of the Vector class. The element
+**          access operator has no bounds check, since the dimension is known
+**          wherever the object is used.
+********************************************************************************
+*/
+template <UINT32 N>
+class FixedVector
+{
+    static_assert(N > 0,"FixedVector dimension must be greater than zero");
+
+    private:
+        double elems[N];    /* Vector elements */
+
+    public:
+
+        /*
+        ** Default constructor, with every element set to zero
+        */
+        constexpr FixedVector() : elems{}
+        {
+        }
+
+        /*
+        ** Constructor (one parameter)
+        */
+        constexpr explicit FixedVector(const double* vals) : elems{}
+        {
+            fixedScale<N>(1,vals,elems);
+        }
+
+        /*
+        ** Vector magnitude (norm)
+        */
+        constexpr double mag(void) const
+        {
+            return(fixedSqrt(fixedDot<N>(elems,elems)));
+        }
+
+        /*
+        ** Unit vector
+        */
+        constexpr FixedVector unit(void) const
+        {
+            FixedVector unitVec(*this);
+
+            unitVec.normalize();
+
+            return(unitVec);
+        }
+
+        /*
+        ** Scale the vector to unit magnitude in place, returning the original
+        ** magnitude
+        */
+        constexpr double normalize(void)
+        {
+            double vecMag = mag();
+
+            if (0 == vecMag)
+            {
+                fixedError(__PRETTY_FUNCTION__,
+                           "Cannot normalize a zero magnitude vector");
+            }
+            fixedScale<N>(1/vecMag,elems,elems);
+
+            return(vecMag);
+        }
+
+        /*
+        ** Remove the component of a unit vector in place, returning the
+        ** magnitude of the result
+        */
+        constexpr double projectOut(const FixedVector& unitVec)
+        {
+            fixedAxpy<N>(-fixedDot<N>(unitVec.elems,elems),unitVec.elems,
+                         elems);
+
+            return(mag());
+        }
+
+        /*
+        ** Operators
+        */
+        constexpr FixedVector& operator+=(const FixedVector& rhs)
+        {
+            fixedAxpy<N>(1,rhs.elems,elems);
+            return(*this);
+        }
+
+        constexpr FixedVector& operator-=(const FixedVector& rhs)
+        {
+            fixedAxpy<N>(-1,rhs.elems,elems);
+            return(*this);
+        }
+
+        constexpr FixedVector& operator*=(const double& rhs)
+        {
+            fixedScale<N>(rhs,elems,elems);
+            return(*this);
+        }
+
+        constexpr FixedVector& operator/=(const double& rhs)
+        {
+            fixedScale<N>(1/rhs,elems,elems);
+            return(*this);
+        }
+
+        constexpr double operator*(const FixedVector& rhs) const
+        {
+            return(fixedDot<N>(elems,rhs.elems));
+        }
+
+        constexpr double& operator[](const UINT32& i)
+        {
+            return(elems[i]);
+        }
+
+        constexpr const double& operator[](const UINT32& i) const
+        {
+            return(elems[i]);
+        }
+
+        /*
+        ** Print object information
+        */
+        void objPrint(void) const
+        {
+            printf("Vector dimension: %d\n",N);
+
+            if (1 == N)
+            {
+                printf("Vector element\n");
+            }
+            else
+            {
+                printf("Vector elements\n");
+            }
+
+            for (UINT32 i = 0; i < N; i++)
+            {
+                printf(" %12.3f\n",elems[i]);
+            }
+        }
+
+        /*
+        ** Access methods
+        */
+
+        /*
+        ** Get the vector elements
+        */
+        constexpr double* data(void)
+        {
+            return(elems);
+        }
+
+        constexpr const double* data(void) const
+        {
+            return(elems);
+        }
+
+        /*
+        ** Get the vector dimension
+        */
+        static constexpr UINT32 getSize(void)
+        {
+            return(N);
+        }
+};
+
+/**
+********************************************************************************
+** @details FixedVector addition
+** @param   lhs FixedVector object
+** @param   rhs FixedVector object
+** @return  Sum of the vectors
+********************************************************************************
+*/
+template <UINT32 N>
+constexpr FixedVector<N> operator+(const FixedVector<N>& lhs,
+                                   const FixedVector<N>& rhs)
+{
+    FixedVector<N> sum(lhs);
+
+    sum += rhs;
+
+    return(sum);
+}
+
+/**
+********************************************************************************
+** @details FixedVector subtraction
+** @param   lhs FixedVector object
+** @param   rhs FixedVector object
+** @return  Difference of the vectors
+********************************************************************************
+*/
+template <UINT32 N>
+constexpr FixedVector<N> operator-(const FixedVector<N>& lhs,
+                                   const FixedVector<N>& rhs)
+{
+    FixedVector<N> diff(lhs);
+
+    diff -= rhs;
+
+    return(diff);
+}
+
+/**
+********************************************************************************
+** @details Double multiplied by a FixedVector
+** @param   lhs double data type
+** @param   rhs FixedVector object
+** @return  Vector with every element multiplied by lhs
+********************************************************************************
+*/
+template <UINT32 N>
+constexpr FixedVector<N> operator*(const double& lhs, const FixedVector<N>& rhs)
+{
+    FixedVector<N> prod(rhs);
+
+    prod *= lhs;
+
+    return(prod);
+}
+
+/**
+********************************************************************************
+** @details FixedVector divided by a double
+** @param   lhs FixedVector object
+** @param   rhs double data type
+** @return  Vector with every element divided by rhs
+********************************************************************************
+*/
+template <UINT32 N>
+constexpr FixedVector<N> operator/(const FixedVector<N>& lhs, const double& rhs)
+{
+    FixedVector<N> quot(lhs);
+
+    quot /= rhs;
+
+    return(quot);
+}
+
+#endif
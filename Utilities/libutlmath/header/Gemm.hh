@@ -0,0 +1,77 @@
+/**
+********************************************************************************
+** @file    Gemm.hh
+**
+** @brief   Declaration of the general matrix multiply routine
+**
+** @details The matrix multiply C = alpha*op(A)*op(B) + beta*C is calculated
+**          with packed, cache-blocked panels and a register-tiled micro-kernel
+**          selected for the CPU, in parallel on the shared thread pool.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Gemm.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _GEMM_HH_
+#define _GEMM_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include "StdTypes.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @enum    GemmTrans
+** @brief   Operation applied to a GEMM input matrix
+********************************************************************************
+*/
+enum GemmTrans {GEMM_NO_TRANS,      /**< op(X) = X */
+                GEMM_TRANS};        /**< op(X) = X' */
+
+/*
+** Matrix storage
+**
+** Every matrix is stored by rows. Element (i,j) of a matrix X with leading
+** dimension ldx is found at pX[i*ldx + j]. A set of vectors stored one after
+** another is the transpose of the matrix with the vectors as its columns.
+*/
+
+/*
+** Calculate C = alpha*op(A)*op(B) + beta*C, where op(A) is m x k, op(B) is
+** k x n, and C is m x n
+*/
+void gemm(const GemmTrans& transA, const GemmTrans& transB, const UINT32& m,
+          const UINT32& n, const UINT32& k, const double& alpha,
+          const double* pA, const UINT32& lda, const double* pB,
+          const UINT32& ldb, const double& beta, double* pC,
+          const UINT32& ldc);
+
+#endif
@@ -0,0 +1,89 @@
+/**
+********************************************************************************
+** @file    Grammian.hh
+**
+** @brief   Declaration of the Grammian matrix routines
+**
+** @details Functions that calculate the Grammian matrix of a set of vectors
+**          stored in one contiguous block of memory are declared here. The
+**          Grammian is symmetric, so only its upper triangle is calculated and
+**          it can be returned as a full matrix or in packed storage.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Grammian.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _GRAMMIAN_HH_
+#define _GRAMMIAN_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstddef>
+
+#include "StdTypes.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/*
+** Packed symmetric storage
+**
+** The upper triangle of an n x n symmetric matrix is stored row by row in
+** n*(n+1)/2 elements. Row i holds the elements (i,i) through (i,n-1).
+*/
+
+/**
+********************************************************************************
+** @details Index of an element of an n x n symmetric matrix in packed storage
+** @param   i   Row index
+** @param   j   Column index
+** @param   n   Number of rows and columns
+** @return  Index of element (i,j) in the packed array
+********************************************************************************
+*/
+inline size_t packedIndex(const UINT32& i, const UINT32& j, const UINT32& n)
+{
+    size_t row = (i < j) ? i : j;
+    size_t col = (i < j) ? j : i;
+
+    return(row*n - row*(row-1)/2 + (col-row));
+}
+
+/*
+** Calculate the full n x n row-major Grammian matrix of a vector set
+*/
+void grammian(const double* pVecs, const UINT32& lda, const UINT32& m,
+              const UINT32& n, double* pGram);
+
+/*
+** Calculate the Grammian matrix of a vector set in packed symmetric storage
+*/
+void grammianPacked(const double* pVecs, const UINT32& lda, const UINT32& m,
+                    const UINT32& n, double* pPacked);
+
+#endif
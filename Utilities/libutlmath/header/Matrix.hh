@@ -43,22 +43,50 @@
 
 /*------------------------------[Include Files]-------------------------------*/
 #include "StdTypes.hh"
+#include "Arena.hh"
+#include "Expression.hh"
+#include "View.hh"
+#include "Workspace.hh"
 
 
 /*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @enum    AdoptBuffer
+** @brief   Tag to select the Vector and Matrix constructors that take
+**          ownership of a heap buffer
+** @details A buffer allocated with new[] and handed to one of these
+**          constructors belongs to the object from then on, and is used in
+**          place without a copy.
+********************************************************************************
+*/
+enum AdoptBuffer {ADOPT_BUFFER};
+
+/**
+********************************************************************************
+** @enum    MatrixLayout
+** @brief   Order of the Matrix elements in memory
+********************************************************************************
+*/
+enum MatrixLayout {MATRIX_ROW_MAJOR,    /**< Rows are contiguous */
+                   MATRIX_COL_MAJOR};   /**< Columns are contiguous */
+
 /**
 ********************************************************************************
 ** @class   MatrixRow
 ** @brief   Storage class for Matrix rows
 ** @details To effectively access the Matrix elements, a storage class is needed
 **          to store a row of a Matrix object. This allows direct access to the
-**          columns within a particular row.
+**          columns within a particular row. The elements of a row are a
+**          stride apart, which is the leading dimension of a column-major
+**          matrix.
 ********************************************************************************
 */
 class MatrixRow
 {
     private:
         UINT32 ncols;   /* Number of elements in the matrix row */
+        UINT32 stride;  /* Distance between elements in the matrix row */
 
         double* pRow;   /* Pointer to the elements in a matrix row */
 
@@ -70,9 +98,9 @@ class MatrixRow
         MatrixRow();
 
         /*
-        ** Constructor (two parameters)
+        ** Constructor (three parameters)
         */
-        MatrixRow(double* rowData, const UINT32& n);
+        MatrixRow(double* rowData, const UINT32& n, const UINT32& inc = 1);
 
         /**
         ** @brief Default destructor
@@ -95,22 +123,64 @@ class MatrixRow
 ** @class   Matrix
 ** @brief   Incorporate m x n matrix math
 ** @details A class to implement general m x n matrices and perform various math
-**          operations with other Matrix or Vector objects.
+**          operations with other Matrix or Vector objects. The element-wise
+**          operators build expression templates, which are evaluated in a
+**          single loop when assigned to a Matrix object. The elements draw
+**          from the current Arena when an ArenaScope is alive on the thread.
+**
+**          The elements are stored by rows or by columns, as chosen by the
+**          layout given to the constructor. The storage is aligned to
+**          MATRIX_ALIGN, and each row (or column) is padded to a leading
+**          dimension that keeps the next one aligned, so vector loads never
+**          split a cache line. The padding elements are zero. An adopted
+**          buffer is the exception: its rows are stored as given, with a
+**          leading dimension of the number of columns, so every routine
+**          works from the leading dimension and uses unaligned loads.
 ********************************************************************************
 */
-class Matrix
+class Matrix : public MatrixExpr<Matrix>
 {
     private:
-        UINT32 mrows;       /* Number of rows */
-        UINT32 ncols;       /* Number of columns */
+        UINT32 mrows;           /* Number of rows */
+        UINT32 ncols;           /* Number of columns */
+        UINT32 ld;              /* Leading dimension of the storage */
+
+        MatrixLayout layout;    /* Order of the elements */
+
+        double* pRaw;           /* Heap allocation, or NULL if in an arena */
+        double* pMatrix;        /* Pointer to the aligned matrix elements */
+
+        /*
+        ** Allocate aligned, padded storage for the matrix, in the current
+        ** arena if there is one and useArena is true, and on the heap
+        ** otherwise
+        */
+        void allocate(const bool& useArena = true);
 
-        double* pMatrix;    /* Pointer to the matrix elements */
+        /*
+        ** Free the element storage if it is on the heap
+        */
+        void release(void)
+        {
+            delete[] pRaw;
+        }
+
+        /*
+        ** Get the number of elements in the storage, including padding
+        */
+        size_t getStorageSize(void) const
+        {
+            return((size_t)ld*((MATRIX_ROW_MAJOR == layout) ? mrows : ncols));
+        }
 
         /*
-        ** Enumerations for use when performing matrix decompositions
+        ** Access an element (no bounds check)
         */
-        enum {MATRIX_DECOMP_RANK,
-              MATRIX_DECOMP_DET};
+        double& at(const UINT32& i, const UINT32& j) const
+        {
+            return((MATRIX_ROW_MAJOR == layout) ? pMatrix[(size_t)i*ld + j] :
+                                                  pMatrix[(size_t)j*ld + i]);
+        }
 
     public:
 
@@ -120,14 +190,28 @@ class Matrix
         Matrix();
 
         /*
-        ** Constructor (two parameters)
+        ** Constructor (three parameters)
         */
-        Matrix(const UINT32& m, const UINT32& n);
+        Matrix(const UINT32& m, const UINT32& n,
+               const MatrixLayout& order = MATRIX_ROW_MAJOR);
 
         /*
-        ** Constructor (three parameters)
+        ** Constructor (four parameters)
         */
-        Matrix(const double* matArray, const UINT32& m, const UINT32& n);
+        Matrix(const double* matArray, const UINT32& m, const UINT32& n,
+               const MatrixLayout& order = MATRIX_ROW_MAJOR);
+
+        /*
+        ** Constructor taking ownership of a heap buffer
+        */
+        Matrix(double* matArray, const UINT32& m, const UINT32& n,
+               AdoptBuffer);
+
+        /*
+        ** Constructor evaluating a Matrix expression
+        */
+        template <typename E>
+        Matrix(const MatrixExpr<E>& rhs);
 
         /*
         ** Default copy constructor
@@ -139,6 +223,12 @@ class Matrix
         */
         Matrix& operator=(const Matrix& rhs);
 
+        /*
+        ** Matrix expression assignment
+        */
+        template <typename E>
+        Matrix& operator=(const MatrixExpr<E>& rhs);
+
         /*
         ** Default move constructor
         */
@@ -149,10 +239,10 @@ class Matrix
         */
         Matrix& operator=(Matrix&& rhs);
 
-        /**
-        ** @brief Default destructor
+        /*
+        ** Destructor
         */
-        ~Matrix() = default;
+        ~Matrix();
 
         /*
         ** Check the matrix dimensions to ensure the number of rows and columns
@@ -188,11 +278,23 @@ class Matrix
         */
         UINT32 rank(void);
 
+        /*
+        ** Calculate the rank of the matrix with scratch memory from a
+        ** workspace
+        */
+        UINT32 rank(QRWorkspace& work);
+
         /*
         ** Calculate the determinant of a square matrix
         */
         double determinant(void);
 
+        /*
+        ** Calculate the determinant of a square matrix with scratch memory
+        ** from a workspace
+        */
+        double determinant(QRWorkspace& work);
+
         /*
         ** Calculate the QR decomposition of the matrix
         */
@@ -203,12 +305,16 @@ class Matrix
         */
         Matrix& operator-=(const Matrix& rhs);
         Matrix& operator*=(const double& rhs);
-        const Matrix operator-(const Matrix& rhs) const;
         const Matrix operator*(const Matrix& rhs);
         MatrixRow operator[](const UINT32& rowInd);
 
-        friend Matrix operator*(const double& lhs, const Matrix& rhs);
-        friend Matrix operator*(const Matrix& lhs, const double& rhs);
+        /*
+        ** Evaluate an element as a Matrix expression (no bounds check)
+        */
+        double eval(const UINT32& i, const UINT32& j) const
+        {
+            return(at(i,j));
+        }
 
         /*
         ** Print object information
@@ -219,6 +325,11 @@ class Matrix
         ** Access methods
         */
 
+        /*
+        ** Return a view of the matrix elements
+        */
+        MatrixView view(void) const;
+
         /*
         ** Return a sub matrix from the current matrix object
         */
@@ -235,6 +346,87 @@ class Matrix
         */
         UINT32 getCols(void) const;
 
+        /*
+        ** Return the order of the elements in memory
+        */
+        MatrixLayout getLayout(void) const;
+
+        /*
+        ** Return the padded leading dimension of the storage
+        */
+        UINT32 getLeadDim(void) const;
 };
 
+/*--------------------------[Matrix Template Methods]-------------------------*/
+/**
+********************************************************************************
+** @details Matrix class constructor evaluating a Matrix expression into a
+**          row-major matrix
+** @param   rhs Matrix expression
+********************************************************************************
+*/
+template <typename E>
+Matrix::Matrix(const MatrixExpr<E>& rhs)
+{
+    const E& matExpr = rhs.expr();
+
+    mrows = matExpr.getRows();
+    ncols = matExpr.getCols();
+    layout = MATRIX_ROW_MAJOR;
+
+    checkSize(mrows,ncols);
+    allocate();
+
+    for (UINT32 i = 0; i < mrows; i++)
+    {
+        for (UINT32 j = 0; j < ncols; j++)
+        {
+            pMatrix[(size_t)i*ld + j] = matExpr.eval(i,j);
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Matrix expression assignment operator. Each element of the
+**          expression only depends on the same element of its operands, so
+**          the calling object may also appear in the expression.
+** @param   rhs Matrix expression
+** @return  Calling object with the expression values
+********************************************************************************
+*/
+template <typename E>
+Matrix& Matrix::operator=(const MatrixExpr<E>& rhs)
+{
+    const E& matExpr = rhs.expr();
+
+    checkEqualSize(mrows,ncols,matExpr.getRows(),matExpr.getCols());
+
+    /*
+    ** Write the elements in storage order
+    */
+    if (MATRIX_ROW_MAJOR == layout)
+    {
+        for (UINT32 i = 0; i < mrows; i++)
+        {
+            for (UINT32 j = 0; j < ncols; j++)
+            {
+                pMatrix[(size_t)i*ld + j] = matExpr.eval(i,j);
+            }
+        }
+    }
+    else
+    {
+        for (UINT32 j = 0; j < ncols; j++)
+        {
+            for (UINT32 i = 0; i < mrows; i++)
+            {
+                pMatrix[(size_t)j*ld + i] = matExpr.eval(i,j);
+            }
+        }
+    }
+
+    return(*this);
+}
+
 #endif
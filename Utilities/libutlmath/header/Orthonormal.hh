@@ -0,0 +1,122 @@
+/**
+********************************************************************************
+** @file    Orthonormal.hh
+**
+** @brief   Declaration of the orthonormalization routines
+**
+** @details Functions that generate an orthonormal set of basis vectors from a
+**          set of vectors stored in one contiguous block of memory are
+**          declared here.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Orthonormal.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _ORTHONORMAL_HH_
+#define _ORTHONORMAL_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include "StdTypes.hh"
+#include "View.hh"
+#include "Workspace.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @def   ORTH_BLOCK_SIZE
+** @brief Default number of vectors in each panel of the block Gram-Schmidt
+**        algorithm
+********************************************************************************
+*/
+#define ORTH_BLOCK_SIZE 32
+
+/*
+** Vector set storage
+**
+** A set of n vectors of dimension m is stored in one caller-owned block of
+** memory. The elements of vector j are contiguous and start at pVecs + j*lda,
+** where the leading dimension lda is at least m.
+*/
+
+/*
+** Orthonormalize a vector set in place with the Modified Gram-Schmidt
+** algorithm
+*/
+UINT32 orthonormalize(double* pVecs, const UINT32& lda, const UINT32& m,
+                      const UINT32& n, const UINT32& setRank,
+                      UINT32* pOrthVecInd);
+
+/*
+** Orthonormalize a vector set in place with the Modified Gram-Schmidt
+** algorithm, taking scratch memory from a workspace
+*/
+UINT32 orthonormalize(double* pVecs, const UINT32& lda, const UINT32& m,
+                      const UINT32& n, const UINT32& setRank,
+                      UINT32* pOrthVecInd, GramSchmidtWorkspace& work);
+
+/*
+** Orthonormalize the columns of a matrix view in place with the Modified
+** Gram-Schmidt algorithm
+*/
+UINT32 orthonormalize(const MatrixView& vecs, const UINT32& setRank,
+                      UINT32* pOrthVecInd);
+
+/*
+** Orthonormalize a vector set in place with the block Gram-Schmidt algorithm
+*/
+UINT32 orthonormalizeBlocked(double* pVecs, const UINT32& lda, const UINT32& m,
+                             const UINT32& n, const UINT32& setRank,
+                             const UINT32& blockSize, UINT32* pOrthVecInd);
+
+/*
+** Orthonormalize a vector set in place with the CholeskyQR2 algorithm, given
+** the Grammian of the set
+*/
+UINT32 orthonormalizeCholQR2(double* pVecs, const UINT32& lda, const UINT32& m,
+                             const UINT32& n, const double* pGram,
+                             const UINT32& setRank, UINT32* pOrthVecInd);
+
+/*
+** Orthonormalize a vector set in place with the column pivoted Modified
+** Gram-Schmidt algorithm, returning the rank of the set
+*/
+UINT32 orthonormalizePivoted(double* pVecs, const UINT32& lda, const UINT32& m,
+                             const UINT32& n, UINT32* pPerm);
+
+/*
+** Orthonormalize a vector set in place with the column pivoted Modified
+** Gram-Schmidt algorithm, taking scratch memory from a workspace
+*/
+UINT32 orthonormalizePivoted(double* pVecs, const UINT32& lda, const UINT32& m,
+                             const UINT32& n, UINT32* pPerm,
+                             GramSchmidtWorkspace& work);
+
+#endif
@@ -0,0 +1,278 @@
+/**
+********************************************************************************
+** @file    ThreadPool.hh
+**
+** @brief   Declaration of the shared work-stealing thread pool
+**
+** @details One pool of worker threads is shared by every parallel routine in
+**          the library, so the routines do not each start their own threads.
+**          Work is submitted as ranges of loop indices with parallelFor() and
+**          parallelReduce(). Each worker has its own task queue and steals
+**          from the other queues when it runs out of work.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  ThreadPool.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _THREAD_POOL_HH_
+#define _THREAD_POOL_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "StdTypes.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @struct  PoolLoop
+** @brief   Completion state of one parallel loop
+** @details The thread finishing the last piece sets finished and signals
+**          done while holding the lock, so the submitting thread, which waits
+**          under the same lock, cannot release the state before the signal
+**          is sent.
+********************************************************************************
+*/
+struct PoolLoop
+{
+    std::atomic<UINT32> pending;        /* Pieces not yet finished */
+    bool finished;                      /* Every piece has finished */
+    std::mutex lock;                    /* Protects finished */
+    std::condition_variable done;       /* Signals finished */
+};
+
+/**
+********************************************************************************
+** @struct  PoolTask
+** @brief   Range of loop indices run by one call of a parallel loop body
+********************************************************************************
+*/
+struct PoolTask
+{
+    const std::function<void(UINT32,UINT32)>* pBody;    /* Loop body */
+    UINT32 begin;                                       /* First index */
+    UINT32 end;                                         /* Last index + 1 */
+    PoolLoop* pLoop;                                    /* Loop of the task */
+};
+
+/**
+********************************************************************************
+** @class   ThreadPool
+** @brief   Work-stealing pool of worker threads shared by the library
+** @details The pool is created on first use with one thread for every hardware
+**          thread, counting the thread that submits the work, which runs tasks
+**          until none are left to take and then sleeps until its loop is
+**          finished. A parallel loop split into ranges is spread over
+**          the worker queues. Each worker runs the newest task in its own
+**          queue and, when it is empty, steals the oldest task from another
+**          queue. Parallel loops may be nested; a loop submitted from a worker
+**          is pushed to its own queue and the other workers steal from it.
+**
+**          The thread count and pinning are set between parallel loops, never
+**          while one is running.
+********************************************************************************
+*/
+class ThreadPool
+{
+    private:
+
+        /*
+        ** Task queue of one worker
+        */
+        struct WorkQueue
+        {
+            std::mutex lock;    /* Queue access lock */
+            PoolTask* pTasks;   /* Circular array of tasks */
+            UINT32 head;        /* Index of the oldest task */
+            UINT32 count;       /* Number of tasks */
+            UINT32 capacity;    /* Size of the task array */
+        };
+
+        UINT32 noOfWorkers;             /* Number of worker threads */
+        bool pinThreads;                /* Pin the workers to cores */
+
+        std::thread* pWorkers;          /* Worker threads */
+        WorkQueue* pQueues;             /* One queue per worker */
+
+        std::atomic<UINT32> queuedTasks;    /* Tasks in all queues */
+        std::atomic<UINT32> nextQueue;      /* Queue for the next task */
+        std::atomic<bool> stopWorkers;      /* Workers must exit */
+
+        std::mutex sleepLock;               /* Idle worker lock */
+        std::condition_variable sleepCond;  /* Idle worker wake up */
+
+        /*
+        ** Constructor (disabled outside of instance())
+        */
+        ThreadPool();
+
+        /*
+        ** Copy constructor and assignment (disabled)
+        */
+        ThreadPool(const ThreadPool& pool);
+        ThreadPool& operator=(const ThreadPool& rhs);
+
+        /*
+        ** Start and stop the worker threads
+        */
+        void startWorkers(const UINT32& n);
+        void stopAllWorkers(void);
+
+        /*
+        ** Worker thread loop
+        */
+        void workerLoop(const UINT32& index);
+
+        /*
+        ** Pin a worker thread to a core
+        */
+        void pinWorker(const UINT32& index);
+
+        /*
+        ** Queue operations
+        */
+        void pushTask(const UINT32& queue, const PoolTask& task);
+        bool popTask(const UINT32& queue, PoolTask& task);
+        bool stealTask(const UINT32& thief, PoolTask& task);
+
+        /*
+        ** Run a task and mark it as finished
+        */
+        static void runTask(const PoolTask& task);
+
+    public:
+
+        /*
+        ** Return the shared thread pool
+        */
+        static ThreadPool& instance(void);
+
+        /*
+        ** Destructor
+        */
+        ~ThreadPool();
+
+        /*
+        ** Set the number of threads running parallel loops, including the
+        ** calling thread, or one per hardware thread if n is zero
+        */
+        void setThreadCount(const UINT32& n);
+
+        /*
+        ** Get the number of threads running parallel loops
+        */
+        UINT32 getThreadCount(void) const;
+
+        /*
+        ** Pin each worker thread to its own core, or release the workers
+        */
+        void setPinning(const bool& pin);
+
+        /*
+        ** Run body(first,last) over [begin,end) in ranges of grain indices
+        */
+        void parallelFor(const UINT32& begin, const UINT32& end,
+                         const UINT32& grain,
+                         const std::function<void(UINT32,UINT32)>& body);
+
+        /*
+        ** Reduce map(first,last) over [begin,end) in ranges of grain indices
+        */
+        template <typename T, typename Map, typename Combine>
+        T parallelReduce(const UINT32& begin, const UINT32& end,
+                         const UINT32& grain, const T& identity,
+                         const Map& map, const Combine& combine);
+};
+
+/*-----------------------[ThreadPool Template Methods]------------------------*/
+/**
+********************************************************************************
+** @details Reduce a range of loop indices in parallel. The range is split
+**          into pieces of grain indices, map(first,last) returns the partial
+**          result of each piece, and the partial results are combined in index
+**          order, so the result does not depend on the thread count or the
+**          order the pieces finish.
+** @param   begin       First loop index
+** @param   end         One past the last loop index
+** @param   grain       Number of indices in each piece
+** @param   identity    Identity element of combine
+** @param   map         Function returning the partial result of a piece
+** @param   combine     Function returning the combination of two results
+** @return  Combination of every partial result
+********************************************************************************
+*/
+template <typename T, typename Map, typename Combine>
+T ThreadPool::parallelReduce(const UINT32& begin, const UINT32& end,
+                             const UINT32& grain, const T& identity,
+                             const Map& map, const Combine& combine)
+{
+    UINT32 step;
+    UINT32 noOfPieces;
+
+    T result = identity;
+    T* pPartial;
+
+    if (end <= begin)
+    {
+        return(result);
+    }
+
+    step = (grain > 0) ? grain : 1;
+    noOfPieces = (end - begin - 1)/step + 1;
+    pPartial = new T [noOfPieces];
+
+    parallelFor(0,noOfPieces,1,
+                [&](UINT32 first, UINT32 last)
+                {
+                    for (UINT32 p = first; p < last; p++)
+                    {
+                        UINT32 lo = begin + p*step;
+                        UINT32 hi = (end - lo > step) ? lo + step : end;
+
+                        pPartial[p] = map(lo,hi);
+                    }
+                });
+
+    for (UINT32 p = 0; p < noOfPieces; p++)
+    {
+        result = combine(result,pPartial[p]);
+    }
+
+    delete[] pPartial;
+
+    return(result);
+}
+
+#endif
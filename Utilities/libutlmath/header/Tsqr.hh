@@ -0,0 +1,68 @@
+/**
+********************************************************************************
+** @file    Tsqr.hh
+**
+** @brief   Declaration of the tall-skinny QR orthonormalization routine
+**
+** @details The tall-skinny QR (TSQR) algorithm orthonormalizes a set of a few
+**          vectors with a very large dimension. The rows of the set are split
+**          into chunks that are factored in parallel, and the small
+**          triangular factors are combined in a reduction tree.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Tsqr.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _TSQR_HH_
+#define _TSQR_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include "StdTypes.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @def   TSQR_MAX_CHUNKS
+** @brief Maximum number of row chunks used by the TSQR routine
+********************************************************************************
+*/
+#define TSQR_MAX_CHUNKS 256
+
+/*
+** Orthonormalize a vector set in place with the tall-skinny QR algorithm,
+** split into nChunks row chunks, or one per thread pool thread if nChunks is
+** zero
+*/
+UINT32 orthonormalizeTSQR(double* pVecs, const UINT32& lda, const UINT32& m,
+                          const UINT32& n, const UINT32& nChunks,
+                          UINT32* pOrthVecInd);
+
+#endif
@@ -0,0 +1,171 @@
+/**
+********************************************************************************
+** @file    VecKernels.hh
+**
+** @brief   Declaration of the vectorized vector kernels
+**
+** @details The dot product, AXPY, scaling, and norm kernels used by the Vector
+**          and Matrix classes and the orthonormalization routines are declared
+**          here, along with fused kernels that save passes over memory. Each
+**          kernel has SSE2, AVX2, and AVX-512 variants, and the best variant
+**          supported by the CPU is selected once at program start up.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  VecKernels.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _VEC_KERNELS_HH_
+#define _VEC_KERNELS_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cmath>
+
+#include "StdTypes.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @enum    VecKernelIsa
+** @brief   Instruction sets with a variant of every vector kernel
+********************************************************************************
+*/
+enum VecKernelIsa {VEC_ISA_GENERIC,     /**< Portable C++ loops */
+                   VEC_ISA_SSE2,        /**< 128-bit SSE2 */
+                   VEC_ISA_AVX2,        /**< 256-bit AVX2 with FMA */
+                   VEC_ISA_AVX512};     /**< 512-bit AVX-512F */
+
+/**
+********************************************************************************
+** @struct  VecKernelTable
+** @brief   Function pointers to the selected variant of each vector kernel
+********************************************************************************
+*/
+struct VecKernelTable
+{
+    double (*dot)(const double* pX, const double* pY, UINT32 n);
+    void   (*axpy)(double a, const double* pX, double* pY, UINT32 n);
+    void   (*scale)(double a, double* pX, UINT32 n);
+    double (*sumSq)(const double* pX, UINT32 n);
+    double (*axpySumSq)(double a, const double* pX, double* pY, UINT32 n);
+
+    VecKernelIsa isa;
+};
+
+/*
+** Kernels selected for the CPU the program is running on
+*/
+extern VecKernelTable vecKernelTable;
+
+/*
+** Select the kernels of an instruction set, returning false if the CPU does
+** not support it
+*/
+bool setVecKernelIsa(const VecKernelIsa& isa);
+
+/*
+** Return the name of the instruction set of the selected kernels
+*/
+const char* getVecKernelIsaName(void);
+
+/**
+********************************************************************************
+** @details Inner (dot) product of two arrays
+** @param   pX  Pointer to the first array
+** @param   pY  Pointer to the second array
+** @param   n   Number of elements
+** @return  Dot product
+********************************************************************************
+*/
+inline double vecDot(const double* pX, const double* pY, const UINT32& n)
+{
+    return(vecKernelTable.dot(pX,pY,n));
+}
+
+/**
+********************************************************************************
+** @details AXPY update y = y + a*x
+** @param   a   Scalar multiplier of x
+** @param   pX  Pointer to the x array
+** @param   pY  Pointer to the y array, updated in place
+** @param   n   Number of elements
+********************************************************************************
+*/
+inline void vecAxpy(const double& a, const double* pX, double* pY,
+                    const UINT32& n)
+{
+    vecKernelTable.axpy(a,pX,pY,n);
+}
+
+/**
+********************************************************************************
+** @details Scale an array in place, x = a*x
+** @param   a   Scalar multiplier
+** @param   pX  Pointer to the array
+** @param   n   Number of elements
+********************************************************************************
+*/
+inline void vecScale(const double& a, double* pX, const UINT32& n)
+{
+    vecKernelTable.scale(a,pX,n);
+}
+
+/**
+********************************************************************************
+** @details Euclidean norm of an array
+** @param   pX  Pointer to the array
+** @param   n   Number of elements
+** @return  Norm of the array
+********************************************************************************
+*/
+inline double vecNorm(const double* pX, const UINT32& n)
+{
+    return(sqrt(vecKernelTable.sumSq(pX,n)));
+}
+
+/**
+********************************************************************************
+** @details Remove the component of a unit vector q from a vector v, in two
+**          passes over memory. The first pass calculates the dot product q'*v
+**          and the second pass updates v = v - (q'*v)*q while summing the
+**          squares of the updated elements, so the magnitude of the result is
+**          known without a third pass.
+** @param   pQ  Pointer to the unit vector q
+** @param   pV  Pointer to the vector v, updated in place
+** @param   n   Number of elements
+** @return  Sum of squares of the updated vector v
+********************************************************************************
+*/
+inline double vecProjectOut(const double* pQ, double* pV, const UINT32& n)
+{
+    return(vecKernelTable.axpySumSq(-vecKernelTable.dot(pQ,pV,n),pQ,pV,n));
+}
+
+#endif
@@ -42,24 +42,86 @@
 
 /*------------------------------[Include Files]-------------------------------*/
 #include "StdTypes.hh"
+#include "Arena.hh"
+#include "Expression.hh"
 #include "Matrix.hh"
+#include "View.hh"
 
 
 /*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @def   VECTOR_INLINE_SIZE
+** @brief Largest vector dimension stored inside the Vector object instead of
+**        on the heap
+********************************************************************************
+*/
+#define VECTOR_INLINE_SIZE 8
+
 /**
 ********************************************************************************
 ** @class   Vector
 ** @brief   Incorporate n-dimensional vectors and vector math operations
 ** @details A class to implement general n-dimensional vectors and perform
-**          various vector math operations.
+**          various vector math operations. The element-wise operators build
+**          expression templates, which are evaluated in a single loop when
+**          assigned to a Vector object. The elements of a vector with at most
+**          VECTOR_INLINE_SIZE dimensions are kept in a buffer inside the
+**          object, so small vectors and their temporaries are never allocated
+**          on the heap. Larger vectors draw from the current Arena when an
+**          ArenaScope is alive on the thread.
 ********************************************************************************
 */
-class Vector
+class Vector : public VectorExpr<Vector>
 {
     private:
         UINT32 ndims;   /* Number of dimensions (elements) in the vector */
 
         double* pVec;   /* Pointer to the vector elements */
+        bool fromArena; /* Elements are in an arena */
+
+        double inlineVec[VECTOR_INLINE_SIZE];   /* Small vector elements */
+
+        /*
+        ** Point the vector at storage for n elements, in the inline buffer if
+        ** it is large enough, then in the current arena unless useArena is
+        ** false, and otherwise on the heap
+        */
+        void allocate(const UINT32& n, const bool& useArena = true)
+        {
+            Arena* pArena = NULL;
+
+            if (n > VECTOR_INLINE_SIZE && useArena)
+            {
+                pArena = Arena::current();
+            }
+
+            fromArena = (NULL != pArena);
+
+            if (n <= VECTOR_INLINE_SIZE)
+            {
+                pVec = inlineVec;
+            }
+            else if (fromArena)
+            {
+                pVec = pArena->allocDoubles(n);
+            }
+            else
+            {
+                pVec = new double [n];
+            }
+        }
+
+        /*
+        ** Free the element storage if it is on the heap
+        */
+        void release(void)
+        {
+            if (pVec != inlineVec && !fromArena)
+            {
+                delete[] pVec;
+            }
+        }
 
     public:
 
@@ -78,6 +140,17 @@ class Vector
         */
         Vector(const double* vals, const UINT32& n);
 
+        /*
+        ** Constructor taking ownership of a heap buffer
+        */
+        Vector(double* vals, const UINT32& n, AdoptBuffer);
+
+        /*
+        ** Constructor evaluating a Vector expression
+        */
+        template <typename E>
+        Vector(const VectorExpr<E>& rhs);
+
         /*
         ** Default copy constructor
         */
@@ -88,6 +161,12 @@ class Vector
         */
         Vector& operator=(const Vector& rhs);
 
+        /*
+        ** Vector expression assignment
+        */
+        template <typename E>
+        Vector& operator=(const VectorExpr<E>& rhs);
+
         /*
         ** Default move constructor
         */
@@ -98,10 +177,10 @@ class Vector
         */
         Vector& operator=(Vector&& rhs);
 
-        /**
-        ** @brief Default destructor
+        /*
+        ** Destructor
         */
-        ~Vector() = default;
+        ~Vector();
 
         /*
         ** Check the vector dimension to ensure it is greater than zero
@@ -124,6 +203,18 @@ class Vector
         */
         Vector unit(void);
 
+        /*
+        ** Scale the vector to unit magnitude in place, returning the original
+        ** magnitude
+        */
+        double normalize(void);
+
+        /*
+        ** Remove the component of a unit vector in place, returning the
+        ** magnitude of the result
+        */
+        double projectOut(const Vector& unitVec);
+
         /*
         ** Outer product of two vectors
         */
@@ -136,14 +227,22 @@ class Vector
         Vector& operator-=(const Vector& rhs);
         Vector& operator*=(const double& rhs);
         Vector& operator/=(const double& rhs);
-        const Vector operator+(const Vector& rhs) const;
-        const Vector operator-(const Vector& rhs) const;
         double operator*(const Vector& rhs) const;
-        const Vector operator/(const double& rhs) const;
         double& operator[](const UINT32& i) const;
         double& operator[](const INT32& i) const;
 
-        friend Vector operator*(const double& lhs, const Vector& rhs);
+        template <typename E>
+        Vector& operator+=(const VectorExpr<E>& rhs);
+        template <typename E>
+        Vector& operator-=(const VectorExpr<E>& rhs);
+
+        /*
+        ** Evaluate an element as a Vector expression (no bounds check)
+        */
+        double eval(const UINT32& i) const
+        {
+            return(pVec[i]);
+        }
 
         /*
         ** Print object information
@@ -163,6 +262,99 @@ class Vector
         ** Get the vector dimension
         */
         const UINT32& getSize(void) const;
+
+        /*
+        ** Return a view of the vector elements
+        */
+        VectorView view(void) const;
 };
 
+/*--------------------------[Vector Template Methods]-------------------------*/
+/**
+********************************************************************************
+** @details Vector class constructor evaluating a Vector expression
+** @param   rhs Vector expression
+********************************************************************************
+*/
+template <typename E>
+Vector::Vector(const VectorExpr<E>& rhs)
+{
+    const E& vecExpr = rhs.expr();
+
+    ndims = vecExpr.getSize();
+    checkSize(ndims);
+
+    allocate(ndims);
+
+    for (UINT32 i = 0; i < ndims; i++)
+    {
+        pVec[i] = vecExpr.eval(i);
+    }
+}
+
+/**
+********************************************************************************
+** @details Vector expression assignment operator. Each element of the
+**          expression only depends on the same element of its operands, so
+**          the calling object may also appear in the expression.
+** @param   rhs Vector expression
+** @return  Calling object with the expression values
+********************************************************************************
+*/
+template <typename E>
+Vector& Vector::operator=(const VectorExpr<E>& rhs)
+{
+    const E& vecExpr = rhs.expr();
+
+    checkOperatorSize(ndims,vecExpr.getSize());
+    for (UINT32 i = 0; i < ndims; i++)
+    {
+        pVec[i] = vecExpr.eval(i);
+    }
+
+    return(*this);
+}
+
+/**
+********************************************************************************
+** @details Vector expression addition compound assignment
+** @param   rhs Vector expression
+** @return  Calling object with added values
+********************************************************************************
+*/
+template <typename E>
+Vector& Vector::operator+=(const VectorExpr<E>& rhs)
+{
+    const E& vecExpr = rhs.expr();
+
+    checkOperatorSize(ndims,vecExpr.getSize());
+    for (UINT32 i = 0; i < ndims; i++)
+    {
+        pVec[i] += vecExpr.eval(i);
+    }
+
+    return(*this);
+}
+
+/**
+********************************************************************************
+** @details Vector expression subtraction compound assignment
+** @param   rhs Vector expression
+** @return  Calling object with subtracted values
+********************************************************************************
+*/
+template <typename E>
+Vector& Vector::operator-=(const VectorExpr<E>& rhs)
+{
+    const E& vecExpr = rhs.expr();
+
+    checkOperatorSize(ndims,vecExpr.getSize());
+    for (UINT32 i = 0; i < ndims; i++)
+    {
+        pVec[i] -= vecExpr.eval(i);
+    }
+
+    return(*this);
+}
+
 #endif
@@ -0,0 +1,354 @@
+/**
+********************************************************************************
+** @file    View.hh
+**
+** @brief   Declaration of the VectorView and MatrixView classes
+**
+** @details Views are non-owning windows onto vector and matrix elements held
+**          elsewhere, such as in a Vector or Matrix object or a caller-owned
+**          buffer. Each view has a stride between its elements, so sub-
+**          blocks, single rows and columns, and transposes of a matrix are
+**          all views of the same memory and are made without copying any
+**          elements.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  View.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _VIEW_HH_
+#define _VIEW_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include "StdTypes.hh"
+#include "Expression.hh"
+#include "Workspace.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @def   MATRIX_ALIGN
+** @brief Alignment in bytes of matrix storage and of each padded row or column
+********************************************************************************
+*/
+#define MATRIX_ALIGN ARENA_ALIGN
+
+/**
+********************************************************************************
+** @details Pad a leading dimension so each row or column of a matrix starts
+**          on a MATRIX_ALIGN boundary when the first one does
+** @param   n   Number of elements in each row or column
+** @return  n rounded up to a multiple of MATRIX_ALIGN bytes
+********************************************************************************
+*/
+inline UINT32 padLeadDim(const UINT32& n)
+{
+    const UINT32 align = MATRIX_ALIGN/sizeof(double);
+
+    return((n + align - 1)/align*align);
+}
+
+/**
+********************************************************************************
+** @enum    DecompFlag
+** @brief   Result returned by a QR decomposition
+********************************************************************************
+*/
+enum DecompFlag {MATRIX_DECOMP_RANK,    /**< Rank of the matrix */
+                 MATRIX_DECOMP_DET};    /**< Determinant of the matrix */
+
+/*
+** View storage
+**
+** Element i of a VectorView is found at pData[i*stride], and element (i,j) of
+** a MatrixView is found at pData[i*rowStride + j*colStride]. A view of a
+** row-major matrix with leading dimension ld has rowStride = ld and
+** colStride = 1, and its transpose swaps the two strides. A view does not own
+** its elements, so it must not outlive the memory it looks at.
+*/
+
+/**
+********************************************************************************
+** @class   VectorView
+** @brief   Non-owning strided window onto vector elements
+** @details A VectorView is a Vector expression, so it may be used wherever a
+**          Vector may be used in an element-wise expression, and an expression
+**          assigned to a view is written into the viewed memory.
+********************************************************************************
+*/
+class VectorView : public VectorExpr<VectorView>
+{
+    private:
+        UINT32 ndims;   /* Number of elements */
+        UINT32 stride;  /* Distance between elements */
+
+        double* pData;  /* Pointer to the first element */
+
+    public:
+
+        /**
+        ** @brief Default constructor (disabled)
+        */
+        VectorView();
+
+        /*
+        ** Constructor (three parameters)
+        */
+        VectorView(double* data, const UINT32& n, const UINT32& inc = 1);
+
+        /*
+        ** Copy constructor, which views the same elements
+        */
+        VectorView(const VectorView& rhs) = default;
+
+        /*
+        ** Copy assignment, which copies the elements
+        */
+        VectorView& operator=(const VectorView& rhs);
+
+        /*
+        ** Vector expression assignment
+        */
+        template <typename E>
+        VectorView& operator=(const VectorExpr<E>& rhs);
+
+        /*
+        ** Calculate the magnitude of the viewed vector
+        */
+        double mag(void) const;
+
+        /*
+        ** Scale the viewed vector to unit magnitude in place
+        */
+        double normalize(void);
+
+        /*
+        ** Operators
+        */
+        VectorView& operator*=(const double& rhs);
+        double operator*(const VectorView& rhs) const;
+        double& operator[](const UINT32& i) const;
+
+        /*
+        ** Evaluate an element as a Vector expression (no bounds check)
+        */
+        double eval(const UINT32& i) const
+        {
+            return(pData[(size_t)i*stride]);
+        }
+
+        /*
+        ** Access methods
+        */
+        UINT32 getSize(void) const;
+        UINT32 getStride(void) const;
+        double* getData(void) const;
+};
+
+/**
+********************************************************************************
+** @class   MatrixView
+** @brief   Non-owning strided window onto matrix elements
+** @details A MatrixView is a Matrix expression, and an expression assigned to
+**          a view is written into the viewed memory. Sub-blocks, rows,
+**          columns, and transposes of a view are views of the same memory.
+**          The rank and determinant are calculated directly from the viewed
+**          elements, without first copying the view into a Matrix object.
+********************************************************************************
+*/
+class MatrixView : public MatrixExpr<MatrixView>
+{
+    private:
+        UINT32 mrows;       /* Number of rows */
+        UINT32 ncols;       /* Number of columns */
+        UINT32 rowStride;   /* Distance between rows */
+        UINT32 colStride;   /* Distance between columns */
+
+        double* pData;      /* Pointer to element (0,0) */
+
+    public:
+
+        /**
+        ** @brief Default constructor (disabled)
+        */
+        MatrixView();
+
+        /*
+        ** Constructor (five parameters)
+        */
+        MatrixView(double* data, const UINT32& m, const UINT32& n,
+                   const UINT32& ld, const UINT32& inc = 1);
+
+        /*
+        ** Copy constructor, which views the same elements
+        */
+        MatrixView(const MatrixView& rhs) = default;
+
+        /*
+        ** Copy assignment, which copies the elements
+        */
+        MatrixView& operator=(const MatrixView& rhs);
+
+        /*
+        ** Matrix expression assignment
+        */
+        template <typename E>
+        MatrixView& operator=(const MatrixExpr<E>& rhs);
+
+        /*
+        ** Check the row and column indices are within the accessible range
+        */
+        void checkInd(const UINT32& i, const UINT32& j) const;
+
+        /*
+        ** Return a view of a sub-block of the matrix
+        */
+        MatrixView block(const UINT32& startRow, const UINT32& startCol,
+                         const UINT32& m, const UINT32& n) const;
+
+        /*
+        ** Return a view of a row or column of the matrix
+        */
+        VectorView row(const UINT32& i) const;
+        VectorView col(const UINT32& j) const;
+
+        /*
+        ** Return a view of the transpose of the matrix
+        */
+        MatrixView transpose(void) const;
+
+        /*
+        ** Calculate the rank of the matrix
+        */
+        UINT32 rank(void) const;
+        UINT32 rank(QRWorkspace& work) const;
+
+        /*
+        ** Calculate the determinant of a square matrix
+        */
+        double determinant(void) const;
+        double determinant(QRWorkspace& work) const;
+
+        /*
+        ** Calculate the QR decomposition of the matrix
+        */
+        void QRdecomp(INT32 decompFlag, double& det, UINT32& matRank) const;
+
+        /*
+        ** Operators
+        */
+        MatrixView& operator*=(const double& rhs);
+        double& operator()(const UINT32& i, const UINT32& j) const;
+
+        /*
+        ** Evaluate an element as a Matrix expression (no bounds check)
+        */
+        double eval(const UINT32& i, const UINT32& j) const
+        {
+            return(pData[(size_t)i*rowStride + (size_t)j*colStride]);
+        }
+
+        /*
+        ** Access methods
+        */
+        UINT32 getRows(void) const;
+        UINT32 getCols(void) const;
+        UINT32 getRowStride(void) const;
+        UINT32 getColStride(void) const;
+        double* getData(void) const;
+};
+
+/*
+** Calculate C = alpha*A*B + beta*C on matrix views
+*/
+void gemm(const double& alpha, const MatrixView& a, const MatrixView& b,
+          const double& beta, const MatrixView& c);
+
+/*-------------------------[View Template Methods]----------------------------*/
+/**
+********************************************************************************
+** @details Vector expression assignment operator, which writes the expression
+**          into the viewed elements. The expression must not read elements of
+**          the view other than the one being written.
+** @param   rhs Vector expression
+** @return  Calling object with the expression values
+********************************************************************************
+*/
+template <typename E>
+VectorView& VectorView::operator=(const VectorExpr<E>& rhs)
+{
+    const E& vecExpr = rhs.expr();
+
+    checkExprSize(ndims,vecExpr.getSize());
+    for (UINT32 i = 0; i < ndims; i++)
+    {
+        pData[(size_t)i*stride] = vecExpr.eval(i);
+    }
+
+    return(*this);
+}
+
+/**
+********************************************************************************
+** @details Matrix expression assignment operator, which writes the expression
+**          into the viewed elements row by row. The expression must not read
+**          elements of the view other than the one being written.
+** @param   rhs Matrix expression
+** @return  Calling object with the expression values
+********************************************************************************
+*/
+template <typename E>
+MatrixView& MatrixView::operator=(const MatrixExpr<E>& rhs)
+{
+    const E& matExpr = rhs.expr();
+
+    double* pRow;
+
+    if (mrows != matExpr.getRows() || ncols != matExpr.getCols())
+    {
+        printf("Error - %s\n"
+               "        Matrix dimensions are not equal\n",
+               __PRETTY_FUNCTION__);
+        exit(EXIT_FAILURE);
+    }
+
+    for (UINT32 i = 0; i < mrows; i++)
+    {
+        pRow = pData + (size_t)i*rowStride;
+        for (UINT32 j = 0; j < ncols; j++)
+        {
+            pRow[(size_t)j*colStride] = matExpr.eval(i,j);
+        }
+    }
+
+    return(*this);
+}
+
+#endif
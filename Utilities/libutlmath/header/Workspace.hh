@@ -0,0 +1,120 @@
+/**
+********************************************************************************
+** @file    Workspace.hh
+**
+** @brief   Declaration of the QRWorkspace class
+**
+** @details A workspace holds the scratch memory of the orthonormalization
+**          routines and the Matrix rank and determinant calculations for
+**          problems up to a maximum size, so a caller that solves many
+**          problems makes no heap allocations once the workspace is built.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Workspace.hh
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+#ifndef _WORKSPACE_HH_
+#define _WORKSPACE_HH_
+
+/*------------------------------[Include Files]-------------------------------*/
+#include "StdTypes.hh"
+#include "Arena.hh"
+
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @class   QRWorkspace
+** @brief   Preallocated scratch memory for QR and Gram-Schmidt calls
+** @details The workspace is sized for a maximum number of rows and columns,
+**          where a vector set of n vectors of dimension m counts as an m x n
+**          matrix. Each call given the workspace draws its scratch memory from
+**          the workspace arena and releases it on return. A problem larger than
+**          the maximum size is an error, since it would need a new block. A
+**          workspace is used by one thread at a time.
+********************************************************************************
+*/
+class QRWorkspace
+{
+    private:
+        Arena arena;        /* Scratch memory */
+
+        UINT32 maxRows;     /* Maximum number of rows */
+        UINT32 maxCols;     /* Maximum number of columns */
+
+        /*
+        ** Copy constructor and assignment (disabled)
+        */
+        QRWorkspace(const QRWorkspace& work);
+        QRWorkspace& operator=(const QRWorkspace& rhs);
+
+    public:
+
+        /*
+        ** Constructor (two parameters)
+        */
+        QRWorkspace(const UINT32& m, const UINT32& n);
+
+        /*
+        ** Check a problem size fits in the workspace
+        */
+        void checkFit(const UINT32& m, const UINT32& n) const;
+
+        /*
+        ** Get the workspace arena
+        */
+        Arena& getArena(void)
+        {
+            return(arena);
+        }
+
+        /*
+        ** Get the maximum number of rows
+        */
+        UINT32 getMaxRows(void) const;
+
+        /*
+        ** Get the maximum number of columns
+        */
+        UINT32 getMaxCols(void) const;
+
+        /*
+        ** Get the number of bytes of scratch memory needed for an m x n problem
+        */
+        static size_t getScratchSize(const UINT32& m, const UINT32& n);
+};
+
+/*
+** Workspace of the Gram-Schmidt routines, which is the same as the QR
+** workspace
+*/
+typedef QRWorkspace GramSchmidtWorkspace;
+
+#endif
@@ -0,0 +1,237 @@
+/**
+********************************************************************************
+** @file    Arena.cc
+**
+** @brief   Arena memory allocator
+**
+** @details The blocks of an arena are allocated on the heap with room to
+**          align their first byte to ARENA_ALIGN, and are only freed when the
+**          arena is destroyed.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Arena.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+#include "Arena.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/*
+** Arena of the innermost scope on each thread
+*/
+static thread_local Arena* pCurrentArena = NULL;
+
+/*------------------------------[Arena Methods]-------------------------------*/
+/**
+********************************************************************************
+** @details Arena class constructor
+** @param   size    Default number of bytes in each block
+********************************************************************************
+*/
+Arena::Arena(const size_t& size)
+{
+    if (0 == size)
+    {
+        printf("Error - %s\n"
+               "        Arena block size must be greater than zero\n",
+               __PRETTY_FUNCTION__);
+        exit(EXIT_FAILURE);
+    }
+
+    pBlocks = NULL;
+    noOfBlocks = 0;
+    capacity = 0;
+    blockSize = size;
+
+    reset();
+    addBlock(blockSize);
+}
+
+/**
+********************************************************************************
+** @details Arena destructor
+********************************************************************************
+*/
+Arena::~Arena()
+{
+    for (UINT32 i = 0; i < noOfBlocks; i++)
+    {
+        delete[] pBlocks[i].pRaw;
+    }
+
+    delete[] pBlocks;
+}
+
+/**
+********************************************************************************
+** @details Add a block to the end of the block list, growing the list if it is
+**          full
+** @param   size    Minimum number of usable bytes in the block
+********************************************************************************
+*/
+void Arena::addBlock(const size_t& size)
+{
+    ArenaBlock* pNewBlocks;
+    uintptr_t addr;
+
+    if (noOfBlocks == capacity)
+    {
+        capacity = (0 == capacity) ? 4 : 2*capacity;
+        pNewBlocks = new ArenaBlock [capacity];
+
+        for (UINT32 i = 0; i < noOfBlocks; i++)
+        {
+            pNewBlocks[i] = pBlocks[i];
+        }
+
+        delete[] pBlocks;
+        pBlocks = pNewBlocks;
+    }
+
+    pBlocks[noOfBlocks].pRaw = new char [size + ARENA_ALIGN];
+    pBlocks[noOfBlocks].size = size;
+
+    addr = reinterpret_cast<uintptr_t>(pBlocks[noOfBlocks].pRaw);
+    addr = (addr + ARENA_ALIGN - 1) & ~(uintptr_t)(ARENA_ALIGN - 1);
+    pBlocks[noOfBlocks].pData = reinterpret_cast<char*>(addr);
+
+    noOfBlocks++;
+}
+
+/**
+********************************************************************************
+** @details Allocate memory from the arena. The request is rounded up to a
+**          multiple of ARENA_ALIGN and taken from the first block, starting at
+**          the current one, with enough room left. A new block is added if no
+**          block has room.
+** @param   bytes   Number of bytes
+** @return  Pointer to the memory, aligned to ARENA_ALIGN
+********************************************************************************
+*/
+void* Arena::allocate(const size_t& bytes)
+{
+    size_t size;
+    void* pMem;
+
+    size = (bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+    while (top.offset + size > pBlocks[top.block].size)
+    {
+        top.block++;
+        top.offset = 0;
+
+        if (top.block == noOfBlocks)
+        {
+            addBlock((size > blockSize) ? size : blockSize);
+        }
+    }
+
+    pMem = pBlocks[top.block].pData + top.offset;
+    top.offset += size;
+
+    return(pMem);
+}
+
+/**
+********************************************************************************
+** @details Make sure the arena can hold size more bytes from its current
+**          position without adding a block, by adding one now if needed. The
+**          space is found with a trial allocation that is then rewound, so a
+**          later request of the same size lands in the same block.
+** @param   size    Number of bytes
+********************************************************************************
+*/
+void Arena::reserve(const size_t& size)
+{
+    ArenaMark mark = top;
+
+    allocate(size);
+    top = mark;
+}
+
+/**
+********************************************************************************
+** @details Return the number of bytes held in all blocks of the arena
+** @return  Capacity of the arena in bytes
+********************************************************************************
+*/
+size_t Arena::getCapacity(void) const
+{
+    size_t total = 0;
+
+    for (UINT32 i = 0; i < noOfBlocks; i++)
+    {
+        total += pBlocks[i].size;
+    }
+
+    return(total);
+}
+
+/**
+********************************************************************************
+** @details Return the arena of the innermost scope on the calling thread
+** @return  Pointer to the current arena, or NULL if there is no scope
+********************************************************************************
+*/
+Arena* Arena::current(void)
+{
+    return(pCurrentArena);
+}
+
+/*---------------------------[ArenaScope Methods]-----------------------------*/
+/**
+********************************************************************************
+** @details ArenaScope class constructor
+** @param   scopeArena  Arena made current for the scope
+********************************************************************************
+*/
+ArenaScope::ArenaScope(Arena& scopeArena) : arena(scopeArena)
+{
+    pPrevious = pCurrentArena;
+    start = arena.getMark();
+
+    pCurrentArena = &arena;
+}
+
+/**
+********************************************************************************
+** @details ArenaScope destructor
+********************************************************************************
+*/
+ArenaScope::~ArenaScope()
+{
+    arena.rewind(start);
+
+    pCurrentArena = pPrevious;
+}
@@ -0,0 +1,463 @@
+/**
+********************************************************************************
+** @file    Batched.cc
+**
+** @brief   Batched orthonormalization of small vector sets
+**
+** @details The batch kernels run the Modified Gram-Schmidt algorithm on
+**          several problems at once, one problem in each SIMD lane. Every
+**          problem follows the same sequence of operations, so the lanes never
+**          diverge. A vector that is rejected in one lane is set to zero,
+**          which makes the following projections a no operation in that lane.
+**          Groups of lanes are spread over the shared thread pool.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Batched.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define BATCH_X86
+#endif
+
+#include "Batched.hh"
+#include "ThreadPool.hh"
+#include "VecKernels.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @def   BATCH_GRAIN
+** @brief Minimum number of problems in each thread pool task
+********************************************************************************
+*/
+#define BATCH_GRAIN 1024
+
+/*
+** Batch kernel that orthonormalizes the problems in one group of lanes. The
+** pointer addresses the first problem of the group and consecutive elements
+** of a problem are stride elements apart.
+*/
+typedef void (*BatchKernel)(double* pBatch, UINT32 m, UINT32 n, size_t stride,
+                            UINT32* pRank);
+
+/**
+********************************************************************************
+** @details Orthonormalize one problem with portable C++ loops
+** @param   pBatch  Pointer to the first element of the problem
+** @param   m       Dimension of each vector
+** @param   n       Number of vectors
+** @param   stride  Distance between consecutive elements of the problem
+** @param   pRank   Pointer that receives the rank of the problem
+********************************************************************************
+*/
+static void batchGeneric(double* pBatch, UINT32 m, UINT32 n, size_t stride,
+                         UINT32* pRank)
+{
+    UINT32 rank = 0;
+
+    double sumSq;
+    double scale;
+    double dot;
+
+    double* pVj;
+    double* pVk;
+
+    for (UINT32 j = 0; j < n; j++)
+    {
+        pVj = pBatch + (size_t)j*m*stride;
+
+        sumSq = 0;
+        for (UINT32 i = 0; i < m; i++)
+        {
+            sumSq += pVj[i*stride]*pVj[i*stride];
+        }
+
+        /*
+        ** A rejected vector is set to zero
+        */
+        scale = 0;
+        if (sqrt(sumSq) >= FLOAT_TOL)
+        {
+            scale = 1/sqrt(sumSq);
+            rank++;
+        }
+
+        for (UINT32 i = 0; i < m; i++)
+        {
+            pVj[i*stride] *= scale;
+        }
+
+        for (UINT32 k = j+1; k < n; k++)
+        {
+            pVk = pBatch + (size_t)k*m*stride;
+
+            dot = 0;
+            for (UINT32 i = 0; i < m; i++)
+            {
+                dot += pVj[i*stride]*pVk[i*stride];
+            }
+            for (UINT32 i = 0; i < m; i++)
+            {
+                pVk[i*stride] -= dot*pVj[i*stride];
+            }
+        }
+    }
+
+    *pRank = rank;
+}
+
+#ifdef BATCH_X86
+/**
+********************************************************************************
+** @details Orthonormalize two problems at once with SSE2
+** @param   pBatch  Pointer to the first element of the first problem
+** @param   m       Dimension of each vector
+** @param   n       Number of vectors
+** @param   stride  Distance between consecutive elements of a problem
+** @param   pRank   Array that receives the rank of each problem
+********************************************************************************
+*/
+static void batchSSE2(double* pBatch, UINT32 m, UINT32 n, size_t stride,
+                      UINT32* pRank)
+{
+    __m128d one = _mm_set1_pd(1);
+    __m128d tol = _mm_set1_pd(FLOAT_TOL);
+    __m128d rank = _mm_setzero_pd();
+    __m128d sumSq;
+    __m128d norm;
+    __m128d accept;
+    __m128d scale;
+    __m128d dot;
+    __m128d x;
+
+    double lanes[2];
+
+    double* pVj;
+    double* pVk;
+
+    for (UINT32 j = 0; j < n; j++)
+    {
+        pVj = pBatch + (size_t)j*m*stride;
+
+        sumSq = _mm_setzero_pd();
+        for (UINT32 i = 0; i < m; i++)
+        {
+            x = _mm_loadu_pd(pVj + i*stride);
+            sumSq = _mm_add_pd(sumSq,_mm_mul_pd(x,x));
+        }
+
+        norm = _mm_sqrt_pd(sumSq);
+        accept = _mm_cmpge_pd(norm,tol);
+        scale = _mm_and_pd(accept,_mm_div_pd(one,norm));
+        rank = _mm_add_pd(rank,_mm_and_pd(accept,one));
+
+        for (UINT32 i = 0; i < m; i++)
+        {
+            _mm_storeu_pd(pVj + i*stride,
+                          _mm_mul_pd(scale,_mm_loadu_pd(pVj + i*stride)));
+        }
+
+        for (UINT32 k = j+1; k < n; k++)
+        {
+            pVk = pBatch + (size_t)k*m*stride;
+
+            dot = _mm_setzero_pd();
+            for (UINT32 i = 0; i < m; i++)
+            {
+                dot = _mm_add_pd(dot,_mm_mul_pd(_mm_loadu_pd(pVj + i*stride),
+                                                _mm_loadu_pd(pVk + i*stride)));
+            }
+            for (UINT32 i = 0; i < m; i++)
+            {
+                x = _mm_mul_pd(dot,_mm_loadu_pd(pVj + i*stride));
+                _mm_storeu_pd(pVk + i*stride,
+                              _mm_sub_pd(_mm_loadu_pd(pVk + i*stride),x));
+            }
+        }
+    }
+
+    _mm_storeu_pd(lanes,rank);
+    for (UINT32 l = 0; l < 2; l++)
+    {
+        pRank[l] = (UINT32)lanes[l];
+    }
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize four problems at once with AVX2 and FMA
+** @param   pBatch  Pointer to the first element of the first problem
+** @param   m       Dimension of each vector
+** @param   n       Number of vectors
+** @param   stride  Distance between consecutive elements of a problem
+** @param   pRank   Array that receives the rank of each problem
+********************************************************************************
+*/
+__attribute__((target("avx2,fma")))
+static void batchAVX2(double* pBatch, UINT32 m, UINT32 n, size_t stride,
+                      UINT32* pRank)
+{
+    __m256d one = _mm256_set1_pd(1);
+    __m256d tol = _mm256_set1_pd(FLOAT_TOL);
+    __m256d rank = _mm256_setzero_pd();
+    __m256d sumSq;
+    __m256d norm;
+    __m256d accept;
+    __m256d scale;
+    __m256d dot;
+    __m256d x;
+
+    double lanes[4];
+
+    double* pVj;
+    double* pVk;
+
+    for (UINT32 j = 0; j < n; j++)
+    {
+        pVj = pBatch + (size_t)j*m*stride;
+
+        sumSq = _mm256_setzero_pd();
+        for (UINT32 i = 0; i < m; i++)
+        {
+            x = _mm256_loadu_pd(pVj + i*stride);
+            sumSq = _mm256_fmadd_pd(x,x,sumSq);
+        }
+
+        norm = _mm256_sqrt_pd(sumSq);
+        accept = _mm256_cmp_pd(norm,tol,_CMP_GE_OQ);
+        scale = _mm256_and_pd(accept,_mm256_div_pd(one,norm));
+        rank = _mm256_add_pd(rank,_mm256_and_pd(accept,one));
+
+        for (UINT32 i = 0; i < m; i++)
+        {
+            x = _mm256_loadu_pd(pVj + i*stride);
+            _mm256_storeu_pd(pVj + i*stride,_mm256_mul_pd(scale,x));
+        }
+
+        for (UINT32 k = j+1; k < n; k++)
+        {
+            pVk = pBatch + (size_t)k*m*stride;
+
+            dot = _mm256_setzero_pd();
+            for (UINT32 i = 0; i < m; i++)
+            {
+                dot = _mm256_fmadd_pd(_mm256_loadu_pd(pVj + i*stride),
+                                      _mm256_loadu_pd(pVk + i*stride),dot);
+            }
+            for (UINT32 i = 0; i < m; i++)
+            {
+                x = _mm256_loadu_pd(pVk + i*stride);
+                x = _mm256_fnmadd_pd(dot,_mm256_loadu_pd(pVj + i*stride),x);
+                _mm256_storeu_pd(pVk + i*stride,x);
+            }
+        }
+    }
+
+    _mm256_storeu_pd(lanes,rank);
+    for (UINT32 l = 0; l < 4; l++)
+    {
+        pRank[l] = (UINT32)lanes[l];
+    }
+
+    _mm256_zeroupper();
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize eight problems at once with AVX-512F. The rejected
+**          lanes are handled with mask registers, and the ranks are converted
+**          to integers in a register before they are stored.
+** @param   pBatch  Pointer to the first element of the first problem
+** @param   m       Dimension of each vector
+** @param   n       Number of vectors
+** @param   stride  Distance between consecutive elements of a problem
+** @param   pRank   Array that receives the rank of each problem
+********************************************************************************
+*/
+__attribute__((target("avx512f")))
+static void batchAVX512(double* pBatch, UINT32 m, UINT32 n, size_t stride,
+                        UINT32* pRank)
+{
+    __m512d one = _mm512_set1_pd(1);
+    __m512d tol = _mm512_set1_pd(FLOAT_TOL);
+    __m512d rank = _mm512_setzero_pd();
+    __m512d sumSq;
+    __m512d norm;
+    __m512d scale;
+    __m512d dot;
+    __m512d x;
+
+    __mmask8 accept;
+
+    double* pVj;
+    double* pVk;
+
+    for (UINT32 j = 0; j < n; j++)
+    {
+        pVj = pBatch + (size_t)j*m*stride;
+
+        sumSq = _mm512_setzero_pd();
+        for (UINT32 i = 0; i < m; i++)
+        {
+            x = _mm512_loadu_pd(pVj + i*stride);
+            sumSq = _mm512_fmadd_pd(x,x,sumSq);
+        }
+
+        norm = _mm512_maskz_sqrt_pd(0xFF,sumSq);
+        accept = _mm512_cmp_pd_mask(norm,tol,_CMP_GE_OQ);
+        scale = _mm512_maskz_div_pd(accept,one,norm);
+        rank = _mm512_mask_add_pd(rank,accept,rank,one);
+
+        for (UINT32 i = 0; i < m; i++)
+        {
+            x = _mm512_loadu_pd(pVj + i*stride);
+            _mm512_storeu_pd(pVj + i*stride,_mm512_mul_pd(scale,x));
+        }
+
+        for (UINT32 k = j+1; k < n; k++)
+        {
+            pVk = pBatch + (size_t)k*m*stride;
+
+            dot = _mm512_setzero_pd();
+            for (UINT32 i = 0; i < m; i++)
+            {
+                dot = _mm512_fmadd_pd(_mm512_loadu_pd(pVj + i*stride),
+                                      _mm512_loadu_pd(pVk + i*stride),dot);
+            }
+            for (UINT32 i = 0; i < m; i++)
+            {
+                x = _mm512_loadu_pd(pVk + i*stride);
+                x = _mm512_fnmadd_pd(dot,_mm512_loadu_pd(pVj + i*stride),x);
+                _mm512_storeu_pd(pVk + i*stride,x);
+            }
+        }
+    }
+
+    _mm256_storeu_si256((__m256i*)pRank,_mm512_maskz_cvttpd_epu32(0xFF,rank));
+
+    _mm256_zeroupper();
+}
+#endif
+
+/**
+********************************************************************************
+** @details Orthonormalize every vector set of a batch in place with the
+**          Modified Gram-Schmidt algorithm. The problems are processed in
+**          groups of as many problems as the selected instruction set has
+**          double lanes, and the problems left after the last full group are
+**          processed one at a time. A vector is rejected when its remaining
+**          magnitude is less than FLOAT_TOL.
+**
+**          On return, each accepted vector is replaced by its orthonormal basis
+**          vector and each rejected vector is set to zero, so the basis of a
+**          problem keeps the order of its input vectors.
+** @param   pBatch          Pointer to the batch, stored as described in
+**                          Batched.hh
+** @param   m               Dimension of each vector
+** @param   n               Number of vectors in each problem
+** @param   noOfProblems    Number of problems in the batch
+** @param   pRank           Array of noOfProblems elements that receives the
+**                          rank of each problem
+** @return  Number of problems with n orthonormal basis vectors
+********************************************************************************
+*/
+UINT32 orthonormalizeBatched(double* pBatch, const UINT32& m, const UINT32& n,
+                             const UINT32& noOfProblems, UINT32* pRank)
+{
+    UINT32 lanes = 1;
+    UINT32 noOfGroups;
+    UINT32 grain;
+    UINT32 fullRank = 0;
+
+    BatchKernel kernel = batchGeneric;
+
+    switch (vecKernelTable.isa)
+    {
+#ifdef BATCH_X86
+        case VEC_ISA_AVX512:
+            kernel = batchAVX512;
+            lanes = 8;
+            break;
+
+        case VEC_ISA_AVX2:
+            kernel = batchAVX2;
+            lanes = 4;
+            break;
+
+        case VEC_ISA_SSE2:
+            kernel = batchSSE2;
+            lanes = 2;
+            break;
+#endif
+
+        default:
+            break;
+    }
+
+    /*
+    ** Split the groups into a few tasks per thread, with at least BATCH_GRAIN
+    ** problems in each task
+    */
+    noOfGroups = noOfProblems/lanes;
+    grain = noOfGroups/(4*ThreadPool::instance().getThreadCount()) + 1;
+    if (grain < BATCH_GRAIN/lanes)
+    {
+        grain = BATCH_GRAIN/lanes;
+    }
+
+    ThreadPool::instance().parallelFor(0,noOfGroups,grain,
+        [&](UINT32 first, UINT32 last)
+        {
+            for (UINT32 g = first; g < last; g++)
+            {
+                kernel(pBatch + (size_t)g*lanes,m,n,noOfProblems,
+                       pRank + (size_t)g*lanes);
+            }
+        });
+
+    for (UINT32 p = noOfGroups*lanes; p < noOfProblems; p++)
+    {
+        batchGeneric(pBatch + p,m,n,noOfProblems,pRank + p);
+    }
+
+    for (UINT32 p = 0; p < noOfProblems; p++)
+    {
+        if (n == pRank[p])
+        {
+            fullRank++;
+        }
+    }
+
+    return(fullRank);
+}
@@ -0,0 +1,196 @@
+/**
+********************************************************************************
+** @file    FixedDispatch.cc
+**
+** @brief   Run time dispatch to the fixed dimension routines
+**
+** @details Each routine switches on its run time dimension to an
+**          instantiation of the fixed dimension templates, so a small problem
+**          runs with unrolled loops and stack storage only. The rank and
+**          determinant are dispatched for square matrices, which covers the
+**          Grammian of a vector set.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  FixedDispatch.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include "FixedDispatch.hh"
+#include "FixedMatrix.hh"
+#include "Matrix.hh"
+#include "Orthonormal.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @details Check if a dimension has fixed dimension code
+** @param   n   Dimension
+** @return  True for the dimensions 2, 3, 4, 6, 8, and 16
+********************************************************************************
+*/
+bool isFixedDim(const UINT32& n)
+{
+    switch (n)
+    {
+        case 2:
+        case 3:
+        case 4:
+        case 6:
+        case 8:
+        case 16:
+            return(true);
+
+        default:
+            return(false);
+    }
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize a set of vectors in place with the Modified
+**          Gram-Schmidt algorithm, with the fixed dimension code if the
+**          dimension m has it, and orthonormalize() otherwise
+** @param   pVecs       Pointer to the n contiguous vectors of the set
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors
+** @param   setRank     Rank of the vector set
+** @param   pOrthVecInd Array of at least setRank elements that receives the
+**                      index of the input vector of each basis vector
+** @return  Number of orthonormal basis vectors, which is less than setRank
+**          when fewer than setRank vectors of the set are independent to
+**          FLOAT_TOL
+********************************************************************************
+*/
+UINT32 orthonormalizeFixed(double* pVecs, const UINT32& m, const UINT32& n,
+                           const UINT32& setRank, UINT32* pOrthVecInd)
+{
+    switch (m)
+    {
+        case 2:
+            return(fixedOrthonormalize<2>(pVecs,n,setRank,pOrthVecInd));
+
+        case 3:
+            return(fixedOrthonormalize<3>(pVecs,n,setRank,pOrthVecInd));
+
+        case 4:
+            return(fixedOrthonormalize<4>(pVecs,n,setRank,pOrthVecInd));
+
+        case 6:
+            return(fixedOrthonormalize<6>(pVecs,n,setRank,pOrthVecInd));
+
+        case 8:
+            return(fixedOrthonormalize<8>(pVecs,n,setRank,pOrthVecInd));
+
+        case 16:
+            return(fixedOrthonormalize<16>(pVecs,n,setRank,pOrthVecInd));
+
+        default:
+            return(orthonormalize(pVecs,m,m,n,setRank,pOrthVecInd));
+    }
+}
+
+/**
+********************************************************************************
+** @details Calculate the rank of a matrix, with the fixed size code if the
+**          matrix is square with a fixed dimension, and the Matrix class
+**          otherwise
+** @param   pMat    Pointer to the row-major matrix elements
+** @param   m       Number of rows
+** @param   n       Number of columns
+** @return  Rank of the matrix
+********************************************************************************
+*/
+UINT32 rankFixed(const double* pMat, const UINT32& m, const UINT32& n)
+{
+    if (m == n)
+    {
+        switch (n)
+        {
+            case 2:
+                return(FixedMatrix<2,2>(pMat).rank());
+
+            case 3:
+                return(FixedMatrix<3,3>(pMat).rank());
+
+            case 4:
+                return(FixedMatrix<4,4>(pMat).rank());
+
+            case 6:
+                return(FixedMatrix<6,6>(pMat).rank());
+
+            case 8:
+                return(FixedMatrix<8,8>(pMat).rank());
+
+            case 16:
+                return(FixedMatrix<16,16>(pMat).rank());
+
+            default:
+                break;
+        }
+    }
+
+    return(Matrix(pMat,m,n).rank());
+}
+
+/**
+********************************************************************************
+** @details Calculate the determinant of a square matrix, with the fixed size
+**          code if the dimension has it, and the Matrix class otherwise
+** @param   pMat    Pointer to the row-major matrix elements
+** @param   n       Number of rows and columns
+** @return  Determinant of the matrix
+********************************************************************************
+*/
+double determinantFixed(const double* pMat, const UINT32& n)
+{
+    switch (n)
+    {
+        case 2:
+            return(FixedMatrix<2,2>(pMat).determinant());
+
+        case 3:
+            return(FixedMatrix<3,3>(pMat).determinant());
+
+        case 4:
+            return(FixedMatrix<4,4>(pMat).determinant());
+
+        case 6:
+            return(FixedMatrix<6,6>(pMat).determinant());
+
+        case 8:
+            return(FixedMatrix<8,8>(pMat).determinant());
+
+        case 16:
+            return(FixedMatrix<16,16>(pMat).determinant());
+
+        default:
+            return(Matrix(pMat,n,n).determinant());
+    }
+}
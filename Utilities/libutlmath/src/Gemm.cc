@@ -0,0 +1,807 @@
+/**
+********************************************************************************
+** @file    Gemm.cc
+**
+** @brief   Packed, cache-blocked, parallel general matrix multiply
+**
+** @details The output matrix is split into tiles of GEMM_MC x GEMM_NC
+**          elements, which run as independent tasks on the shared thread pool.
+**          A task walks the inner dimension in blocks of GEMM_KC. For each
+**          block it packs the rows of op(A) into slivers of GEMM_MR rows and
+**          the columns of op(B) into slivers of GEMM_NR columns, so the
+**          micro-kernel reads both inputs with unit stride whatever their
+**          storage. The micro-kernel keeps a GEMM_MR x GEMM_NR block of C in
+**          registers for the whole inner block. A packed sliver of op(B) stays
+**          in the L1 cache while it is paired with every sliver of op(A), and
+**          the packed block of op(A) stays in the L2 cache.
+**
+**          When there are fewer output tiles than threads and the inner
+**          dimension is long, as in a product of two sets of vectors, the
+**          inner dimension is split into ranges instead and the partial
+**          products are added in order.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Gemm.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define GEMM_X86
+#endif
+
+#include "Gemm.hh"
+#include "ThreadPool.hh"
+#include "VecKernels.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @def   GEMM_MR
+** @brief Number of rows in a micro-kernel block of C
+********************************************************************************
+*/
+#define GEMM_MR 6
+
+/**
+********************************************************************************
+** @def   GEMM_NR
+** @brief Number of columns in a micro-kernel block of C
+********************************************************************************
+*/
+#define GEMM_NR 8
+
+/**
+********************************************************************************
+** @def   GEMM_MC
+** @brief Number of rows of op(A) packed at a time, a multiple of GEMM_MR
+********************************************************************************
+*/
+#define GEMM_MC 96
+
+/**
+********************************************************************************
+** @def   GEMM_KC
+** @brief Length of the inner dimension blocks
+********************************************************************************
+*/
+#define GEMM_KC 256
+
+/**
+********************************************************************************
+** @def   GEMM_NC
+** @brief Number of columns of op(B) packed at a time, a multiple of GEMM_NR
+********************************************************************************
+*/
+#define GEMM_NC 1024
+
+/*
+** Micro-kernel that multiplies a packed sliver of op(A) by a packed sliver of
+** op(B) and updates an mr x nr block of C
+*/
+typedef void (*GemmKernel)(UINT32 kc, const double* pA, const double* pB,
+                           double alpha, double beta, double* pC, UINT32 ldc,
+                           UINT32 mr, UINT32 nr);
+
+/**
+********************************************************************************
+** @struct  GemmBuffer
+** @brief   Scratch buffer owned by one thread and kept between calls, which
+**          only allocates when it has to grow
+********************************************************************************
+*/
+struct GemmBuffer
+{
+    double* pData;  /* Buffer elements */
+    size_t size;    /* Number of elements */
+    bool inUse;     /* Held by a call that is still running */
+
+    /*
+    ** Destructor
+    */
+    ~GemmBuffer()
+    {
+        delete[] pData;
+    }
+
+    /*
+    ** Return the buffer with at least n elements
+    */
+    double* reserve(const size_t& n)
+    {
+        if (n > size)
+        {
+            delete[] pData;
+            pData = new double [n];
+            size = n;
+        }
+
+        return(pData);
+    }
+};
+
+static thread_local GemmBuffer packABuf = {NULL,0,false};
+static thread_local GemmBuffer packBBuf = {NULL,0,false};
+static thread_local GemmBuffer partialBuf = {NULL,0,false};
+
+/**
+********************************************************************************
+** @details Write a block of C from a block of products held in memory, for
+**          the blocks on the edges of C that are smaller than GEMM_MR x GEMM_NR
+** @param   pTile   Pointer to the GEMM_MR x GEMM_NR block of products
+** @param   alpha   Scalar multiplier of the products
+** @param   beta    Scalar multiplier of C, which is not read if zero
+** @param   pC      Pointer to the first element of the block of C
+** @param   ldc     Leading dimension of C
+** @param   mr      Number of rows in the block of C
+** @param   nr      Number of columns in the block of C
+********************************************************************************
+*/
+static void storeTile(const double* pTile, double alpha, double beta,
+                      double* pC, UINT32 ldc, UINT32 mr, UINT32 nr)
+{
+    for (UINT32 i = 0; i < mr; i++)
+    {
+        for (UINT32 j = 0; j < nr; j++)
+        {
+            if (0 == beta)
+            {
+                pC[(size_t)i*ldc + j] = alpha*pTile[i*GEMM_NR + j];
+            }
+            else
+            {
+                pC[(size_t)i*ldc + j] = alpha*pTile[i*GEMM_NR + j] +
+                                        beta*pC[(size_t)i*ldc + j];
+            }
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Micro-kernel with portable C++ loops
+** @param   kc      Length of the inner dimension block
+** @param   pA      Pointer to the packed sliver of op(A)
+** @param   pB      Pointer to the packed sliver of op(B)
+** @param   alpha   Scalar multiplier of the products
+** @param   beta    Scalar multiplier of C, which is not read if zero
+** @param   pC      Pointer to the first element of the block of C
+** @param   ldc     Leading dimension of C
+** @param   mr      Number of rows in the block of C
+** @param   nr      Number of columns in the block of C
+********************************************************************************
+*/
+static void kernelGeneric(UINT32 kc, const double* pA, const double* pB,
+                          double alpha, double beta, double* pC, UINT32 ldc,
+                          UINT32 mr, UINT32 nr)
+{
+    double tile[GEMM_MR*GEMM_NR];
+
+    memset(tile,0,sizeof(tile));
+
+    for (UINT32 p = 0; p < kc; p++)
+    {
+        for (UINT32 i = 0; i < GEMM_MR; i++)
+        {
+            for (UINT32 j = 0; j < GEMM_NR; j++)
+            {
+                tile[i*GEMM_NR + j] += pA[i]*pB[j];
+            }
+        }
+
+        pA += GEMM_MR;
+        pB += GEMM_NR;
+    }
+
+    storeTile(tile,alpha,beta,pC,ldc,mr,nr);
+}
+
+#ifdef GEMM_X86
+/**
+********************************************************************************
+** @details Micro-kernel with AVX2 and FMA. The 6 x 8 block of C is held in
+**          twelve 256-bit registers, leaving room for the two op(B) vectors
+**          and the broadcast op(A) element.
+** @param   kc      Length of the inner dimension block
+** @param   pA      Pointer to the packed sliver of op(A)
+** @param   pB      Pointer to the packed sliver of op(B)
+** @param   alpha   Scalar multiplier of the products
+** @param   beta    Scalar multiplier of C, which is not read if zero
+** @param   pC      Pointer to the first element of the block of C
+** @param   ldc     Leading dimension of C
+** @param   mr      Number of rows in the block of C
+** @param   nr      Number of columns in the block of C
+********************************************************************************
+*/
+__attribute__((target("avx2,fma")))
+static void kernelAVX2(UINT32 kc, const double* pA, const double* pB,
+                       double alpha, double beta, double* pC, UINT32 ldc,
+                       UINT32 mr, UINT32 nr)
+{
+    __m256d c[GEMM_MR][2];
+    __m256d b0;
+    __m256d b1;
+    __m256d a;
+    __m256d va = _mm256_set1_pd(alpha);
+    __m256d vb = _mm256_set1_pd(beta);
+
+    double tile[GEMM_MR*GEMM_NR];
+
+    double* pRow;
+
+    for (UINT32 i = 0; i < GEMM_MR; i++)
+    {
+        c[i][0] = _mm256_setzero_pd();
+        c[i][1] = _mm256_setzero_pd();
+    }
+
+    for (UINT32 p = 0; p < kc; p++)
+    {
+        b0 = _mm256_loadu_pd(pB);
+        b1 = _mm256_loadu_pd(pB+4);
+
+        for (UINT32 i = 0; i < GEMM_MR; i++)
+        {
+            a = _mm256_broadcast_sd(pA+i);
+            c[i][0] = _mm256_fmadd_pd(a,b0,c[i][0]);
+            c[i][1] = _mm256_fmadd_pd(a,b1,c[i][1]);
+        }
+
+        pA += GEMM_MR;
+        pB += GEMM_NR;
+    }
+
+    if (GEMM_MR == mr && GEMM_NR == nr)
+    {
+        for (UINT32 i = 0; i < GEMM_MR; i++)
+        {
+            pRow = pC + (size_t)i*ldc;
+
+            if (0 == beta)
+            {
+                _mm256_storeu_pd(pRow,  _mm256_mul_pd(va,c[i][0]));
+                _mm256_storeu_pd(pRow+4,_mm256_mul_pd(va,c[i][1]));
+            }
+            else
+            {
+                _mm256_storeu_pd(pRow,
+                    _mm256_fmadd_pd(va,c[i][0],
+                                    _mm256_mul_pd(vb,_mm256_loadu_pd(pRow))));
+                _mm256_storeu_pd(pRow+4,
+                    _mm256_fmadd_pd(va,c[i][1],
+                                    _mm256_mul_pd(vb,_mm256_loadu_pd(pRow+4))));
+            }
+        }
+    }
+    else
+    {
+        for (UINT32 i = 0; i < GEMM_MR; i++)
+        {
+            _mm256_storeu_pd(tile + i*GEMM_NR,  c[i][0]);
+            _mm256_storeu_pd(tile + i*GEMM_NR+4,c[i][1]);
+        }
+
+        storeTile(tile,alpha,beta,pC,ldc,mr,nr);
+    }
+
+    _mm256_zeroupper();
+}
+
+/**
+********************************************************************************
+** @details Micro-kernel with AVX-512F. Each row of the 6 x 8 block of C is one
+**          512-bit register. The inner dimension is unrolled by two into
+**          separate accumulators, so there are enough independent FMA chains
+**          to cover the instruction latency.
+** @param   kc      Length of the inner dimension block
+** @param   pA      Pointer to the packed sliver of op(A)
+** @param   pB      Pointer to the packed sliver of op(B)
+** @param   alpha   Scalar multiplier of the products
+** @param   beta    Scalar multiplier of C, which is not read if zero
+** @param   pC      Pointer to the first element of the block of C
+** @param   ldc     Leading dimension of C
+** @param   mr      Number of rows in the block of C
+** @param   nr      Number of columns in the block of C
+********************************************************************************
+*/
+__attribute__((target("avx512f")))
+static void kernelAVX512(UINT32 kc, const double* pA, const double* pB,
+                         double alpha, double beta, double* pC, UINT32 ldc,
+                         UINT32 mr, UINT32 nr)
+{
+    UINT32 p;
+
+    __m512d c0[GEMM_MR];
+    __m512d c1[GEMM_MR];
+    __m512d b0;
+    __m512d b1;
+    __m512d va = _mm512_set1_pd(alpha);
+    __m512d vb = _mm512_set1_pd(beta);
+
+    double tile[GEMM_MR*GEMM_NR];
+
+    double* pRow;
+
+    for (UINT32 i = 0; i < GEMM_MR; i++)
+    {
+        c0[i] = _mm512_setzero_pd();
+        c1[i] = _mm512_setzero_pd();
+    }
+
+    for (p = 0; p+2 <= kc; p += 2)
+    {
+        b0 = _mm512_loadu_pd(pB);
+        b1 = _mm512_loadu_pd(pB+GEMM_NR);
+
+        for (UINT32 i = 0; i < GEMM_MR; i++)
+        {
+            c0[i] = _mm512_fmadd_pd(_mm512_set1_pd(pA[i]),b0,c0[i]);
+            c1[i] = _mm512_fmadd_pd(_mm512_set1_pd(pA[GEMM_MR+i]),b1,c1[i]);
+        }
+
+        pA += 2*GEMM_MR;
+        pB += 2*GEMM_NR;
+    }
+
+    if (p < kc)
+    {
+        b0 = _mm512_loadu_pd(pB);
+
+        for (UINT32 i = 0; i < GEMM_MR; i++)
+        {
+            c0[i] = _mm512_fmadd_pd(_mm512_set1_pd(pA[i]),b0,c0[i]);
+        }
+    }
+
+    for (UINT32 i = 0; i < GEMM_MR; i++)
+    {
+        c0[i] = _mm512_add_pd(c0[i],c1[i]);
+    }
+
+    if (GEMM_MR == mr && GEMM_NR == nr)
+    {
+        for (UINT32 i = 0; i < GEMM_MR; i++)
+        {
+            pRow = pC + (size_t)i*ldc;
+
+            if (0 == beta)
+            {
+                _mm512_storeu_pd(pRow,_mm512_mul_pd(va,c0[i]));
+            }
+            else
+            {
+                _mm512_storeu_pd(pRow,
+                    _mm512_fmadd_pd(va,c0[i],
+                                    _mm512_mul_pd(vb,_mm512_loadu_pd(pRow))));
+            }
+        }
+    }
+    else
+    {
+        for (UINT32 i = 0; i < GEMM_MR; i++)
+        {
+            _mm512_storeu_pd(tile + i*GEMM_NR,c0[i]);
+        }
+
+        storeTile(tile,alpha,beta,pC,ldc,mr,nr);
+    }
+
+    _mm256_zeroupper();
+}
+#endif
+
+/**
+********************************************************************************
+** @details Select the micro-kernel for the instruction set of the vector
+**          kernels. The SSE2 registers are too few to hold a block of C, so
+**          the SSE2 instruction set uses the portable kernel.
+** @return  Micro-kernel function
+********************************************************************************
+*/
+static GemmKernel selectKernel(void)
+{
+    switch (vecKernelTable.isa)
+    {
+#ifdef GEMM_X86
+        case VEC_ISA_AVX512:
+            return(kernelAVX512);
+
+        case VEC_ISA_AVX2:
+            return(kernelAVX2);
+#endif
+
+        default:
+            return(kernelGeneric);
+    }
+}
+
+/**
+********************************************************************************
+** @details Pack a block of op(A) into slivers of GEMM_MR rows. Element p of
+**          row i of a sliver is stored at p*GEMM_MR + i, and the rows past the
+**          end of op(A) are set to zero.
+** @param   transA  Operation applied to A
+** @param   pA      Pointer to A
+** @param   lda     Leading dimension of A
+** @param   i0      First row of op(A) in the block
+** @param   mc      Number of rows in the block
+** @param   p0      First column of op(A) in the block
+** @param   kc      Number of columns in the block
+** @param   pPack   Pointer to the packed block
+********************************************************************************
+*/
+static void packA(const GemmTrans& transA, const double* pA, const UINT32& lda,
+                  const UINT32& i0, const UINT32& mc, const UINT32& p0,
+                  const UINT32& kc, double* pPack)
+{
+    UINT32 rows;
+
+    for (UINT32 is = 0; is < mc; is += GEMM_MR)
+    {
+        rows = MIN(GEMM_MR,mc-is);
+
+        for (UINT32 i = 0; i < GEMM_MR; i++)
+        {
+            if (i >= rows)
+            {
+                for (UINT32 p = 0; p < kc; p++)
+                {
+                    pPack[p*GEMM_MR + i] = 0;
+                }
+            }
+            else if (GEMM_NO_TRANS == transA)
+            {
+                const double* pRow = pA + (size_t)(i0+is+i)*lda + p0;
+
+                for (UINT32 p = 0; p < kc; p++)
+                {
+                    pPack[p*GEMM_MR + i] = pRow[p];
+                }
+            }
+            else
+            {
+                for (UINT32 p = 0; p < kc; p++)
+                {
+                    pPack[p*GEMM_MR + i] = pA[(size_t)(p0+p)*lda + i0+is+i];
+                }
+            }
+        }
+
+        pPack += (size_t)GEMM_MR*kc;
+    }
+}
+
+/**
+********************************************************************************
+** @details Pack a block of op(B) into slivers of GEMM_NR columns. Element j of
+**          row p of a sliver is stored at p*GEMM_NR + j, and the columns past
+**          the end of op(B) are set to zero.
+** @param   transB  Operation applied to B
+** @param   pB      Pointer to B
+** @param   ldb     Leading dimension of B
+** @param   p0      First row of op(B) in the block
+** @param   kc      Number of rows in the block
+** @param   j0      First column of op(B) in the block
+** @param   nc      Number of columns in the block
+** @param   pPack   Pointer to the packed block
+********************************************************************************
+*/
+static void packB(const GemmTrans& transB, const double* pB, const UINT32& ldb,
+                  const UINT32& p0, const UINT32& kc, const UINT32& j0,
+                  const UINT32& nc, double* pPack)
+{
+    UINT32 cols;
+
+    for (UINT32 js = 0; js < nc; js += GEMM_NR)
+    {
+        cols = MIN(GEMM_NR,nc-js);
+
+        for (UINT32 j = 0; j < GEMM_NR; j++)
+        {
+            if (j >= cols)
+            {
+                for (UINT32 p = 0; p < kc; p++)
+                {
+                    pPack[p*GEMM_NR + j] = 0;
+                }
+            }
+            else if (GEMM_TRANS == transB)
+            {
+                const double* pCol = pB + (size_t)(j0+js+j)*ldb + p0;
+
+                for (UINT32 p = 0; p < kc; p++)
+                {
+                    pPack[p*GEMM_NR + j] = pCol[p];
+                }
+            }
+            else
+            {
+                for (UINT32 p = 0; p < kc; p++)
+                {
+                    pPack[p*GEMM_NR + j] = pB[(size_t)(p0+p)*ldb + j0+js+j];
+                }
+            }
+        }
+
+        pPack += (size_t)GEMM_NR*kc;
+    }
+}
+
+/**
+********************************************************************************
+** @details Calculate one tile of C = alpha*op(A)*op(B) + beta*C over a range
+**          of the inner dimension
+** @param   transA  Operation applied to A
+** @param   transB  Operation applied to B
+** @param   i0      First row of the tile
+** @param   mc      Number of rows in the tile, at most GEMM_MC
+** @param   j0      First column of the tile
+** @param   nc      Number of columns in the tile, at most GEMM_NC
+** @param   kBegin  First index of the inner dimension
+** @param   kEnd    One past the last index of the inner dimension
+** @param   alpha   Scalar multiplier of op(A)*op(B)
+** @param   pA      Pointer to A
+** @param   lda     Leading dimension of A
+** @param   pB      Pointer to B
+** @param   ldb     Leading dimension of B
+** @param   beta    Scalar multiplier of C, which is not read if zero
+** @param   pC      Pointer to C
+** @param   ldc     Leading dimension of C
+********************************************************************************
+*/
+static void gemmTile(const GemmTrans& transA, const GemmTrans& transB,
+                     const UINT32& i0, const UINT32& mc, const UINT32& j0,
+                     const UINT32& nc, const UINT32& kBegin,
+                     const UINT32& kEnd, const double& alpha,
+                     const double* pA, const UINT32& lda, const double* pB,
+                     const UINT32& ldb, const double& beta, double* pC,
+                     const UINT32& ldc)
+{
+    UINT32 kc;
+
+    double tileBeta;
+
+    double* pPackA;
+    double* pPackB;
+
+    GemmKernel kernel = selectKernel();
+
+    pPackA = packABuf.reserve((size_t)GEMM_MC*GEMM_KC);
+    pPackB = packBBuf.reserve((size_t)GEMM_KC*GEMM_NC);
+
+    for (UINT32 p0 = kBegin; p0 < kEnd; p0 += GEMM_KC)
+    {
+        kc = MIN(GEMM_KC,kEnd-p0);
+        tileBeta = (p0 == kBegin) ? beta : 1;
+
+        packA(transA,pA,lda,i0,mc,p0,kc,pPackA);
+        packB(transB,pB,ldb,p0,kc,j0,nc,pPackB);
+
+        for (UINT32 js = 0; js < nc; js += GEMM_NR)
+        {
+            for (UINT32 is = 0; is < mc; is += GEMM_MR)
+            {
+                kernel(kc,pPackA + (size_t)is*kc,pPackB + (size_t)js*kc,alpha,
+                       tileBeta,pC + (size_t)(i0+is)*ldc + j0+js,ldc,
+                       MIN(GEMM_MR,mc-is),MIN(GEMM_NR,nc-js));
+            }
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Calculate C = alpha*op(A)*op(B) + beta*C over a range of the inner
+**          dimension, with the tiles of C in parallel
+** @param   transA  Operation applied to A
+** @param   transB  Operation applied to B
+** @param   m       Number of rows of op(A) and C
+** @param   n       Number of columns of op(B) and C
+** @param   kBegin  First index of the inner dimension
+** @param   kEnd    One past the last index of the inner dimension
+** @param   alpha   Scalar multiplier of op(A)*op(B)
+** @param   pA      Pointer to A
+** @param   lda     Leading dimension of A
+** @param   pB      Pointer to B
+** @param   ldb     Leading dimension of B
+** @param   beta    Scalar multiplier of C, which is not read if zero
+** @param   pC      Pointer to C
+** @param   ldc     Leading dimension of C
+********************************************************************************
+*/
+static void gemmTiles(const GemmTrans& transA, const GemmTrans& transB,
+                      const UINT32& m, const UINT32& n, const UINT32& kBegin,
+                      const UINT32& kEnd, const double& alpha,
+                      const double* pA, const UINT32& lda, const double* pB,
+                      const UINT32& ldb, const double& beta, double* pC,
+                      const UINT32& ldc)
+{
+    UINT32 rowTiles = (m + GEMM_MC - 1)/GEMM_MC;
+    UINT32 colTiles = (n + GEMM_NC - 1)/GEMM_NC;
+
+    ThreadPool::instance().parallelFor(0,rowTiles*colTiles,1,
+        [&](UINT32 first, UINT32 last)
+        {
+            UINT32 i0;
+            UINT32 j0;
+
+            for (UINT32 t = first; t < last; t++)
+            {
+                i0 = (t%rowTiles)*GEMM_MC;
+                j0 = (t/rowTiles)*GEMM_NC;
+
+                gemmTile(transA,transB,i0,MIN(GEMM_MC,m-i0),j0,
+                         MIN(GEMM_NC,n-j0),kBegin,kEnd,alpha,pA,lda,pB,ldb,
+                         beta,pC,ldc);
+            }
+        });
+}
+
+/**
+********************************************************************************
+** @details General matrix multiply C = alpha*op(A)*op(B) + beta*C. The tiles
+**          of C run in parallel on the shared thread pool. When C has fewer
+**          tiles than the pool has threads, and the inner dimension has enough
+**          blocks, each thread calculates the product over a range of the
+**          inner dimension into its own array, and the arrays are added to C
+**          in order. C is not read when beta is zero, so it may hold any
+**          values on entry.
+** @param   transA  Operation applied to A
+** @param   transB  Operation applied to B
+** @param   m       Number of rows of op(A) and C
+** @param   n       Number of columns of op(B) and C
+** @param   k       Number of columns of op(A) and rows of op(B)
+** @param   alpha   Scalar multiplier of op(A)*op(B)
+** @param   pA      Pointer to A, stored by rows
+** @param   lda     Leading dimension of A
+** @param   pB      Pointer to B, stored by rows
+** @param   ldb     Leading dimension of B
+** @param   beta    Scalar multiplier of C
+** @param   pC      Pointer to C, stored by rows
+** @param   ldc     Leading dimension of C
+********************************************************************************
+*/
+void gemm(const GemmTrans& transA, const GemmTrans& transB, const UINT32& m,
+          const UINT32& n, const UINT32& k, const double& alpha,
+          const double* pA, const UINT32& lda, const double* pB,
+          const UINT32& ldb, const double& beta, double* pC,
+          const UINT32& ldc)
+{
+    UINT32 noOfTiles;
+    UINT32 noOfRanges;
+    UINT32 rangeLen;
+
+    size_t partialSize;
+
+    bool ownBuffer;
+
+    double* pPartial;
+
+    if (0 == m || 0 == n)
+    {
+        return;
+    }
+
+    /*
+    ** An empty inner dimension only scales C
+    */
+    if (0 == k || 0 == alpha)
+    {
+        for (UINT32 i = 0; i < m; i++)
+        {
+            if (0 == beta)
+            {
+                memset(pC + (size_t)i*ldc,0,n*sizeof(double));
+            }
+            else
+            {
+                vecScale(beta,pC + (size_t)i*ldc,n);
+            }
+        }
+        return;
+    }
+
+    noOfTiles = ((m + GEMM_MC - 1)/GEMM_MC)*((n + GEMM_NC - 1)/GEMM_NC);
+    noOfRanges = ThreadPool::instance().getThreadCount()/noOfTiles;
+    noOfRanges = MIN(noOfRanges,k/GEMM_KC);
+
+    if (noOfRanges < 2)
+    {
+        gemmTiles(transA,transB,m,n,0,k,alpha,pA,lda,pB,ldb,beta,pC,ldc);
+        return;
+    }
+
+    /*
+    ** Split the inner dimension into ranges that are a multiple of GEMM_KC,
+    ** each calculated into its own m x n array
+    */
+    rangeLen = (k + noOfRanges - 1)/noOfRanges;
+    rangeLen = (rangeLen + GEMM_KC - 1)/GEMM_KC*GEMM_KC;
+    noOfRanges = (k + rangeLen - 1)/rangeLen;
+
+    /*
+    ** The arrays are kept between calls in a buffer of the calling thread.
+    ** This thread runs other tasks while it waits for the ranges, so a call
+    ** nested in one of them finds the buffer in use and allocates its own.
+    */
+    partialSize = (size_t)noOfRanges*m*n;
+    ownBuffer = partialBuf.inUse;
+    if (ownBuffer)
+    {
+        pPartial = new double [partialSize];
+    }
+    else
+    {
+        partialBuf.inUse = true;
+        pPartial = partialBuf.reserve(partialSize);
+    }
+
+    ThreadPool::instance().parallelFor(0,noOfRanges,1,
+        [&](UINT32 first, UINT32 last)
+        {
+            for (UINT32 r = first; r < last; r++)
+            {
+                gemmTiles(transA,transB,m,n,r*rangeLen,
+                          MIN((r+1)*rangeLen,k),1,pA,lda,pB,ldb,0,
+                          pPartial + (size_t)r*m*n,n);
+            }
+        });
+
+    for (UINT32 r = 1; r < noOfRanges; r++)
+    {
+        vecAxpy(1,pPartial + (size_t)r*m*n,pPartial,m*n);
+    }
+
+    for (UINT32 i = 0; i < m; i++)
+    {
+        if (0 == beta)
+        {
+            memset(pC + (size_t)i*ldc,0,n*sizeof(double));
+        }
+        else
+        {
+            vecScale(beta,pC + (size_t)i*ldc,n);
+        }
+        vecAxpy(alpha,pPartial + (size_t)i*n,pC + (size_t)i*ldc,n);
+    }
+
+    if (ownBuffer)
+    {
+        delete[] pPartial;
+    }
+    else
+    {
+        partialBuf.inUse = false;
+    }
+}
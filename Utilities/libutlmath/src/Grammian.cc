@@ -0,0 +1,286 @@
+/**
+********************************************************************************
+** @file    Grammian.cc
+**
+** @brief   Utility to calculate the Grammian matrix of a set of vectors
+**
+** @details Element (i,j) of the Grammian is the inner product of vectors i and
+**          j. Only the upper triangle is calculated, over tiles of vectors and
+**          blocks of rows small enough to stay in cache, so each vector is
+**          read from memory once per tile of vectors instead of once per
+**          element. Ranges of rows run in parallel.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Grammian.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Grammian.hh"
+#include "Arena.hh"
+#include "ThreadPool.hh"
+#include "VecKernels.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @def   GRAM_ROW_BLOCK
+** @brief Number of rows of each vector in a Grammian block
+********************************************************************************
+*/
+#define GRAM_ROW_BLOCK 128
+
+/**
+********************************************************************************
+** @def   GRAM_VEC_TILE
+** @brief Number of vectors in a Grammian tile
+********************************************************************************
+*/
+#define GRAM_VEC_TILE 32
+
+/**
+********************************************************************************
+** @details Verify the dimensions of a vector set stored in contiguous memory
+** @param   lda Leading dimension of the vector set
+** @param   m   Dimension of each vector
+** @param   n   Number of vectors
+********************************************************************************
+*/
+static void checkGramSet(const UINT32& lda, const UINT32& m, const UINT32& n)
+{
+    if (m < 1 || n < 1)
+    {
+        printf("Error - %s\n"
+               "        Vector set of %u vectors with dimension %u\n",
+               __PRETTY_FUNCTION__,n,m);
+        exit(EXIT_FAILURE);
+    }
+    else if (lda < m)
+    {
+        printf("Error - %s\n"
+               "        Leading dimension (%u) is less than the vector\n"
+               "        dimension (%u)\n",
+               __PRETTY_FUNCTION__,lda,m);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+********************************************************************************
+** @details Accumulate the upper triangle of the Grammian matrix over a range
+**          of rows. For every block of rows, each pair of vector tiles on or
+**          above the diagonal is visited once. A block of GRAM_VEC_TILE vectors
+**          fits in the L1 cache, so the vectors of the column tile are reused
+**          from cache for every vector in the row tile.
+** @param   pVecs       Pointer to the vector set
+** @param   lda         Leading dimension of the vector set
+** @param   rowBegin    First row
+** @param   rowEnd      One past the last row
+** @param   n           Number of vectors
+** @param   pOut        Pointer to the output array, which must be zero
+** @param   packed      Output array is in packed storage if true, otherwise
+**                      it is a full n x n row-major matrix
+********************************************************************************
+*/
+static void gramUpper(const double* pVecs, const UINT32& lda,
+                      const UINT32& rowBegin, const UINT32& rowEnd,
+                      const UINT32& n, double* pOut, const bool& packed)
+{
+    UINT32 rows;
+    UINT32 iEnd;
+    UINT32 jEnd;
+
+    size_t ind;
+
+    const double* pVecI;
+
+    for (UINT32 r = rowBegin; r < rowEnd; r += GRAM_ROW_BLOCK)
+    {
+        rows = MIN(GRAM_ROW_BLOCK,rowEnd-r);
+
+        for (UINT32 jt = 0; jt < n; jt += GRAM_VEC_TILE)
+        {
+            jEnd = MIN(jt+GRAM_VEC_TILE,n);
+
+            for (UINT32 it = 0; it <= jt; it += GRAM_VEC_TILE)
+            {
+                iEnd = MIN(it+GRAM_VEC_TILE,n);
+
+                for (UINT32 i = it; i < iEnd; i++)
+                {
+                    pVecI = pVecs + (size_t)i*lda + r;
+
+                    for (UINT32 j = (i > jt) ? i : jt; j < jEnd; j++)
+                    {
+                        ind = packed ? packedIndex(i,j,n) : (size_t)i*n + j;
+                        pOut[ind] += vecDot(pVecI,pVecs + (size_t)j*lda + r,
+                                            rows);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Accumulate the upper triangle of the Grammian matrix in parallel on
+**          the shared thread pool. The rows are split into one range per
+**          thread, so the vector set is still read from memory once. The first
+**          range accumulates into the output array, the others into private
+**          arrays, and the private arrays are added to the output in order so
+**          the result does not depend on the order the ranges finish.
+** @param   pVecs       Pointer to the vector set
+** @param   lda         Leading dimension of the vector set
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors
+** @param   outSize     Number of elements in the output array
+** @param   pOut        Pointer to the output array, which must be zero
+** @param   packed      Output array is in packed storage if true, otherwise
+**                      it is a full n x n row-major matrix
+********************************************************************************
+*/
+static void gramUpperParallel(const double* pVecs, const UINT32& lda,
+                              const UINT32& m, const UINT32& n,
+                              const size_t& outSize, double* pOut,
+                              const bool& packed)
+{
+    UINT32 noOfRanges;
+    UINT32 rangeRows;
+
+    double* pPartial;
+
+    /*
+    ** Split the rows into ranges that are a multiple of the row block
+    */
+    noOfRanges = ThreadPool::instance().getThreadCount();
+    noOfRanges = MIN(noOfRanges,(m + GRAM_ROW_BLOCK - 1)/GRAM_ROW_BLOCK);
+    rangeRows = (m + noOfRanges - 1)/noOfRanges;
+    rangeRows = (rangeRows + GRAM_ROW_BLOCK - 1)/GRAM_ROW_BLOCK*GRAM_ROW_BLOCK;
+    noOfRanges = (m + rangeRows - 1)/rangeRows;
+
+    if (noOfRanges < 2)
+    {
+        gramUpper(pVecs,lda,0,m,n,pOut,packed);
+        return;
+    }
+
+    /*
+    ** The partial sums come from the current arena when there is one
+    */
+    ArenaArray partial((noOfRanges-1)*outSize);
+
+    pPartial = partial.get();
+
+    ThreadPool::instance().parallelFor(0,noOfRanges,1,
+        [&](UINT32 first, UINT32 last)
+        {
+            double* pRangeOut;
+
+            for (UINT32 k = first; k < last; k++)
+            {
+                pRangeOut = (0 == k) ? pOut : pPartial + (k-1)*outSize;
+                if (k > 0)
+                {
+                    memset(pRangeOut,0,outSize*sizeof(double));
+                }
+
+                gramUpper(pVecs,lda,k*rangeRows,MIN((k+1)*rangeRows,m),n,
+                          pRangeOut,packed);
+            }
+        });
+
+    for (UINT32 k = 1; k < noOfRanges; k++)
+    {
+        vecAxpy(1,pPartial + (k-1)*outSize,pOut,outSize);
+    }
+}
+
+/**
+********************************************************************************
+** @details Calculate the Grammian matrix of a set of vectors. The upper
+**          triangle is calculated and mirrored into the lower triangle.
+** @param   pVecs   Pointer to the vector set, where the elements of vector j
+**                  start at pVecs + j*lda
+** @param   lda     Leading dimension of the vector set
+** @param   m       Dimension of each vector
+** @param   n       Number of vectors
+** @param   pGram   Pointer to the n x n row-major output matrix
+********************************************************************************
+*/
+void grammian(const double* pVecs, const UINT32& lda, const UINT32& m,
+              const UINT32& n, double* pGram)
+{
+    checkGramSet(lda,m,n);
+
+    for (size_t i = 0; i < (size_t)n*n; i++)
+    {
+        pGram[i] = 0;
+    }
+
+    gramUpperParallel(pVecs,lda,m,n,(size_t)n*n,pGram,false);
+
+    for (UINT32 i = 1; i < n; i++)
+    {
+        for (UINT32 j = 0; j < i; j++)
+        {
+            pGram[(size_t)i*n + j] = pGram[(size_t)j*n + i];
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Calculate the Grammian matrix of a set of vectors in packed
+**          symmetric storage, where element (i,j) is found at index
+**          packedIndex(i,j,n)
+** @param   pVecs   Pointer to the vector set, where the elements of vector j
+**                  start at pVecs + j*lda
+** @param   lda     Leading dimension of the vector set
+** @param   m       Dimension of each vector
+** @param   n       Number of vectors
+** @param   pPacked Pointer to the output array of n*(n+1)/2 elements
+********************************************************************************
+*/
+void grammianPacked(const double* pVecs, const UINT32& lda, const UINT32& m,
+                    const UINT32& n, double* pPacked)
+{
+    checkGramSet(lda,m,n);
+
+    for (size_t i = 0; i < (size_t)n*(n+1)/2; i++)
+    {
+        pPacked[i] = 0;
+    }
+
+    gramUpperParallel(pVecs,lda,m,n,(size_t)n*(n+1)/2,pPacked,true);
+}
@@ -43,58 +43,91 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <cstring>
 
 #include "Matrix.hh"
+#include "Gemm.hh"
 #include "Vector.hh"
+#include "VecKernels.hh"
 
 /*-------------------------------[Begin Code]---------------------------------*/
 /*-----------------------------[Matrix Methods]-------------------------------*/
 /**
 ********************************************************************************
 ** @details Matrix class constructor
-** @param   m   Number of rows
-** @param   n   Number of columns
+** @param   m       Number of rows
+** @param   n       Number of columns
+** @param   order   Order of the elements in memory
 ********************************************************************************
 */
-Matrix::Matrix(const UINT32& m, const UINT32& n)
+Matrix::Matrix(const UINT32& m, const UINT32& n, const MatrixLayout& order)
 {
     mrows = m;
     ncols = n;
-    
+    layout = order;
+
     checkSize(mrows,ncols);
-    pMatrix = new double [mrows*ncols];
+    allocate();
 
-    for (UINT32 i = 0; i < mrows*ncols; i++)
-    {
-        pMatrix[i] = 0;
-    }
+    memset(pMatrix,0,getStorageSize()*sizeof(double));
 }
 
 /**
 ********************************************************************************
 ** @details Matrix class constructor
-** @param   data    Array of values to assign to the Matrix object
+** @param   data    Row-major array of values to assign to the Matrix object
 ** @param   m       Number of rows
 ** @param   n       Number of columns
+** @param   order   Order of the elements in memory
 ********************************************************************************
 */
-Matrix::Matrix(const double* data, const UINT32& m, const UINT32& n)
+Matrix::Matrix(const double* data, const UINT32& m, const UINT32& n,
+               const MatrixLayout& order)
 {
     mrows = m;
     ncols = n;
+    layout = order;
 
     checkSize(mrows,ncols);
-    pMatrix = new double [mrows*ncols];
+    allocate();
 
-    for (UINT32 i = 0; i < mrows*ncols; i++)
+    for (UINT32 i = 0; i < mrows; i++)
     {
-        pMatrix[i] = data[i];
+        for (UINT32 j = 0; j < ncols; j++)
+        {
+            at(i,j) = data[(size_t)i*ncols + j];
+        }
     }
 }
 
 /**
 ********************************************************************************
-** @details Matrix copy constructor
+** @details Matrix class constructor that takes ownership of a buffer allocated
+**          with new[] instead of copying its elements. The buffer is used in
+**          place with a leading dimension of n, so its rows are not padded
+**          and keep the alignment new[] gave them.
+** @param   data    Row-major array of values allocated with new[]
+** @param   m       Number of rows
+** @param   n       Number of columns
+********************************************************************************
+*/
+Matrix::Matrix(double* data, const UINT32& m, const UINT32& n, AdoptBuffer)
+{
+    mrows = m;
+    ncols = n;
+    layout = MATRIX_ROW_MAJOR;
+
+    checkSize(mrows,ncols);
+
+    ld = ncols;
+    pRaw = data;
+    pMatrix = data;
+}
+
+/**
+********************************************************************************
+** @details Matrix copy constructor, which keeps the layout of the copied
+**          matrix
 ** @param   rhs Matrix object
 ********************************************************************************
 */
@@ -102,29 +135,105 @@ Matrix::Matrix(const Matrix& rhs)
 {
     mrows = rhs.mrows;
     ncols = rhs.ncols;
-    pMatrix = new double [mrows*ncols];
+    layout = rhs.layout;
+    allocate();
 
-    for (UINT32 i = 0; i < mrows*ncols; i++)
+    if (ld == rhs.ld)
     {
-        pMatrix[i] = rhs.pMatrix[i];
+        memcpy(pMatrix,rhs.pMatrix,getStorageSize()*sizeof(double));
+    }
+    else
+    {
+        view() = rhs.view();
     }
 }
 
 /**
 ********************************************************************************
-** @details Matrix move constructor
+** @details Matrix move constructor. Heap storage is taken over, while arena
+**          storage is copied onto the heap, since the new matrix may outlive
+**          the arena scope.
 ** @param   rhs Matrix object lvalue reference
 ********************************************************************************
 */
 Matrix::Matrix(Matrix&& rhs)
 {
-    pMatrix = rhs.pMatrix;
     mrows = rhs.mrows;
     ncols = rhs.ncols;
+    layout = rhs.layout;
+
+    if (NULL == rhs.pRaw && NULL != rhs.pMatrix)
+    {
+        allocate(false);
+        memcpy(pMatrix,rhs.pMatrix,getStorageSize()*sizeof(double));
+    }
+    else
+    {
+        pRaw = rhs.pRaw;
+        pMatrix = rhs.pMatrix;
+        ld = rhs.ld;
+
+        rhs.pRaw = NULL;
+        rhs.pMatrix = NULL;
+        rhs.mrows = 0;
+        rhs.ncols = 0;
+    }
+}
+
+/**
+********************************************************************************
+** @details Matrix destructor
+********************************************************************************
+*/
+Matrix::~Matrix()
+{
+    release();
+}
+
+/**
+********************************************************************************
+** @details Allocate storage for the matrix, in the current arena if there is
+**          one and useArena is true, and on the heap otherwise. The storage
+**          is aligned to MATRIX_ALIGN and the leading dimension is padded to
+**          keep every row (or column) aligned. Any padding elements are set
+**          to zero.
+********************************************************************************
+*/
+void Matrix::allocate(const bool& useArena)
+{
+    Arena* pArena = useArena ? Arena::current() : NULL;
+
+    UINT32 inner;
+    size_t size;
 
-    rhs.pMatrix = NULL;
-    rhs.mrows = 0;
-    rhs.ncols = 0;
+    inner = (MATRIX_ROW_MAJOR == layout) ? ncols : mrows;
+    ld = padLeadDim(inner);
+    if (ld < inner)
+    {
+        printf("Error - %s\n"
+               "        Matrix dimension %u is too large to pad\n",
+               __PRETTY_FUNCTION__,inner);
+        exit(EXIT_FAILURE);
+    }
+
+    /* getStorageSize() multiplies in size_t, so it cannot overflow */
+    size = getStorageSize();
+
+    if (NULL != pArena)
+    {
+        pRaw = NULL;
+        pMatrix = pArena->allocDoubles(size);
+    }
+    else
+    {
+        pRaw = new double [size + MATRIX_ALIGN/sizeof(double) - 1];
+        pMatrix = alignDoubles(pRaw);
+    }
+
+    if (ld != inner)
+    {
+        memset(pMatrix,0,size*sizeof(double));
+    }
 }
 
 /**
@@ -276,212 +385,52 @@ double Matrix::determinant(void)
 
 /**
 ********************************************************************************
-** @details Calculate the QR decomposition using the Householder Transformation
-**          to return the determinant of a square matrix or the rank of any
-**          matrix
-** @param   decompFlag  Flag indicating if the determinant or rank is returned
-** @param   det         Reference for the determinant, if a square matrix
-** @param   matrixRank  Reference for the rank
+** @details Calculate the rank of the matrix, as rank(), with the scratch
+**          memory of the QR decomposition taken from a workspace instead of
+**          the heap
+** @param   work    Workspace sized for at least the matrix dimensions
+** @return  Rank of the matrix
 ********************************************************************************
 */
-void Matrix::QRdecomp(INT32 decompFlag, double& det, UINT32& matrixRank)
+UINT32 Matrix::rank(QRWorkspace& work)
 {
-    UINT32 n;
-    UINT32 newARows;
-    UINT32 newACols;
-    UINT32 matRank;
+    work.checkFit(mrows,ncols);
 
-    double kVal;
-    double matDet;
-    double subIdent[(mrows-1)*mrows];
-    double vecData[mrows];
+    ArenaScope scope(work.getArena());
 
-    double* pNewA;
-
-    matRank = 0;
-    matDet = 1;
-
-    /*
-    ** Find the smaller matrix dimension
-    */
-    n = MIN(mrows,ncols);
-
-    /*
-    ** If there is only one row or column in the matrix, then look for nonzero
-    ** values. If any are found, then return a rank of 1. If the matrix only has
-    ** one element, then set the determinant equal to that element.
-    */
-    if (1 == n)
-    {
-        for (UINT32 i = 0; i < n; i++)
-        {
-            if (fabs(pMatrix[i]) >= FLOAT_TOL)
-            {
-                matRank++;
-                break;
-            }
-        }
-
-        if (mrows == ncols)
-        {
-            det = pMatrix[0];
-        }
-        matrixRank = matRank;
-
-        return;
-    }
-
-    newARows = mrows;
-    newACols = ncols;
-
-    pNewA = pMatrix;
-
-    /*
-    ** Instantiate an (mrows-1) x mrows identity matrix, which is just an
-    ** mrows x mrows identity matrix without the first row. For each loop
-    ** through the n-1 columns or rows of the matrix object, successive top rows
-    ** and left columns will not be used from this sub identity matrix to form
-    ** the sub matrix of the Householder Transformation matrix.
-    */
-    for (UINT32 i = 0; i < mrows-1; i++)
-    {
-        for (UINT32 j = 0; j < mrows; j++)
-        {
-            if (i+1 == j)
-            {
-                subIdent[i*mrows + j] = 1;
-            }
-            else
-            {
-                subIdent[i*mrows + j] = 0;
-            }
-        }
-    }
-
-    Matrix subIdentity(subIdent,mrows-1,mrows);
-
-    /*
-    ** Loop through the smaller dimension n-1 times if n > 1
-    */
-    for (UINT32 i = 0; i < n-1; i++)
-    {
-        /*
-        ** Store the first column of the A' matrix in a Vector object
-        */
-        for (UINT32 j = 0; j < newARows; j++)
-        {
-            vecData[j] = pNewA[j*newACols];
-        }
-
-        Vector colVec(vecData,newARows);
-
-        /*
-        ** Calculate the vector norm and check if it is considered to be zero
-        */
-        kVal = colVec.mag();
-        if (fabs(kVal) < FLOAT_TOL)
-        {
-            if (mrows == ncols)
-            {
-                matDet = 0;
-            }
-
-            if (MATRIX_DECOMP_DET == decompFlag)
-            {
-                det = matDet;
-                return;
-            }
-
-            /*
-            ** When kVal = 0, then the column vector is already full of zeros
-            ** and the loop will just continue to the next submatrix column
-            */
-            for (UINT32 j = 0; j < newARows-1; j++)
-            {
-                for (UINT32 k = 0; k < newACols-1; k++)
-                {
-                    pNewA[j*(newACols-1) + k] = pNewA[(j+1)*newACols + (k+1)];
-                }
-            }
-            newARows--;
-            newACols--;
-            continue;
-        }
-
-        /*
-        ** Set the correct sign for kVal to avoid numerical instability and
-        ** calculate the elements of the v hat vector. Also calculate the
-        ** determinant for a square matrix and increment the rank counter.
-        */
-        kVal = -sgn(colVec[0])*kVal;
-
-        if (mrows == ncols)
-        {
-            matDet *= kVal;
-        }
-        matRank++;
-
-        vecData[0] = sqrt((kVal - colVec[0])/(2*kVal));
-
-        for (UINT32 j = 1; j < newARows; j++)
-        {
-            vecData[j] = -colVec[j]/(2*kVal*vecData[0]);
-        }
-
-        Vector vHat(vecData,newARows);
-        Vector vHatSub(vecData+1,newARows-1);
-
-        /*
-        ** Form the identity matrix from row 2 to the end and use it to
-        ** calculate the Householder Transformation matrix from row 2 to the end
-        */
-        Matrix newA(pNewA,newARows,newACols);
-        Matrix hhSub(vHatSub.getSize(),vHat.getSize());
-        Matrix identSub(vHatSub.getSize(),vHat.getSize());
-
-        identSub = subIdentity.getSubMatrix(i,i,subIdentity.getRows()-1,
-                                            subIdentity.getCols()-1);
-        hhSub = identSub - 2*vHatSub.outer(vHat);
+    return(rank());
+}
 
-        /*
-        ** Calculate the new A' matrix for the next loop iteration and store the
-        ** matrix data pointer
-        */
-        pNewA = (hhSub*newA.getSubMatrix(0,1,newARows-1,newACols-1)).pMatrix;
-        
-        newARows--;
-        newACols--;
-    }
+/**
+********************************************************************************
+** @details Calculate the determinant of a square matrix, as determinant(),
+**          with the scratch memory of the QR decomposition taken from a
+**          workspace instead of the heap
+** @param   work    Workspace sized for at least the matrix dimensions
+** @return  Determinant of a square matrix
+********************************************************************************
+*/
+double Matrix::determinant(QRWorkspace& work)
+{
+    work.checkFit(mrows,ncols);
 
-    /*
-    ** Evaluate the determinant for a square matrix and the final rank counter
-    */
-    kVal = 0;
-    for (UINT32 i = 0; i < newARows*newACols; i++)
-    {
-        kVal += pNewA[i]*pNewA[i];
-    }
+    ArenaScope scope(work.getArena());
 
-    kVal = sqrt(kVal);
-    if (fabs(kVal) >= FLOAT_TOL)
-    {
-        if (mrows == ncols)
-        {
-            matDet *= pNewA[0];
-            if ((ncols-1) % 2)
-            {
-                matDet *= -1;
-            }
-        }
-        matRank++;
-    }
-    else if (mrows == ncols)
-    {
-        matDet = 0;
-    }
+    return(determinant());
+}
 
-    det = matDet;
-    matrixRank = matRank;
+/**
+********************************************************************************
+** @details Calculate the QR decomposition of the matrix, as
+**          MatrixView::QRdecomp(), on a view of the matrix elements
+** @param   decompFlag  Flag indicating if the determinant or rank is returned
+** @param   det         Reference for the determinant, if a square matrix
+** @param   matrixRank  Reference for the rank
+********************************************************************************
+*/
+void Matrix::QRdecomp(INT32 decompFlag, double& det, UINT32& matrixRank)
+{
+    view().QRdecomp(decompFlag,det,matrixRank);
 }
 
 /**
@@ -494,9 +443,14 @@ void Matrix::QRdecomp(INT32 decompFlag, double& det, UINT32& matrixRank)
 Matrix& Matrix::operator-=(const Matrix& rhs)
 {
     checkEqualSize(mrows,ncols,rhs.mrows,rhs.ncols);
-    for (UINT32 i = 0; i < mrows*ncols; i++)
+
+    if (layout == rhs.layout && ld == rhs.ld)
     {
-        pMatrix[i] -= rhs.pMatrix[i];
+        vecAxpy(-1,rhs.pMatrix,pMatrix,getStorageSize());
+    }
+    else
+    {
+        *this = *this - rhs;
     }
 
     return(*this);
@@ -511,32 +465,16 @@ Matrix& Matrix::operator-=(const Matrix& rhs)
 */
 Matrix& Matrix::operator*=(const double& rhs)
 {
-    for (UINT32 i = 0; i < mrows*ncols; i++)
-    {
-        pMatrix[i] *= rhs;
-    }
+    vecScale(rhs,pMatrix,getStorageSize());
 
     return(*this);
 }
 
 /**
 ********************************************************************************
-** @details Matrix subtraction with another Matrix object
-** @param   rhs Matrix object
-** @return  New Matrix object with subtraction of elements
-********************************************************************************
-*/
-const Matrix Matrix::operator-(const Matrix& rhs) const
-{
-    Matrix result(*this);
-    result -= rhs;
-
-    return(result);
-}
-
-/**
-********************************************************************************
-** @details Matrix A multiplied by a matrix B
+** @details Matrix A multiplied by a matrix B, calculated with the blocked
+**          matrix multiply directly into the new row-major Matrix object. The
+**          operands are read in place in either layout.
 ** @param   rhs Matrix object B
 ** @return  New Matrix object C = A*B
 ********************************************************************************
@@ -544,54 +482,12 @@ const Matrix Matrix::operator-(const Matrix& rhs) const
 const Matrix Matrix::operator*(const Matrix& rhs)
 {
     checkConformable(ncols,rhs.mrows);
-    double multMat[mrows*rhs.ncols];
 
-    for (UINT32 i = 0; i < mrows; i++)
-    {
-        for (UINT32 j = 0; j < rhs.ncols; j++)
-        {
-            multMat[i*rhs.ncols + j] = 0;
+    Matrix multMat(mrows,rhs.ncols);
 
-            for (UINT32 k = 0; k < ncols; k++)
-            {
-                multMat[i*rhs.ncols + j] += pMatrix[i*ncols + k]*
-                                            rhs.pMatrix[k*rhs.ncols + j];
-            }
-        }
-    }
-
-    Matrix result(multMat,mrows,rhs.ncols);
+    gemm(1,view(),rhs.view(),0,multMat.view());
 
-    return(result);
-}
-
-/**
-********************************************************************************
-** @details Double multiplied by a matrix
-** @param   lhs double data type
-** @param   rhs Matrix object
-** @return  New Matrix object with every element multiplied by lhs
-********************************************************************************
-*/
-Matrix operator*(const double& lhs, const Matrix& rhs)
-{
-    Matrix result(rhs);
-    result *= lhs;
-
-    return(result);
-}
-
-/**
-********************************************************************************
-** @details Matrix multiplied by a double
-** @param   lhs Matrix object
-** @param   rhs double data type
-** @return  Matrix object with every element multiplied by rhs
-********************************************************************************
-*/
-Matrix operator*(const Matrix& lhs, const double& rhs)
-{
-    return(rhs*lhs);
+    return(multMat);
 }
 
 /**
@@ -605,7 +501,12 @@ MatrixRow Matrix::operator[](const UINT32& rowInd)
 {
     checkRowInd(rowInd);
 
-    return(MatrixRow(pMatrix + rowInd*ncols,ncols));
+    if (MATRIX_ROW_MAJOR == layout)
+    {
+        return(MatrixRow(pMatrix + (size_t)rowInd*ld,ncols));
+    }
+
+    return(MatrixRow(pMatrix + rowInd,ncols,ld));
 }
 
 /**
@@ -619,9 +520,13 @@ Matrix& Matrix::operator=(const Matrix& rhs)
 {
     checkEqualSize(mrows,ncols,rhs.mrows,rhs.ncols);
 
-    for (UINT32 i = 0; i < mrows*ncols; i++)
+    if (layout == rhs.layout && ld == rhs.ld)
+    {
+        memmove(pMatrix,rhs.pMatrix,getStorageSize()*sizeof(double));
+    }
+    else
     {
-        pMatrix[i] = rhs.pMatrix[i];
+        view() = rhs.view();
     }
 
     return(*this);
@@ -629,22 +534,32 @@ Matrix& Matrix::operator=(const Matrix& rhs)
 
 /**
 ********************************************************************************
-** @details Matrix move assignment operator
+** @details Matrix move assignment operator. Heap storage is taken over,
+**          while arena storage is copied, so the elements of a matrix never
+**          move into an arena scope it may outlive.
 ** @param   rhs Matrix rvalue reference object
 ** @return  Calling object with temporary's values
 ********************************************************************************
 */
 Matrix& Matrix::operator=(Matrix&& rhs)
 {
-    if (this != &rhs)
+    if (NULL == rhs.pRaw && NULL != rhs.pMatrix)
+    {
+        *this = static_cast<const Matrix&>(rhs);
+    }
+    else if (this != &rhs)
     {
         checkEqualSize(mrows,ncols,rhs.mrows,rhs.ncols);
 
-        delete[] pMatrix;
+        release();
+        pRaw = rhs.pRaw;
         pMatrix = rhs.pMatrix;
         mrows = rhs.mrows;
         ncols = rhs.ncols;
+        ld = rhs.ld;
+        layout = rhs.layout;
 
+        rhs.pRaw = NULL;
         rhs.pMatrix = NULL;
         rhs.mrows = 0;
         rhs.ncols = 0;
@@ -663,7 +578,7 @@ void Matrix::objPrint(void) const
 {
     printf("Matrix size: %d x %d\n",mrows,ncols);
 
-    if (1 == mrows*ncols)
+    if (1 == mrows && 1 == ncols)
     {
         printf("Matrix element\n");
     }
@@ -676,7 +591,7 @@ void Matrix::objPrint(void) const
     {
         for (UINT32 j = 0; j < ncols; j++)
         {
-            printf(" %12.3f",pMatrix[i*ncols + j]);
+            printf(" %12.3f",at(i,j));
         }
         printf("\n");
     }
@@ -684,7 +599,8 @@ void Matrix::objPrint(void) const
 
 /**
 ********************************************************************************
-** @details Extract a sub matrix from the current matrix object
+** @details Extract a sub matrix from the current matrix object. Use view() and
+**          MatrixView::block() instead to work on the block without a copy.
 ** @param   startRow    First row index of the matrix to extract (0 indexed)
 ** @param   startCol    First column index of the matrix to extract (0 indexed)
 ** @param   endRow      Last row indes of the matrix to extract (0 indexed)
@@ -698,8 +614,6 @@ Matrix Matrix::getSubMatrix(const UINT32& startRow, const UINT32& startCol,
     UINT32  subMatRows;
     UINT32  subMatCols;
 
-    double* pSubMatrix;
-
     subMatRows = endRow - startRow + 1;
     subMatCols = endCol - startCol + 1;
 
@@ -753,20 +667,26 @@ Matrix Matrix::getSubMatrix(const UINT32& startRow, const UINT32& startCol,
     }
 
     /*
-    ** Extract the sub matrix
+    ** Copy the sub matrix out of a view of the block
     */
-    pSubMatrix = new double [subMatRows*subMatCols];
+    return(Matrix(view().block(startRow,startCol,subMatRows,subMatCols)));
+}
 
-    for (UINT32 i = 0; i < subMatRows; i++)
+/**
+********************************************************************************
+** @details Return a view of the matrix elements. The view is only valid while
+**          the matrix object is alive and not reassigned.
+** @return  View of the matrix in its storage layout
+********************************************************************************
+*/
+MatrixView Matrix::view(void) const
+{
+    if (MATRIX_ROW_MAJOR == layout)
     {
-        for (UINT32 j = 0; j < subMatCols; j++)
-        {
-            pSubMatrix[i*subMatCols + j] =
-                pMatrix[(startRow+i)*ncols + (startCol+j)];
-        }
+        return(MatrixView(pMatrix,mrows,ncols,ld));
     }
 
-    return(Matrix(pSubMatrix,subMatRows,subMatCols));
+    return(MatrixView(pMatrix,mrows,ncols,1,ld));
 }
 
 /**
@@ -791,17 +711,43 @@ UINT32 Matrix::getCols(void) const
     return(ncols);
 }
 
+/**
+********************************************************************************
+** @details Return the order of the matrix elements in memory
+** @return  Layout of the matrix
+********************************************************************************
+*/
+MatrixLayout Matrix::getLayout(void) const
+{
+    return(layout);
+}
+
+/**
+********************************************************************************
+** @details Return the leading dimension of the matrix storage, which is the
+**          distance between rows of a row-major matrix or between columns of
+**          a column-major matrix
+** @return  Padded leading dimension
+********************************************************************************
+*/
+UINT32 Matrix::getLeadDim(void) const
+{
+    return(ld);
+}
+
 /*----------------------------[MatrixRow Methods]-----------------------------*/
 /**
 ********************************************************************************
 ** @details MatrixRow class constructor
 ** @param   rowData Pointer to data in a Matrix row
 ** @param   n       Number of columns in the Matrix row
+** @param   inc     Distance between elements in the Matrix row
 ********************************************************************************
 */
-MatrixRow::MatrixRow(double* rowData,const UINT32& n)
+MatrixRow::MatrixRow(double* rowData, const UINT32& n, const UINT32& inc)
 {
     ncols = n;
+    stride = inc;
     pRow = rowData;
 }
 
@@ -833,5 +779,5 @@ double& MatrixRow::operator[](const UINT32& index)
 {
     checkInd(index);
 
-    return(pRow[index]);
+    return(pRow[(size_t)index*stride]);
 }
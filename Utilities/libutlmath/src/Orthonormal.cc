@@ -0,0 +1,710 @@
+/**
+********************************************************************************
+** @file    Orthonormal.cc
+**
+** @brief   Utility to orthonormalize a set of vectors
+**
+** @details The orthonormalization routines operate in place on a set of
+**          vectors stored in one contiguous, caller-owned block of memory.
+**          The orthonormal basis is returned in the leading vectors of the
+**          block, along with the indices of the input vectors that produced
+**          each basis vector.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Orthonormal.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+
+#include "Orthonormal.hh"
+#include "Arena.hh"
+#include "Gemm.hh"
+#include "Grammian.hh"
+#include "VecKernels.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @details Verify the dimensions of a vector set stored in contiguous memory
+** @param   lda Leading dimension of the vector set
+** @param   m   Dimension of each vector
+** @param   n   Number of vectors
+********************************************************************************
+*/
+static void checkVecSet(const UINT32& lda, const UINT32& m, const UINT32& n)
+{
+    if (m < 1 || n < 1)
+    {
+        printf("Error - %s\n"
+               "        Vector set of %u vectors with dimension %u\n",
+               __PRETTY_FUNCTION__,n,m);
+        exit(EXIT_FAILURE);
+    }
+    else if (lda < m)
+    {
+        printf("Error - %s\n"
+               "        Leading dimension (%u) is less than the vector\n"
+               "        dimension (%u)\n",
+               __PRETTY_FUNCTION__,lda,m);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+********************************************************************************
+** @details Verify the rank of a vector set does not exceed its size
+** @param   setRank Rank of the vector set
+** @param   m       Dimension of each vector
+** @param   n       Number of vectors
+********************************************************************************
+*/
+static void checkRank(const UINT32& setRank, const UINT32& m, const UINT32& n)
+{
+    if (setRank > n || setRank > m)
+    {
+        printf("Error - %s\n"
+               "        Rank (%u) exceeds the size of a %u x %u vector set\n",
+               __PRETTY_FUNCTION__,setRank,m,n);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+********************************************************************************
+** @details Run the Modified Gram-Schmidt algorithm over a range of vectors in
+**          the set. Each vector in the range is accepted as a new basis vector
+**          if its remaining magnitude is at least FLOAT_TOL, in which case it
+**          is normalized, moved into the next basis slot, and its component is
+**          removed from every vector left in the range. Vectors before the
+**          range must already be orthogonal to the vectors in the range. When
+**          the rank overstates the vectors left that are independent to
+**          FLOAT_TOL, the range ends with vecsToGo above zero.
+**
+**          The subtraction also sums the squares of the updated vector, so the
+**          magnitude of every vector after the first is known when it is
+**          reached and only one pass over memory is made per vector pair.
+** @param   pVecs       Pointer to the vector set
+** @param   lda         Leading dimension of the vector set
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors in the set
+** @param   first       Index of the first vector in the range
+** @param   count       Number of vectors in the range
+** @param   vecsToGo    Number of basis vectors still to be found
+** @param   noOfBasis   Number of basis vectors found so far
+** @param   pOrthVecInd Array that receives the input index of each basis vector
+********************************************************************************
+*/
+static void mgsRange(double* pVecs, const UINT32& lda, const UINT32& m,
+                     const UINT32& n, const UINT32& first, const UINT32& count,
+                     UINT32& vecsToGo, UINT32& noOfBasis,
+                     UINT32* pOrthVecInd)
+{
+    UINT32 last;
+
+    double vecMag;
+
+    double* pVec;
+    double* pBasis;
+    double* pNext;
+    double* pSumSq;
+
+    last = first + count;
+
+    /*
+    ** Squared magnitude of each vector in the range, or a negative value until
+    ** it is known
+    */
+    ArenaArray sumSq(count);
+
+    pSumSq = sumSq.get();
+    for (UINT32 j = 0; j < count; j++)
+    {
+        pSumSq[j] = -1;
+    }
+
+    for (UINT32 i = first; i < last && vecsToGo > 0; i++)
+    {
+        pVec = pVecs + (size_t)i*lda;
+
+        /*
+        ** The components of all previous basis vectors were already removed
+        ** from the current vector, so only its magnitude is needed to decide
+        ** if it adds a new direction to the basis
+        */
+        if (pSumSq[i-first] < 0)
+        {
+            vecMag = vecNorm(pVec,m);
+        }
+        else
+        {
+            vecMag = sqrt(pSumSq[i-first]);
+        }
+
+        if (vecMag < FLOAT_TOL)
+        {
+            continue;
+        }
+
+        /*
+        ** Normalize the vector and move it into the next basis slot. Every
+        ** slot before the current vector has already been processed, so it is
+        ** safe to overwrite.
+        */
+        pBasis = pVecs + (size_t)noOfBasis*lda;
+        if (pBasis != pVec)
+        {
+            memcpy(pBasis,pVec,m*sizeof(double));
+        }
+        vecScale(1/vecMag,pBasis,m);
+
+        pOrthVecInd[noOfBasis] = i;
+        noOfBasis++;
+        vecsToGo--;
+
+        /*
+        ** Subtract the new basis vector component from every vector still left
+        ** in the range
+        */
+        for (UINT32 j = i+1; j < last && vecsToGo > 0; j++)
+        {
+            pNext = pVecs + (size_t)j*lda;
+
+            pSumSq[j-first] = vecProjectOut(pBasis,pNext,m);
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Remove the components of the basis vectors from a panel of vectors
+**          with the block classical Gram-Schmidt projection P = P - Q*(Q'*P),
+**          applied twice to restore the orthogonality lost to rounding. Both
+**          products are calculated with the blocked matrix multiply. The
+**          vector set is stored as the transpose of the matrices Q and P, so
+**          C = Q'*P is calculated as Qt*Pt' and the update as Pt = Pt - C'*Qt.
+** @param   pVecs       Pointer to the vector set, holding the basis vectors
+**                      in its leading vectors
+** @param   lda         Leading dimension of the vector set
+** @param   m           Dimension of each vector
+** @param   noOfBasis   Number of basis vectors
+** @param   pPanel      Pointer to the first vector of the panel
+** @param   panelSize   Number of vectors in the panel
+** @param   pCoef       Workspace of at least noOfBasis*panelSize elements
+********************************************************************************
+*/
+static void projectPanel(const double* pVecs, const UINT32& lda,
+                         const UINT32& m, const UINT32& noOfBasis,
+                         double* pPanel, const UINT32& panelSize,
+                         double* pCoef)
+{
+    for (UINT32 pass = 0; pass < 2; pass++)
+    {
+        gemm(GEMM_NO_TRANS,GEMM_TRANS,noOfBasis,panelSize,m,1,pVecs,lda,pPanel,
+             lda,0,pCoef,panelSize);
+
+        gemm(GEMM_TRANS,GEMM_NO_TRANS,panelSize,m,noOfBasis,-1,pCoef,
+             panelSize,pVecs,lda,1,pPanel,lda);
+    }
+}
+
+/**
+********************************************************************************
+** @details Factor a symmetric positive definite matrix in place with the
+**          Cholesky decomposition G = R'*R. Only the upper triangle of the
+**          matrix is read, and it is overwritten by the upper triangular
+**          factor R. Pivot j of the factorization is the squared magnitude of
+**          vector j outside the span of the vectors before it, so the
+**          factorization fails when a pivot is less than FLOAT_TOL relative to
+**          the diagonal element, or the remaining magnitude is less than
+**          FLOAT_TOL.
+** @param   pGram   Pointer to the n x n row-major matrix
+** @param   n       Number of rows and columns
+** @return  true if the factorization succeeded
+********************************************************************************
+*/
+static bool choleskyUpper(double* pGram, const UINT32& n)
+{
+    double pivot;
+    double sum;
+
+    for (UINT32 j = 0; j < n; j++)
+    {
+        pivot = pGram[j*n + j];
+        for (UINT32 k = 0; k < j; k++)
+        {
+            pivot -= pGram[k*n + j]*pGram[k*n + j];
+        }
+
+        if (pivot <= FLOAT_TOL*pGram[j*n + j] || sqrt(pivot) < FLOAT_TOL)
+        {
+            return(false);
+        }
+
+        pGram[j*n + j] = sqrt(pivot);
+
+        for (UINT32 i = j+1; i < n; i++)
+        {
+            sum = pGram[j*n + i];
+            for (UINT32 k = 0; k < j; k++)
+            {
+                sum -= pGram[k*n + j]*pGram[k*n + i];
+            }
+            pGram[j*n + i] = sum/pGram[j*n + j];
+        }
+    }
+
+    return(true);
+}
+
+/**
+********************************************************************************
+** @details Solve Q*R = V in place for Q, where the columns of V are the
+**          vectors of the set and R is an upper triangular matrix. Vector j of
+**          the result is q_j = (v_j - sum(R(k,j)*q_k, k < j))/R(j,j). The rows
+**          are processed in blocks, so the vectors already solved in a block
+**          are reused from cache.
+** @param   pVecs   Pointer to the vector set
+** @param   lda     Leading dimension of the vector set
+** @param   m       Dimension of each vector
+** @param   n       Number of vectors
+** @param   pR      Pointer to the n x n row-major upper triangular matrix
+********************************************************************************
+*/
+static void solveUpper(double* pVecs, const UINT32& lda, const UINT32& m,
+                       const UINT32& n, const double* pR)
+{
+    const UINT32 rowBlock = 256;
+
+    UINT32 rows;
+
+    double* pVec;
+
+    for (UINT32 r = 0; r < m; r += rowBlock)
+    {
+        rows = MIN(rowBlock,m-r);
+
+        for (UINT32 j = 0; j < n; j++)
+        {
+            pVec = pVecs + (size_t)j*lda + r;
+
+            for (UINT32 k = 0; k < j; k++)
+            {
+                vecAxpy(-pR[k*n + j],pVecs + (size_t)k*lda + r,pVec,rows);
+            }
+            vecScale(1/pR[j*n + j],pVec,rows);
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize a set of vectors in place with the Modified
+**          Gram-Schmidt algorithm. Each accepted vector is normalized and its
+**          component is immediately removed from every vector still left. A
+**          vector is rejected when its remaining magnitude is less than
+**          FLOAT_TOL, and the algorithm ends once setRank vectors are found.
+**          A set that is numerically dependent to FLOAT_TOL can give fewer
+**          basis vectors than a rank estimated from its Grammian, in which
+**          case the basis found is returned.
+**
+**          On return, the first setRank vectors of the set hold the orthonormal
+**          basis and the remaining vectors are left in an unspecified state.
+** @param   pVecs       Pointer to the vector set
+** @param   lda         Leading dimension of the vector set
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors
+** @param   setRank     Rank of the vector set, such as the rank of its
+**                      Grammian matrix
+** @param   pOrthVecInd Array of at least setRank elements that receives the
+**                      index of the input vector of each basis vector
+** @return  Number of orthonormal basis vectors, which is less than setRank
+**          when fewer than setRank vectors of the set are independent to
+**          FLOAT_TOL
+********************************************************************************
+*/
+UINT32 orthonormalize(double* pVecs, const UINT32& lda, const UINT32& m,
+                      const UINT32& n, const UINT32& setRank,
+                      UINT32* pOrthVecInd)
+{
+    UINT32 vecsToGo;
+    UINT32 noOfBasis;
+
+    checkVecSet(lda,m,n);
+    checkRank(setRank,m,n);
+
+    vecsToGo = setRank;
+    noOfBasis = 0;
+
+    mgsRange(pVecs,lda,m,n,0,n,vecsToGo,noOfBasis,pOrthVecInd);
+
+    return(noOfBasis);
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize a set of vectors in place with the Modified
+**          Gram-Schmidt algorithm, as orthonormalize(), with the scratch memory
+**          taken from a workspace instead of the heap
+** @param   pVecs       Pointer to the vector set
+** @param   lda         Leading dimension of the vector set
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors
+** @param   setRank     Rank of the vector set
+** @param   pOrthVecInd Array of at least setRank elements that receives the
+**                      index of the input vector of each basis vector
+** @param   work        Workspace sized for at least m x n
+** @return  Number of orthonormal basis vectors, which is less than setRank
+**          when fewer than setRank vectors of the set are independent to
+**          FLOAT_TOL
+********************************************************************************
+*/
+UINT32 orthonormalize(double* pVecs, const UINT32& lda, const UINT32& m,
+                      const UINT32& n, const UINT32& setRank,
+                      UINT32* pOrthVecInd, GramSchmidtWorkspace& work)
+{
+    work.checkFit(m,n);
+
+    ArenaScope scope(work.getArena());
+
+    return(orthonormalize(pVecs,lda,m,n,setRank,pOrthVecInd));
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize the columns of a matrix view in place with the
+**          Modified Gram-Schmidt algorithm, as orthonormalize(). The view must
+**          have contiguous columns, so a vector set stored by rows in a Matrix
+**          object is passed as the transpose of its view.
+** @param   vecs        m x n view whose columns are the vector set
+** @param   setRank     Rank of the vector set
+** @param   pOrthVecInd Array of at least setRank elements that receives the
+**                      index of the input vector of each basis vector
+** @return  Number of orthonormal basis vectors, which is less than setRank
+**          when fewer than setRank vectors of the set are independent to
+**          FLOAT_TOL
+********************************************************************************
+*/
+UINT32 orthonormalize(const MatrixView& vecs, const UINT32& setRank,
+                      UINT32* pOrthVecInd)
+{
+    if (1 != vecs.getRowStride())
+    {
+        printf("Error - %s\n"
+               "        The columns of the view must be contiguous\n",
+               __PRETTY_FUNCTION__);
+        exit(EXIT_FAILURE);
+    }
+
+    return(orthonormalize(vecs.getData(),vecs.getColStride(),vecs.getRows(),
+                          vecs.getCols(),setRank,pOrthVecInd));
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize a set of vectors in place with the block
+**          Gram-Schmidt algorithm. The set is split into panels of blockSize
+**          vectors. The components of all previous basis vectors are removed
+**          from a panel with matrix-matrix products, and the Modified
+**          Gram-Schmidt algorithm then finishes the vectors within the panel.
+**          Most of the work is done in the panel products, which run out of
+**          cache, instead of in one pass over the whole set per vector.
+**
+**          The returned basis and indices are the same as orthonormalize().
+** @param   pVecs       Pointer to the vector set
+** @param   lda         Leading dimension of the vector set
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors
+** @param   setRank     Rank of the vector set, such as the rank of its
+**                      Grammian matrix
+** @param   blockSize   Number of vectors in each panel
+** @param   pOrthVecInd Array of at least setRank elements that receives the
+**                      index of the input vector of each basis vector
+** @return  Number of orthonormal basis vectors, which is less than setRank
+**          when fewer than setRank vectors of the set are independent to
+**          FLOAT_TOL
+********************************************************************************
+*/
+UINT32 orthonormalizeBlocked(double* pVecs, const UINT32& lda, const UINT32& m,
+                             const UINT32& n, const UINT32& setRank,
+                             const UINT32& blockSize, UINT32* pOrthVecInd)
+{
+    UINT32 vecsToGo;
+    UINT32 noOfBasis;
+    UINT32 panelSize;
+
+    double* pCoef;
+
+    checkVecSet(lda,m,n);
+    checkRank(setRank,m,n);
+    if (blockSize < 1)
+    {
+        printf("Error - %s\n"
+               "        Block size must be greater than zero\n",
+               __PRETTY_FUNCTION__);
+        exit(EXIT_FAILURE);
+    }
+
+    vecsToGo = setRank;
+    noOfBasis = 0;
+
+    ArenaArray coef((size_t)setRank*blockSize + 1);
+
+    pCoef = coef.get();
+
+    for (UINT32 first = 0; first < n && vecsToGo > 0; first += blockSize)
+    {
+        panelSize = MIN(blockSize,n-first);
+
+        if (noOfBasis > 0)
+        {
+            projectPanel(pVecs,lda,m,noOfBasis,pVecs + (size_t)first*lda,
+                         panelSize,pCoef);
+        }
+
+        mgsRange(pVecs,lda,m,n,first,panelSize,vecsToGo,noOfBasis,
+                 pOrthVecInd);
+    }
+
+    return(noOfBasis);
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize a set of vectors in place with the CholeskyQR2
+**          algorithm. The Grammian G = V'*V of the set is factored as R'*R and
+**          the basis is found from the triangular solve Q = V*inv(R). The
+**          Grammian of Q is then calculated and the factor and solve are
+**          repeated once, which restores the orthogonality lost to the
+**          squared condition number of the Grammian. The work is made up of
+**          inner products and triangular solves instead of the long chain of
+**          dependent projections in the Modified Gram-Schmidt algorithm.
+**
+**          The Cholesky factorization only exists for a set of linearly
+**          independent vectors. When setRank is less than n, or a Cholesky
+**          pivot shows the set is rank deficient or too ill conditioned, the
+**          set is orthonormalized with the Modified Gram-Schmidt algorithm
+**          instead. Each solve replaces vector j with a combination of vectors
+**          0 to j, so the set keeps the span of its leading vectors and the
+**          fall back gives the same basis indices as orthonormalize().
+** @param   pVecs       Pointer to the vector set
+** @param   lda         Leading dimension of the vector set
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors
+** @param   pGram       Pointer to the n x n row-major Grammian of the set,
+**                      where element (i,j) is the inner product of vectors i
+**                      and j. Only the upper triangle is read.
+** @param   setRank     Rank of the vector set, such as the rank of its
+**                      Grammian matrix
+** @param   pOrthVecInd Array of at least setRank elements that receives the
+**                      index of the input vector of each basis vector
+** @return  Number of orthonormal basis vectors, which is less than setRank
+**          when fewer than setRank vectors of the set are independent to
+**          FLOAT_TOL
+********************************************************************************
+*/
+UINT32 orthonormalizeCholQR2(double* pVecs, const UINT32& lda, const UINT32& m,
+                             const UINT32& n, const double* pGram,
+                             const UINT32& setRank, UINT32* pOrthVecInd)
+{
+    double* pR;
+
+    checkVecSet(lda,m,n);
+    checkRank(setRank,m,n);
+
+    if (setRank < n)
+    {
+        return(orthonormalize(pVecs,lda,m,n,setRank,pOrthVecInd));
+    }
+
+    ArenaArray rFactor((size_t)n*n);
+
+    pR = rFactor.get();
+    memcpy(pR,pGram,(size_t)n*n*sizeof(double));
+
+    for (UINT32 pass = 0; pass < 2; pass++)
+    {
+        if (pass > 0)
+        {
+            /*
+            ** Grammian of the first pass result
+            */
+            grammian(pVecs,lda,m,n,pR);
+        }
+
+        if (!choleskyUpper(pR,n))
+        {
+            return(orthonormalize(pVecs,lda,m,n,setRank,pOrthVecInd));
+        }
+
+        solveUpper(pVecs,lda,m,n,pR);
+    }
+
+    for (UINT32 j = 0; j < n; j++)
+    {
+        pOrthVecInd[j] = j;
+    }
+
+    return(n);
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize a set of vectors in place with the Modified
+**          Gram-Schmidt algorithm and column pivoting, which also reveals the
+**          rank of the set. At each step the remaining vector with the largest
+**          magnitude is swapped into the next basis slot, normalized, and its
+**          component is removed from every vector after it. The projection
+**          returns the new magnitude of each vector, so the pivot search needs
+**          no extra pass over memory. The algorithm ends when the largest
+**          remaining magnitude is less than FLOAT_TOL, so no Grammian matrix
+**          or separate rank calculation is needed.
+**
+**          On return, the first rank vectors of the set hold the orthonormal
+**          basis and the remaining vectors hold the components of the other
+**          input vectors outside the basis.
+** @param   pVecs   Pointer to the vector set
+** @param   lda     Leading dimension of the vector set
+** @param   m       Dimension of each vector
+** @param   n       Number of vectors
+** @param   pPerm   Array of n elements that receives the permutation of the
+**                  set, where pPerm[k] is the index of the input vector now
+**                  stored in slot k. The first rank elements are the input
+**                  indices of the basis vectors.
+** @return  Rank of the vector set, which is the number of basis vectors
+********************************************************************************
+*/
+UINT32 orthonormalizePivoted(double* pVecs, const UINT32& lda, const UINT32& m,
+                             const UINT32& n, UINT32* pPerm)
+{
+    UINT32 rank;
+    UINT32 pivot;
+    UINT32 tempInd;
+
+    double tempVal;
+
+    double* pBasis;
+    double* pPivot;
+    double* pSumSq;
+
+    checkVecSet(lda,m,n);
+
+    ArenaArray sumSq(n);
+
+    pSumSq = sumSq.get();
+    for (UINT32 j = 0; j < n; j++)
+    {
+        pPerm[j] = j;
+        pSumSq[j] = vecKernelTable.sumSq(pVecs + (size_t)j*lda,m);
+    }
+
+    for (rank = 0; rank < n && rank < m; rank++)
+    {
+        /*
+        ** Find the remaining vector with the largest magnitude
+        */
+        pivot = rank;
+        for (UINT32 j = rank+1; j < n; j++)
+        {
+            if (pSumSq[j] > pSumSq[pivot])
+            {
+                pivot = j;
+            }
+        }
+
+        if (sqrt(pSumSq[pivot]) < FLOAT_TOL)
+        {
+            break;
+        }
+
+        /*
+        ** Swap the pivot vector into the next basis slot
+        */
+        pBasis = pVecs + (size_t)rank*lda;
+        if (pivot != rank)
+        {
+            pPivot = pVecs + (size_t)pivot*lda;
+            for (UINT32 i = 0; i < m; i++)
+            {
+                tempVal = pBasis[i];
+                pBasis[i] = pPivot[i];
+                pPivot[i] = tempVal;
+            }
+
+            tempInd = pPerm[rank];
+            pPerm[rank] = pPerm[pivot];
+            pPerm[pivot] = tempInd;
+
+            tempVal = pSumSq[rank];
+            pSumSq[rank] = pSumSq[pivot];
+            pSumSq[pivot] = tempVal;
+        }
+
+        vecScale(1/sqrt(pSumSq[rank]),pBasis,m);
+
+        /*
+        ** Subtract the new basis vector component from every remaining vector
+        */
+        for (UINT32 j = rank+1; j < n; j++)
+        {
+            pSumSq[j] = vecProjectOut(pBasis,pVecs + (size_t)j*lda,m);
+        }
+    }
+
+    return(rank);
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize a set of vectors in place with the column pivoted
+**          Modified Gram-Schmidt algorithm, as orthonormalizePivoted(), with
+**          the scratch memory taken from a workspace instead of the heap
+** @param   pVecs   Pointer to the vector set
+** @param   lda     Leading dimension of the vector set
+** @param   m       Dimension of each vector
+** @param   n       Number of vectors
+** @param   pPerm   Array of n elements that receives the permutation of the set
+** @param   work    Workspace sized for at least m x n
+** @return  Rank of the vector set
+********************************************************************************
+*/
+UINT32 orthonormalizePivoted(double* pVecs, const UINT32& lda, const UINT32& m,
+                             const UINT32& n, UINT32* pPerm,
+                             GramSchmidtWorkspace& work)
+{
+    work.checkFit(m,n);
+
+    ArenaScope scope(work.getArena());
+
+    return(orthonormalizePivoted(pVecs,lda,m,n,pPerm));
+}
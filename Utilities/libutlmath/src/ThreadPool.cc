@@ -0,0 +1,527 @@
+/**
+********************************************************************************
+** @file    ThreadPool.cc
+**
+** @brief   Shared work-stealing thread pool
+**
+** @details The worker threads sleep on a condition variable when every queue
+**          is empty. A thread that submits a parallel loop does not sleep; it
+**          runs tasks from the queues until every task of its loop has
+**          finished, so nested loops cannot leave all threads waiting.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  ThreadPool.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+
+#include "ThreadPool.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @def   POOL_QUEUE_SIZE
+** @brief Initial number of tasks each worker queue can hold
+********************************************************************************
+*/
+#define POOL_QUEUE_SIZE 64
+
+/*
+** Index of the worker queue owned by the current thread, or -1 if the thread
+** is not a worker
+*/
+static thread_local INT32 workerIndex = -1;
+
+/**
+********************************************************************************
+** @details ThreadPool class constructor. One thread is started for every
+**          hardware thread after the first, which is the calling thread.
+********************************************************************************
+*/
+ThreadPool::ThreadPool()
+{
+    noOfWorkers = 0;
+    pinThreads = false;
+    pWorkers = NULL;
+    pQueues = NULL;
+
+    queuedTasks = 0;
+    nextQueue = 0;
+    stopWorkers = false;
+
+    setThreadCount(0);
+}
+
+/**
+********************************************************************************
+** @details ThreadPool class destructor
+********************************************************************************
+*/
+ThreadPool::~ThreadPool()
+{
+    stopAllWorkers();
+}
+
+/**
+********************************************************************************
+** @details Return the thread pool shared by the library, creating it on the
+**          first call
+** @return  Shared ThreadPool object
+********************************************************************************
+*/
+ThreadPool& ThreadPool::instance(void)
+{
+    static ThreadPool pool;
+
+    return(pool);
+}
+
+/**
+********************************************************************************
+** @details Set the number of threads that run parallel loops. The calling
+**          thread of a parallel loop always helps, so n - 1 worker threads are
+**          started. This must not be called while a parallel loop is running.
+** @param   n   Number of threads, or zero for one per hardware thread
+********************************************************************************
+*/
+void ThreadPool::setThreadCount(const UINT32& n)
+{
+    UINT32 threads = n;
+
+    if (0 == threads)
+    {
+        threads = std::thread::hardware_concurrency();
+        if (0 == threads)
+        {
+            threads = 1;
+        }
+    }
+
+    stopAllWorkers();
+    startWorkers(threads - 1);
+}
+
+/**
+********************************************************************************
+** @details Return the number of threads that run parallel loops, including
+**          the calling thread
+** @return  Number of threads
+********************************************************************************
+*/
+UINT32 ThreadPool::getThreadCount(void) const
+{
+    return(noOfWorkers + 1);
+}
+
+/**
+********************************************************************************
+** @details Pin each worker thread to its own core, in the order of the cores
+**          the process is allowed to run on. The first core is left for the
+**          calling thread. Unpinned workers may run on any allowed core.
+** @param   pin Pin the workers if true, otherwise release them
+********************************************************************************
+*/
+void ThreadPool::setPinning(const bool& pin)
+{
+    pinThreads = pin;
+
+    for (UINT32 i = 0; i < noOfWorkers; i++)
+    {
+        pinWorker(i);
+    }
+}
+
+/**
+********************************************************************************
+** @details Apply the pinning setting to one worker thread
+** @param   index   Worker index
+********************************************************************************
+*/
+void ThreadPool::pinWorker(const UINT32& index)
+{
+    UINT32 noOfCpus;
+    UINT32 target;
+
+    cpu_set_t allowed;
+    cpu_set_t cpuSet;
+
+    if (sched_getaffinity(0,sizeof(allowed),&allowed) != 0)
+    {
+        return;
+    }
+
+    CPU_ZERO(&cpuSet);
+    if (pinThreads)
+    {
+        /*
+        ** Find the allowed core for this worker, wrapping around when there
+        ** are more workers than cores
+        */
+        noOfCpus = CPU_COUNT(&allowed);
+        target = (index + 1)%noOfCpus;
+
+        for (UINT32 cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu,&allowed))
+            {
+                if (0 == target)
+                {
+                    CPU_SET(cpu,&cpuSet);
+                    break;
+                }
+                target--;
+            }
+        }
+    }
+    else
+    {
+        memcpy(&cpuSet,&allowed,sizeof(cpuSet));
+    }
+
+    pthread_setaffinity_np(pWorkers[index].native_handle(),sizeof(cpuSet),
+                           &cpuSet);
+}
+
+/**
+********************************************************************************
+** @details Create the worker queues and start the worker threads
+** @param   n   Number of worker threads
+********************************************************************************
+*/
+void ThreadPool::startWorkers(const UINT32& n)
+{
+    noOfWorkers = n;
+    stopWorkers = false;
+
+    if (0 == noOfWorkers)
+    {
+        return;
+    }
+
+    pQueues = new WorkQueue [noOfWorkers];
+    for (UINT32 i = 0; i < noOfWorkers; i++)
+    {
+        pQueues[i].pTasks = new PoolTask [POOL_QUEUE_SIZE];
+        pQueues[i].head = 0;
+        pQueues[i].count = 0;
+        pQueues[i].capacity = POOL_QUEUE_SIZE;
+    }
+
+    pWorkers = new std::thread [noOfWorkers];
+    for (UINT32 i = 0; i < noOfWorkers; i++)
+    {
+        pWorkers[i] = std::thread(&ThreadPool::workerLoop,this,i);
+        if (pinThreads)
+        {
+            pinWorker(i);
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Stop and join the worker threads and free the worker queues
+********************************************************************************
+*/
+void ThreadPool::stopAllWorkers(void)
+{
+    if (0 == noOfWorkers)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopWorkers = true;
+    }
+    sleepCond.notify_all();
+
+    for (UINT32 i = 0; i < noOfWorkers; i++)
+    {
+        pWorkers[i].join();
+        delete[] pQueues[i].pTasks;
+    }
+
+    delete[] pWorkers;
+    delete[] pQueues;
+
+    pWorkers = NULL;
+    pQueues = NULL;
+    noOfWorkers = 0;
+}
+
+/**
+********************************************************************************
+** @details Add a task to the newest end of a worker queue and wake an idle
+**          worker, growing the queue if it is full
+** @param   queue   Index of the worker queue
+** @param   task    Task to add
+********************************************************************************
+*/
+void ThreadPool::pushTask(const UINT32& queue, const PoolTask& task)
+{
+    PoolTask* pNewTasks;
+
+    WorkQueue& q = pQueues[queue];
+
+    {
+        std::lock_guard<std::mutex> guard(q.lock);
+
+        if (q.count == q.capacity)
+        {
+            pNewTasks = new PoolTask [2*q.capacity];
+            for (UINT32 i = 0; i < q.count; i++)
+            {
+                pNewTasks[i] = q.pTasks[(q.head + i)%q.capacity];
+            }
+
+            delete[] q.pTasks;
+            q.pTasks = pNewTasks;
+            q.head = 0;
+            q.capacity *= 2;
+        }
+
+        q.pTasks[(q.head + q.count)%q.capacity] = task;
+        q.count++;
+        queuedTasks++;
+    }
+
+    /*
+    ** The count is raised before the sleep lock is taken, so a worker either
+    ** sees the new task before it waits or is woken by the notify
+    */
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+    }
+    sleepCond.notify_one();
+}
+
+/**
+********************************************************************************
+** @details Remove the newest task from a worker queue
+** @param   queue   Index of the worker queue
+** @param   task    Task removed from the queue
+** @return  true if a task was removed
+********************************************************************************
+*/
+bool ThreadPool::popTask(const UINT32& queue, PoolTask& task)
+{
+    WorkQueue& q = pQueues[queue];
+
+    std::lock_guard<std::mutex> guard(q.lock);
+
+    if (0 == q.count)
+    {
+        return(false);
+    }
+
+    q.count--;
+    task = q.pTasks[(q.head + q.count)%q.capacity];
+    queuedTasks--;
+
+    return(true);
+}
+
+/**
+********************************************************************************
+** @details Remove the oldest task from the first other worker queue that has
+**          one, starting after the queue of the thief. The oldest task is
+**          usually the largest piece of work left in the queue.
+** @param   thief   Index of the stealing worker, or noOfWorkers for a thread
+**                  that is not a worker
+** @param   task    Task removed from a queue
+** @return  true if a task was removed
+********************************************************************************
+*/
+bool ThreadPool::stealTask(const UINT32& thief, PoolTask& task)
+{
+    UINT32 queue;
+
+    for (UINT32 i = 1; i <= noOfWorkers; i++)
+    {
+        queue = (thief + i)%noOfWorkers;
+
+        WorkQueue& q = pQueues[queue];
+        std::lock_guard<std::mutex> guard(q.lock);
+
+        if (q.count > 0)
+        {
+            task = q.pTasks[q.head];
+            q.head = (q.head + 1)%q.capacity;
+            q.count--;
+            queuedTasks--;
+
+            return(true);
+        }
+    }
+
+    return(false);
+}
+
+/**
+********************************************************************************
+** @details Run a task and mark it as finished. The last piece of a loop wakes
+**          the thread that submitted it.
+** @param   task    Task to run
+********************************************************************************
+*/
+void ThreadPool::runTask(const PoolTask& task)
+{
+    PoolLoop* pLoop = task.pLoop;
+
+    (*task.pBody)(task.begin,task.end);
+
+    if (1 == pLoop->pending--)
+    {
+        std::lock_guard<std::mutex> guard(pLoop->lock);
+        pLoop->finished = true;
+        pLoop->done.notify_all();
+    }
+}
+
+/**
+********************************************************************************
+** @details Worker thread loop. Tasks are taken from the worker queue first,
+**          then stolen from the other queues, and the worker sleeps when every
+**          queue is empty.
+** @param   index   Worker index
+********************************************************************************
+*/
+void ThreadPool::workerLoop(const UINT32& index)
+{
+    PoolTask task;
+
+    workerIndex = index;
+
+    while (!stopWorkers)
+    {
+        if (popTask(index,task) || stealTask(index,task))
+        {
+            runTask(task);
+        }
+        else
+        {
+            std::unique_lock<std::mutex> guard(sleepLock);
+            sleepCond.wait(guard,
+                           [this]{return(stopWorkers || queuedTasks > 0);});
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Run a loop body over a range of indices in parallel. The range is
+**          split into pieces of grain indices, and body(first,last) is called
+**          once for each piece [first,last). Pieces submitted from outside the
+**          pool are spread over the worker queues, and pieces submitted from a
+**          worker go to its own queue. The calling thread runs tasks while
+**          pieces of the loop are left and there are tasks to take, and then
+**          sleeps until the last piece running on another thread finishes. A
+**          range of one piece, or a pool with one thread, runs on the calling
+**          thread without any queue operations.
+** @param   begin   First loop index
+** @param   end     One past the last loop index
+** @param   grain   Number of indices in each piece
+** @param   body    Loop body, which may run on any thread
+********************************************************************************
+*/
+void ThreadPool::parallelFor(const UINT32& begin, const UINT32& end,
+                             const UINT32& grain,
+                             const std::function<void(UINT32,UINT32)>& body)
+{
+    UINT32 step;
+    UINT32 noOfPieces;
+    UINT32 self;
+
+    PoolLoop loop;
+    PoolTask task;
+
+    if (end <= begin)
+    {
+        return;
+    }
+
+    step = (grain > 0) ? grain : 1;
+    noOfPieces = (end - begin - 1)/step + 1;
+
+    if (1 == noOfPieces || 0 == noOfWorkers)
+    {
+        body(begin,end);
+        return;
+    }
+
+    loop.pending = noOfPieces;
+    loop.finished = false;
+    self = (workerIndex >= 0) ? (UINT32)workerIndex : noOfWorkers;
+
+    task.pBody = &body;
+    task.pLoop = &loop;
+
+    for (UINT32 first = begin; first < end; first += step)
+    {
+        task.begin = first;
+        task.end = (end - first > step) ? first + step : end;
+
+        if (self < noOfWorkers)
+        {
+            pushTask(self,task);
+        }
+        else
+        {
+            pushTask(nextQueue++%noOfWorkers,task);
+        }
+
+        if (task.end == end)
+        {
+            break;
+        }
+    }
+
+    /*
+    ** Help with the queued work while pieces of this loop are left. A worker
+    ** starts with its own queue, where the pieces of this loop are. Once there
+    ** is nothing to take, the remaining pieces are running on other threads,
+    ** so sleep until the last of them finishes instead of spinning.
+    */
+    while (loop.pending > 0 &&
+           ((self < noOfWorkers && popTask(self,task)) ||
+            stealTask(self,task)))
+    {
+        runTask(task);
+    }
+
+    std::unique_lock<std::mutex> guard(loop.lock);
+    loop.done.wait(guard,[&loop]{return(loop.finished);});
+}
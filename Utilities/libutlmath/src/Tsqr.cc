@@ -0,0 +1,590 @@
+/**
+********************************************************************************
+** @file    Tsqr.cc
+**
+** @brief   Utility to orthonormalize a tall and skinny set of vectors in
+**          parallel
+**
+** @details The vectors of the set are the columns of an m x n matrix A. The
+**          rows of A are split into chunks, and each chunk is factored with
+**          Householder reflectors as a task of the shared thread pool. The
+**          n x n triangular factors of the chunks are stacked in pairs and
+**          factored again, level by level, until one factor R remains. The
+**          orthonormal factor Q is
+**          then formed top down: every tree node passes its part of the Q
+**          factor to its children, and each chunk task multiplies the Q factor
+**          of its chunk by the matrix it receives. The tasks only synchronize
+**          once per tree level.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Tsqr.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+
+#include "Tsqr.hh"
+#include "Arena.hh"
+#include "ThreadPool.hh"
+#include "Orthonormal.hh"
+#include "VecKernels.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @def   TSQR_ROW_BLOCK
+** @brief Number of rows multiplied at a time when the Q factor of a chunk is
+**        formed
+********************************************************************************
+*/
+#define TSQR_ROW_BLOCK 64
+
+/**
+********************************************************************************
+** @def   TSQR_MAX_LEVELS
+** @brief Maximum number of levels in the reduction tree, enough for
+**        TSQR_MAX_CHUNKS chunks
+********************************************************************************
+*/
+#define TSQR_MAX_LEVELS 8
+
+/**
+********************************************************************************
+** @struct  TsqrChunk
+** @brief   Rows of the vector set factored by one task
+** @details Every small matrix is stored by columns with a leading dimension of
+**          n, the same as the vector set.
+********************************************************************************
+*/
+struct TsqrChunk
+{
+    double* pA;         /* First row of the chunk in the vector set */
+    UINT32 lda;         /* Leading dimension of the vector set */
+    UINT32 rows;        /* Number of rows in the chunk */
+    UINT32 n;           /* Number of vectors */
+    UINT32 rank;        /* Number of columns in the final Q factor */
+
+    double* pTau;       /* Householder reflector scalars, n elements */
+    double* pR;         /* Triangular factor of the chunk, n x n */
+    double* pM;         /* Q factor multiplier from the tree, n x rank */
+    double* pWork;      /* Row block workspace, TSQR_ROW_BLOCK x n */
+};
+
+/**
+********************************************************************************
+** @struct  TsqrNode
+** @brief   Reduction tree node combining the triangular factors of two chunks
+********************************************************************************
+*/
+struct TsqrNode
+{
+    TsqrChunk* pTop;    /* Chunk whose factor is stacked on top */
+    TsqrChunk* pBottom; /* Chunk whose factor is stacked on the bottom */
+
+    double* pS;         /* Stacked factors, then their Q factor, 2n x n */
+    double* pTau;       /* Householder reflector scalars, n elements */
+};
+
+/**
+********************************************************************************
+** @details Factor an m x n matrix A = Q*R in place with Householder
+**          reflectors, where m is at least n. Reflector j is H = I - tau*v*v',
+**          where v(j) = 1 and the rest of v is stored below the diagonal of
+**          column j. R is stored on and above the diagonal.
+** @param   pA      Pointer to the matrix, stored by columns
+** @param   lda     Leading dimension of the matrix
+** @param   m       Number of rows
+** @param   n       Number of columns
+** @param   pTau    Array of n elements that receives the reflector scalars
+********************************************************************************
+*/
+static void householderQR(double* pA, const UINT32& lda, const UINT32& m,
+                          const UINT32& n, double* pTau)
+{
+    double alpha;
+    double beta;
+    double colNorm;
+    double w;
+
+    double* pCol;
+    double* pNext;
+
+    for (UINT32 j = 0; j < n; j++)
+    {
+        pCol = pA + (size_t)j*lda + j;
+
+        alpha = pCol[0];
+        colNorm = vecNorm(pCol,m-j);
+        if (0 == colNorm)
+        {
+            pTau[j] = 0;
+            continue;
+        }
+
+        /*
+        ** Choose the sign of beta opposite to alpha, so v(j) = alpha - beta
+        ** has no cancellation
+        */
+        beta = (alpha < 0) ? colNorm : -colNorm;
+        pTau[j] = (beta - alpha)/beta;
+        vecScale(1/(alpha - beta),pCol+1,m-j-1);
+        pCol[0] = beta;
+
+        /*
+        ** Apply the reflector to the remaining columns
+        */
+        for (UINT32 k = j+1; k < n; k++)
+        {
+            pNext = pA + (size_t)k*lda + j;
+
+            w = pNext[0] + vecDot(pCol+1,pNext+1,m-j-1);
+            pNext[0] -= pTau[j]*w;
+            vecAxpy(-pTau[j]*w,pCol+1,pNext+1,m-j-1);
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Replace the Householder reflectors from householderQR() with the
+**          first n columns of the orthonormal factor Q they represent, by
+**          applying the reflectors in reverse order to the identity
+** @param   pA      Pointer to the factored matrix, stored by columns
+** @param   lda     Leading dimension of the matrix
+** @param   m       Number of rows
+** @param   n       Number of columns
+** @param   pTau    Array of n reflector scalars
+********************************************************************************
+*/
+static void formQ(double* pA, const UINT32& lda, const UINT32& m,
+                  const UINT32& n, const double* pTau)
+{
+    double w;
+
+    double* pCol;
+    double* pNext;
+
+    for (UINT32 j = n; j-- > 0;)
+    {
+        pCol = pA + (size_t)j*lda;
+
+        for (UINT32 k = j+1; k < n; k++)
+        {
+            pNext = pA + (size_t)k*lda;
+
+            w = pNext[j] + vecDot(pCol+j+1,pNext+j+1,m-j-1);
+            pNext[j] -= pTau[j]*w;
+            vecAxpy(-pTau[j]*w,pCol+j+1,pNext+j+1,m-j-1);
+        }
+
+        vecScale(-pTau[j],pCol+j+1,m-j-1);
+        pCol[j] = 1 - pTau[j];
+        for (UINT32 i = 0; i < j; i++)
+        {
+            pCol[i] = 0;
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Copy the triangular factor out of a matrix factored in place by
+**          householderQR(), setting the elements below the diagonal to zero
+** @param   pA      Pointer to the factored matrix, stored by columns
+** @param   lda     Leading dimension of the matrix
+** @param   n       Number of columns
+** @param   pR      Pointer to the n x n output matrix, stored by columns
+********************************************************************************
+*/
+static void copyR(const double* pA, const UINT32& lda, const UINT32& n,
+                  double* pR)
+{
+    for (UINT32 j = 0; j < n; j++)
+    {
+        for (UINT32 i = 0; i < n; i++)
+        {
+            pR[(size_t)j*n + i] = (i <= j) ? pA[(size_t)j*lda + i] : 0;
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Factor the rows of one chunk
+** @param   pChunk  Pointer to the chunk
+********************************************************************************
+*/
+static void factorChunk(TsqrChunk* pChunk)
+{
+    householderQR(pChunk->pA,pChunk->lda,pChunk->rows,pChunk->n,pChunk->pTau);
+    copyR(pChunk->pA,pChunk->lda,pChunk->n,pChunk->pR);
+}
+
+/**
+********************************************************************************
+** @details Stack the triangular factors of two chunks and factor them. The
+**          combined factor is stored in the top chunk, which represents both
+**          chunks in the next tree level, and the Q factor of the stacked
+**          matrix is kept in the node.
+** @param   pNode   Pointer to the tree node
+********************************************************************************
+*/
+static void combineNode(TsqrNode* pNode)
+{
+    UINT32 n = pNode->pTop->n;
+
+    for (UINT32 j = 0; j < n; j++)
+    {
+        memcpy(pNode->pS + (size_t)j*2*n,pNode->pTop->pR + (size_t)j*n,
+               n*sizeof(double));
+        memcpy(pNode->pS + (size_t)j*2*n + n,pNode->pBottom->pR + (size_t)j*n,
+               n*sizeof(double));
+    }
+
+    householderQR(pNode->pS,2*n,2*n,n,pNode->pTau);
+    copyR(pNode->pS,2*n,n,pNode->pTop->pR);
+    formQ(pNode->pS,2*n,2*n,n,pNode->pTau);
+}
+
+/**
+********************************************************************************
+** @details Pass the Q factor multiplier of a tree node to its two chunks. The
+**          top chunk receives the top half of the node Q factor times the
+**          multiplier, and the bottom chunk receives the bottom half times the
+**          multiplier.
+** @param   pNode   Pointer to the tree node
+********************************************************************************
+*/
+static void splitNode(TsqrNode* pNode)
+{
+    UINT32 n = pNode->pTop->n;
+    UINT32 rank = pNode->pTop->rank;
+
+    double* pTopM = pNode->pTop->pM;
+    double* pBottomM = pNode->pBottom->pM;
+
+    for (UINT32 j = 0; j < rank; j++)
+    {
+        memset(pBottomM + (size_t)j*n,0,n*sizeof(double));
+        for (UINT32 k = 0; k < n; k++)
+        {
+            vecAxpy(pTopM[(size_t)j*n + k],pNode->pS + (size_t)k*2*n + n,
+                    pBottomM + (size_t)j*n,n);
+        }
+    }
+
+    /*
+    ** The Householder scalars of the node are no longer needed once its Q
+    ** factor is formed, so they hold each column of the top multiplier while
+    ** that column is overwritten
+    */
+    for (UINT32 j = 0; j < rank; j++)
+    {
+        memcpy(pNode->pTau,pTopM + (size_t)j*n,n*sizeof(double));
+        memset(pTopM + (size_t)j*n,0,n*sizeof(double));
+        for (UINT32 k = 0; k < n; k++)
+        {
+            vecAxpy(pNode->pTau[k],pNode->pS + (size_t)k*2*n,
+                    pTopM + (size_t)j*n,n);
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Form the final basis vector rows of one chunk.
+**          The Q factor of the chunk is formed in place and multiplied by the
+**          chunk multiplier one block of rows at a time, so only a small
+**          workspace is needed.
+** @param   pChunk  Pointer to the chunk
+********************************************************************************
+*/
+static void formChunk(TsqrChunk* pChunk)
+{
+    UINT32 rows;
+    UINT32 n = pChunk->n;
+
+    double* pOut;
+
+    formQ(pChunk->pA,pChunk->lda,pChunk->rows,n,pChunk->pTau);
+
+    for (UINT32 r = 0; r < pChunk->rows; r += TSQR_ROW_BLOCK)
+    {
+        rows = MIN(TSQR_ROW_BLOCK,pChunk->rows-r);
+
+        for (UINT32 k = 0; k < n; k++)
+        {
+            memcpy(pChunk->pWork + (size_t)k*TSQR_ROW_BLOCK,
+                   pChunk->pA + (size_t)k*pChunk->lda + r,
+                   rows*sizeof(double));
+        }
+
+        for (UINT32 j = 0; j < pChunk->rank; j++)
+        {
+            pOut = pChunk->pA + (size_t)j*pChunk->lda + r;
+
+            memset(pOut,0,rows*sizeof(double));
+            for (UINT32 k = 0; k < n; k++)
+            {
+                vecAxpy(pChunk->pM[(size_t)j*n + k],
+                        pChunk->pWork + (size_t)k*TSQR_ROW_BLOCK,pOut,rows);
+            }
+        }
+    }
+}
+
+/**
+********************************************************************************
+** @details Orthonormalize a set of vectors in place with the tall-skinny QR
+**          algorithm. The rows of the set are split into nChunks chunks, with
+**          at least n rows in every chunk, and the chunks and tree nodes are
+**          processed in parallel on the shared thread pool.
+**
+**          The diagonal element j of the final triangular factor R is the
+**          magnitude of vector j outside the span of the vectors before it.
+**          When every diagonal element is at least FLOAT_TOL, the set has full
+**          rank, the signs of Q are chosen so R has a positive diagonal, and
+**          the basis is the same as the Modified Gram-Schmidt basis. Otherwise
+**          the columns of R, which have the same inner products as the input
+**          vectors, are orthonormalized with the column pivoted Modified
+**          Gram-Schmidt algorithm, and Q is multiplied by that basis so it
+**          spans the same space as the set, with the basis vectors in pivot
+**          order.
+**
+**          Sets with fewer rows than vectors are passed to the column pivoted
+**          Modified Gram-Schmidt routine.
+** @param   pVecs       Pointer to the vector set
+** @param   lda         Leading dimension of the vector set
+** @param   m           Dimension of each vector
+** @param   n           Number of vectors
+** @param   nChunks     Number of row chunks, or zero for one chunk per
+**                      thread pool thread
+** @param   pOrthVecInd Array of at least n elements that receives the index
+**                      of the input vector of each basis vector
+** @return  Number of orthonormal basis vectors
+********************************************************************************
+*/
+UINT32 orthonormalizeTSQR(double* pVecs, const UINT32& lda, const UINT32& m,
+                          const UINT32& n, const UINT32& nChunks,
+                          UINT32* pOrthVecInd)
+{
+    UINT32 noOfChunks;
+    UINT32 noOfNodes;
+    UINT32 noOfLevels;
+    UINT32 levelStart[TSQR_MAX_LEVELS+1];
+    UINT32 chunkRows;
+    UINT32 extraRows;
+    UINT32 rank;
+    UINT32 firstRow;
+
+    bool fullRank;
+
+    double* pChunkBuf;
+    double* pNodeBuf;
+    double* pRoot;
+
+    TsqrChunk chunks[TSQR_MAX_CHUNKS];
+    TsqrNode nodes[TSQR_MAX_CHUNKS];
+
+    TsqrChunk* pChunks = chunks;
+    TsqrNode* pNodes = nodes;
+
+    if (m < 1 || n < 1 || lda < m)
+    {
+        printf("Error - %s\n"
+               "        Invalid vector set of %u vectors with dimension %u\n"
+               "        and leading dimension %u\n",
+               __PRETTY_FUNCTION__,n,m,lda);
+        exit(EXIT_FAILURE);
+    }
+
+    if (m < n)
+    {
+        return(orthonormalizePivoted(pVecs,lda,m,n,pOrthVecInd));
+    }
+
+    /*
+    ** Choose the number of chunks, so each chunk has at least n rows
+    */
+    noOfChunks = (nChunks > 0) ? nChunks :
+                 ThreadPool::instance().getThreadCount();
+    noOfChunks = MIN(noOfChunks,TSQR_MAX_CHUNKS);
+    noOfChunks = MIN(noOfChunks,m/n);
+    if (noOfChunks < 1)
+    {
+        noOfChunks = 1;
+    }
+
+    chunkRows = m/noOfChunks;
+    extraRows = m%noOfChunks;
+
+    /*
+    ** The chunk, node, and root buffers come from the current arena when there
+    ** is one
+    */
+    ArenaArray chunkBuf((size_t)noOfChunks*
+                        (n + 2*(size_t)n*n + TSQR_ROW_BLOCK*n));
+    ArenaArray nodeBuf((size_t)noOfChunks*(n + 2*(size_t)n*n));
+    ArenaArray root((size_t)n*n);
+
+    pChunkBuf = chunkBuf.get();
+    pNodeBuf = nodeBuf.get();
+    pRoot = root.get();
+
+    firstRow = 0;
+    for (UINT32 c = 0; c < noOfChunks; c++)
+    {
+        pChunks[c].pA = pVecs + firstRow;
+        pChunks[c].lda = lda;
+        pChunks[c].rows = chunkRows + ((c < extraRows) ? 1 : 0);
+        pChunks[c].n = n;
+        pChunks[c].rank = n;
+        pChunks[c].pTau = pChunkBuf +
+                          (size_t)c*(n + 2*(size_t)n*n + TSQR_ROW_BLOCK*n);
+        pChunks[c].pR = pChunks[c].pTau + n;
+        pChunks[c].pM = pChunks[c].pR + (size_t)n*n;
+        pChunks[c].pWork = pChunks[c].pM + (size_t)n*n;
+
+        firstRow += pChunks[c].rows;
+    }
+
+    /*
+    ** Factor every chunk
+    */
+    ThreadPool::instance().parallelFor(0,noOfChunks,1,
+        [pChunks](UINT32 first, UINT32 last)
+        {
+            for (UINT32 c = first; c < last; c++)
+            {
+                factorChunk(&pChunks[c]);
+            }
+        });
+
+    /*
+    ** Combine the triangular factors up the tree. At each level, chunk c
+    ** absorbs chunk c + step, so the final factor ends up in chunk 0. The
+    ** nodes are numbered in the order they are created.
+    */
+    noOfNodes = 0;
+    noOfLevels = 0;
+    for (UINT32 step = 1; step < noOfChunks; step *= 2)
+    {
+        levelStart[noOfLevels] = noOfNodes;
+
+        for (UINT32 c = 0; c + step < noOfChunks; c += 2*step)
+        {
+            pNodes[noOfNodes].pTop = &pChunks[c];
+            pNodes[noOfNodes].pBottom = &pChunks[c + step];
+            pNodes[noOfNodes].pTau = pNodeBuf +
+                                     (size_t)noOfNodes*(n + 2*(size_t)n*n);
+            pNodes[noOfNodes].pS = pNodes[noOfNodes].pTau + n;
+            noOfNodes++;
+        }
+
+        ThreadPool::instance().parallelFor(levelStart[noOfLevels],noOfNodes,1,
+            [pNodes](UINT32 first, UINT32 last)
+            {
+                for (UINT32 k = first; k < last; k++)
+                {
+                    combineNode(&pNodes[k]);
+                }
+            });
+
+        noOfLevels++;
+    }
+    levelStart[noOfLevels] = noOfNodes;
+
+    /*
+    ** Build the multiplier of the root from the final triangular factor
+    */
+    memcpy(pRoot,pChunks[0].pR,(size_t)n*n*sizeof(double));
+
+    fullRank = true;
+    for (UINT32 j = 0; j < n; j++)
+    {
+        if (fabs(pRoot[(size_t)j*n + j]) < FLOAT_TOL)
+        {
+            fullRank = false;
+        }
+    }
+
+    if (fullRank)
+    {
+        rank = n;
+        memset(pChunks[0].pM,0,(size_t)n*n*sizeof(double));
+        for (UINT32 j = 0; j < n; j++)
+        {
+            pChunks[0].pM[(size_t)j*n + j] = sgn(pRoot[(size_t)j*n + j]);
+            pOrthVecInd[j] = j;
+        }
+    }
+    else
+    {
+        rank = orthonormalizePivoted(pRoot,n,n,n,pOrthVecInd);
+        memcpy(pChunks[0].pM,pRoot,(size_t)rank*n*sizeof(double));
+    }
+
+    for (UINT32 c = 0; c < noOfChunks; c++)
+    {
+        pChunks[c].rank = rank;
+    }
+
+    /*
+    ** Pass the multipliers down the tree, one level at a time in reverse
+    */
+    for (UINT32 l = noOfLevels; l-- > 0;)
+    {
+        ThreadPool::instance().parallelFor(levelStart[l],levelStart[l+1],1,
+            [pNodes](UINT32 first, UINT32 last)
+            {
+                for (UINT32 k = first; k < last; k++)
+                {
+                    splitNode(&pNodes[k]);
+                }
+            });
+    }
+
+    /*
+    ** Form the basis vector rows of every chunk
+    */
+    ThreadPool::instance().parallelFor(0,noOfChunks,1,
+        [pChunks](UINT32 first, UINT32 last)
+        {
+            for (UINT32 c = first; c < last; c++)
+            {
+                formChunk(&pChunks[c]);
+            }
+        });
+
+    return(rank);
+}
@@ -0,0 +1,898 @@
+/**
+********************************************************************************
+** @file    VecKernels.cc
+**
+** @brief   Vectorized vector kernels with run time CPU dispatch
+**
+** @details Every kernel is written once for each supported instruction set,
+**          using several independent accumulators so the additions are not
+**          limited by the floating point latency. The variants for newer
+**          instruction sets are compiled with function target attributes, so
+**          the library is still built for the SSE2 baseline. Those variants
+**          clear the upper halves of the vector registers before returning to
+**          the SSE2 callers, which would otherwise pay a state transition
+**          penalty on every call. The CPU features are read once at start up
+**          and the fastest supported variant of each kernel is stored in
+**          vecKernelTable.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  VecKernels.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define VEC_KERNELS_X86
+#endif
+
+#include "VecKernels.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/*----------------------------[Generic Kernels]-------------------------------*/
+/**
+********************************************************************************
+** @details Dot product with portable C++ loops
+********************************************************************************
+*/
+static double dotGeneric(const double* pX, const double* pY, UINT32 n)
+{
+    UINT32 i;
+
+    double sum0 = 0;
+    double sum1 = 0;
+    double sum2 = 0;
+    double sum3 = 0;
+
+    for (i = 0; i+4 <= n; i += 4)
+    {
+        sum0 += pX[i]*pY[i];
+        sum1 += pX[i+1]*pY[i+1];
+        sum2 += pX[i+2]*pY[i+2];
+        sum3 += pX[i+3]*pY[i+3];
+    }
+
+    for (; i < n; i++)
+    {
+        sum0 += pX[i]*pY[i];
+    }
+
+    return((sum0 + sum1) + (sum2 + sum3));
+}
+
+/**
+********************************************************************************
+** @details AXPY update with portable C++ loops
+********************************************************************************
+*/
+static void axpyGeneric(double a, const double* pX, double* pY, UINT32 n)
+{
+    for (UINT32 i = 0; i < n; i++)
+    {
+        pY[i] += a*pX[i];
+    }
+}
+
+/**
+********************************************************************************
+** @details Array scaling with portable C++ loops
+********************************************************************************
+*/
+static void scaleGeneric(double a, double* pX, UINT32 n)
+{
+    for (UINT32 i = 0; i < n; i++)
+    {
+        pX[i] *= a;
+    }
+}
+
+/**
+********************************************************************************
+** @details Sum of squares with portable C++ loops
+********************************************************************************
+*/
+static double sumSqGeneric(const double* pX, UINT32 n)
+{
+    return(dotGeneric(pX,pX,n));
+}
+
+/**
+********************************************************************************
+** @details Fused AXPY update and sum of squares of the result with portable
+**          C++ loops
+********************************************************************************
+*/
+static double axpySumSqGeneric(double a, const double* pX, double* pY,
+                               UINT32 n)
+{
+    UINT32 i;
+
+    double sum0 = 0;
+    double sum1 = 0;
+
+    for (i = 0; i+2 <= n; i += 2)
+    {
+        pY[i]   += a*pX[i];
+        pY[i+1] += a*pX[i+1];
+        sum0 += pY[i]*pY[i];
+        sum1 += pY[i+1]*pY[i+1];
+    }
+
+    for (; i < n; i++)
+    {
+        pY[i] += a*pX[i];
+        sum0 += pY[i]*pY[i];
+    }
+
+    return(sum0 + sum1);
+}
+
+#ifdef VEC_KERNELS_X86
+/*-----------------------------[SSE2 Kernels]---------------------------------*/
+/**
+********************************************************************************
+** @details Dot product with SSE2, eight elements per iteration
+********************************************************************************
+*/
+static double dotSSE2(const double* pX, const double* pY, UINT32 n)
+{
+    UINT32 i;
+
+    double sum;
+
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    __m128d acc2 = _mm_setzero_pd();
+    __m128d acc3 = _mm_setzero_pd();
+
+    for (i = 0; i+8 <= n; i += 8)
+    {
+        acc0 = _mm_add_pd(acc0,_mm_mul_pd(_mm_loadu_pd(pX+i),
+                                          _mm_loadu_pd(pY+i)));
+        acc1 = _mm_add_pd(acc1,_mm_mul_pd(_mm_loadu_pd(pX+i+2),
+                                          _mm_loadu_pd(pY+i+2)));
+        acc2 = _mm_add_pd(acc2,_mm_mul_pd(_mm_loadu_pd(pX+i+4),
+                                          _mm_loadu_pd(pY+i+4)));
+        acc3 = _mm_add_pd(acc3,_mm_mul_pd(_mm_loadu_pd(pX+i+6),
+                                          _mm_loadu_pd(pY+i+6)));
+    }
+
+    for (; i+2 <= n; i += 2)
+    {
+        acc0 = _mm_add_pd(acc0,_mm_mul_pd(_mm_loadu_pd(pX+i),
+                                          _mm_loadu_pd(pY+i)));
+    }
+
+    acc0 = _mm_add_pd(_mm_add_pd(acc0,acc1),_mm_add_pd(acc2,acc3));
+    sum = _mm_cvtsd_f64(_mm_add_sd(acc0,_mm_unpackhi_pd(acc0,acc0)));
+
+    if (i < n)
+    {
+        sum += pX[i]*pY[i];
+    }
+
+    return(sum);
+}
+
+/**
+********************************************************************************
+** @details AXPY update with SSE2, eight elements per iteration
+********************************************************************************
+*/
+static void axpySSE2(double a, const double* pX, double* pY, UINT32 n)
+{
+    UINT32 i;
+
+    __m128d va = _mm_set1_pd(a);
+
+    for (i = 0; i+8 <= n; i += 8)
+    {
+        _mm_storeu_pd(pY+i,  _mm_add_pd(_mm_loadu_pd(pY+i),
+                             _mm_mul_pd(va,_mm_loadu_pd(pX+i))));
+        _mm_storeu_pd(pY+i+2,_mm_add_pd(_mm_loadu_pd(pY+i+2),
+                             _mm_mul_pd(va,_mm_loadu_pd(pX+i+2))));
+        _mm_storeu_pd(pY+i+4,_mm_add_pd(_mm_loadu_pd(pY+i+4),
+                             _mm_mul_pd(va,_mm_loadu_pd(pX+i+4))));
+        _mm_storeu_pd(pY+i+6,_mm_add_pd(_mm_loadu_pd(pY+i+6),
+                             _mm_mul_pd(va,_mm_loadu_pd(pX+i+6))));
+    }
+
+    for (; i < n; i++)
+    {
+        pY[i] += a*pX[i];
+    }
+}
+
+/**
+********************************************************************************
+** @details Array scaling with SSE2, eight elements per iteration
+********************************************************************************
+*/
+static void scaleSSE2(double a, double* pX, UINT32 n)
+{
+    UINT32 i;
+
+    __m128d va = _mm_set1_pd(a);
+
+    for (i = 0; i+8 <= n; i += 8)
+    {
+        _mm_storeu_pd(pX+i,  _mm_mul_pd(va,_mm_loadu_pd(pX+i)));
+        _mm_storeu_pd(pX+i+2,_mm_mul_pd(va,_mm_loadu_pd(pX+i+2)));
+        _mm_storeu_pd(pX+i+4,_mm_mul_pd(va,_mm_loadu_pd(pX+i+4)));
+        _mm_storeu_pd(pX+i+6,_mm_mul_pd(va,_mm_loadu_pd(pX+i+6)));
+    }
+
+    for (; i < n; i++)
+    {
+        pX[i] *= a;
+    }
+}
+
+/**
+********************************************************************************
+** @details Sum of squares with SSE2
+********************************************************************************
+*/
+static double sumSqSSE2(const double* pX, UINT32 n)
+{
+    return(dotSSE2(pX,pX,n));
+}
+
+/**
+********************************************************************************
+** @details Fused AXPY update and sum of squares of the result with SSE2,
+**          eight elements per iteration
+********************************************************************************
+*/
+static double axpySumSqSSE2(double a, const double* pX, double* pY, UINT32 n)
+{
+    UINT32 i;
+
+    double sum;
+
+    __m128d va = _mm_set1_pd(a);
+    __m128d y0;
+    __m128d y1;
+    __m128d y2;
+    __m128d y3;
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    __m128d acc2 = _mm_setzero_pd();
+    __m128d acc3 = _mm_setzero_pd();
+
+    for (i = 0; i+8 <= n; i += 8)
+    {
+        y0 = _mm_add_pd(_mm_loadu_pd(pY+i),  _mm_mul_pd(va,_mm_loadu_pd(pX+i)));
+        y1 = _mm_add_pd(_mm_loadu_pd(pY+i+2),_mm_mul_pd(va,_mm_loadu_pd(pX+i+2)));
+        y2 = _mm_add_pd(_mm_loadu_pd(pY+i+4),_mm_mul_pd(va,_mm_loadu_pd(pX+i+4)));
+        y3 = _mm_add_pd(_mm_loadu_pd(pY+i+6),_mm_mul_pd(va,_mm_loadu_pd(pX+i+6)));
+
+        _mm_storeu_pd(pY+i,  y0);
+        _mm_storeu_pd(pY+i+2,y1);
+        _mm_storeu_pd(pY+i+4,y2);
+        _mm_storeu_pd(pY+i+6,y3);
+
+        acc0 = _mm_add_pd(acc0,_mm_mul_pd(y0,y0));
+        acc1 = _mm_add_pd(acc1,_mm_mul_pd(y1,y1));
+        acc2 = _mm_add_pd(acc2,_mm_mul_pd(y2,y2));
+        acc3 = _mm_add_pd(acc3,_mm_mul_pd(y3,y3));
+    }
+
+    acc0 = _mm_add_pd(_mm_add_pd(acc0,acc1),_mm_add_pd(acc2,acc3));
+    sum = _mm_cvtsd_f64(_mm_add_sd(acc0,_mm_unpackhi_pd(acc0,acc0)));
+
+    for (; i < n; i++)
+    {
+        pY[i] += a*pX[i];
+        sum += pY[i]*pY[i];
+    }
+
+    return(sum);
+}
+
+/*-----------------------------[AVX2 Kernels]---------------------------------*/
+/**
+********************************************************************************
+** @details Dot product with AVX2 and FMA, sixteen elements per iteration
+********************************************************************************
+*/
+__attribute__((target("avx2,fma")))
+static double dotAVX2(const double* pX, const double* pY, UINT32 n)
+{
+    UINT32 i;
+
+    double sum;
+
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+    __m128d half;
+
+    for (i = 0; i+16 <= n; i += 16)
+    {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(pX+i),
+                               _mm256_loadu_pd(pY+i),acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(pX+i+4),
+                               _mm256_loadu_pd(pY+i+4),acc1);
+        acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(pX+i+8),
+                               _mm256_loadu_pd(pY+i+8),acc2);
+        acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(pX+i+12),
+                               _mm256_loadu_pd(pY+i+12),acc3);
+    }
+
+    for (; i+4 <= n; i += 4)
+    {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(pX+i),
+                               _mm256_loadu_pd(pY+i),acc0);
+    }
+
+    acc0 = _mm256_add_pd(_mm256_add_pd(acc0,acc1),_mm256_add_pd(acc2,acc3));
+    half = _mm_add_pd(_mm256_castpd256_pd128(acc0),
+                      _mm256_extractf128_pd(acc0,1));
+    sum = _mm_cvtsd_f64(_mm_add_sd(half,_mm_unpackhi_pd(half,half)));
+
+    for (; i < n; i++)
+    {
+        sum += pX[i]*pY[i];
+    }
+
+    _mm256_zeroupper();
+
+    return(sum);
+}
+
+/**
+********************************************************************************
+** @details AXPY update with AVX2 and FMA, sixteen elements per iteration
+********************************************************************************
+*/
+__attribute__((target("avx2,fma")))
+static void axpyAVX2(double a, const double* pX, double* pY, UINT32 n)
+{
+    UINT32 i;
+
+    __m256d va = _mm256_set1_pd(a);
+
+    for (i = 0; i+16 <= n; i += 16)
+    {
+        _mm256_storeu_pd(pY+i,   _mm256_fmadd_pd(va,_mm256_loadu_pd(pX+i),
+                                                 _mm256_loadu_pd(pY+i)));
+        _mm256_storeu_pd(pY+i+4, _mm256_fmadd_pd(va,_mm256_loadu_pd(pX+i+4),
+                                                 _mm256_loadu_pd(pY+i+4)));
+        _mm256_storeu_pd(pY+i+8, _mm256_fmadd_pd(va,_mm256_loadu_pd(pX+i+8),
+                                                 _mm256_loadu_pd(pY+i+8)));
+        _mm256_storeu_pd(pY+i+12,_mm256_fmadd_pd(va,_mm256_loadu_pd(pX+i+12),
+                                                 _mm256_loadu_pd(pY+i+12)));
+    }
+
+    for (; i+4 <= n; i += 4)
+    {
+        _mm256_storeu_pd(pY+i,_mm256_fmadd_pd(va,_mm256_loadu_pd(pX+i),
+                                              _mm256_loadu_pd(pY+i)));
+    }
+
+    for (; i < n; i++)
+    {
+        pY[i] += a*pX[i];
+    }
+
+    _mm256_zeroupper();
+}
+
+/**
+********************************************************************************
+** @details Array scaling with AVX2, sixteen elements per iteration
+********************************************************************************
+*/
+__attribute__((target("avx2")))
+static void scaleAVX2(double a, double* pX, UINT32 n)
+{
+    UINT32 i;
+
+    __m256d va = _mm256_set1_pd(a);
+
+    for (i = 0; i+16 <= n; i += 16)
+    {
+        _mm256_storeu_pd(pX+i,   _mm256_mul_pd(va,_mm256_loadu_pd(pX+i)));
+        _mm256_storeu_pd(pX+i+4, _mm256_mul_pd(va,_mm256_loadu_pd(pX+i+4)));
+        _mm256_storeu_pd(pX+i+8, _mm256_mul_pd(va,_mm256_loadu_pd(pX+i+8)));
+        _mm256_storeu_pd(pX+i+12,_mm256_mul_pd(va,_mm256_loadu_pd(pX+i+12)));
+    }
+
+    for (; i < n; i++)
+    {
+        pX[i] *= a;
+    }
+
+    _mm256_zeroupper();
+}
+
+/**
+********************************************************************************
+** @details Sum of squares with AVX2 and FMA
+********************************************************************************
+*/
+__attribute__((target("avx2,fma")))
+static double sumSqAVX2(const double* pX, UINT32 n)
+{
+    return(dotAVX2(pX,pX,n));
+}
+
+/**
+********************************************************************************
+** @details Fused AXPY update and sum of squares of the result with AVX2 and
+**          FMA, sixteen elements per iteration
+********************************************************************************
+*/
+__attribute__((target("avx2,fma")))
+static double axpySumSqAVX2(double a, const double* pX, double* pY, UINT32 n)
+{
+    UINT32 i;
+
+    double sum;
+
+    __m256d va = _mm256_set1_pd(a);
+    __m256d y0;
+    __m256d y1;
+    __m256d y2;
+    __m256d y3;
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+    __m128d half;
+
+    for (i = 0; i+16 <= n; i += 16)
+    {
+        y0 = _mm256_fmadd_pd(va,_mm256_loadu_pd(pX+i),_mm256_loadu_pd(pY+i));
+        y1 = _mm256_fmadd_pd(va,_mm256_loadu_pd(pX+i+4),
+                             _mm256_loadu_pd(pY+i+4));
+        y2 = _mm256_fmadd_pd(va,_mm256_loadu_pd(pX+i+8),
+                             _mm256_loadu_pd(pY+i+8));
+        y3 = _mm256_fmadd_pd(va,_mm256_loadu_pd(pX+i+12),
+                             _mm256_loadu_pd(pY+i+12));
+
+        _mm256_storeu_pd(pY+i,   y0);
+        _mm256_storeu_pd(pY+i+4, y1);
+        _mm256_storeu_pd(pY+i+8, y2);
+        _mm256_storeu_pd(pY+i+12,y3);
+
+        acc0 = _mm256_fmadd_pd(y0,y0,acc0);
+        acc1 = _mm256_fmadd_pd(y1,y1,acc1);
+        acc2 = _mm256_fmadd_pd(y2,y2,acc2);
+        acc3 = _mm256_fmadd_pd(y3,y3,acc3);
+    }
+
+    for (; i+4 <= n; i += 4)
+    {
+        y0 = _mm256_fmadd_pd(va,_mm256_loadu_pd(pX+i),_mm256_loadu_pd(pY+i));
+        _mm256_storeu_pd(pY+i,y0);
+        acc0 = _mm256_fmadd_pd(y0,y0,acc0);
+    }
+
+    acc0 = _mm256_add_pd(_mm256_add_pd(acc0,acc1),_mm256_add_pd(acc2,acc3));
+    half = _mm_add_pd(_mm256_castpd256_pd128(acc0),
+                      _mm256_extractf128_pd(acc0,1));
+    sum = _mm_cvtsd_f64(_mm_add_sd(half,_mm_unpackhi_pd(half,half)));
+
+    for (; i < n; i++)
+    {
+        pY[i] += a*pX[i];
+        sum += pY[i]*pY[i];
+    }
+
+    _mm256_zeroupper();
+
+    return(sum);
+}
+
+/*----------------------------[AVX-512 Kernels]-------------------------------*/
+/**
+********************************************************************************
+** @details Sum the eight lanes of an AVX-512 register. The halves are added
+**          in registers; storing the register to memory and reloading the
+**          lanes stalls on store forwarding. The zero-masked extracts avoid
+**          the undefined source operand of the unmasked form.
+** @param   acc Register to sum
+** @return  Sum of the lanes
+********************************************************************************
+*/
+__attribute__((target("avx512f")))
+static inline double reduceAVX512(__m512d acc)
+{
+    __m256d quad;
+    __m128d half;
+
+    quad = _mm256_add_pd(_mm512_maskz_extractf64x4_pd(0xFF,acc,0),
+                         _mm512_maskz_extractf64x4_pd(0xFF,acc,1));
+    half = _mm_add_pd(_mm256_castpd256_pd128(quad),
+                      _mm256_extractf128_pd(quad,1));
+
+    return(_mm_cvtsd_f64(_mm_add_sd(half,_mm_unpackhi_pd(half,half))));
+}
+
+/**
+********************************************************************************
+** @details Dot product with AVX-512F, thirty-two elements per iteration. The
+**          remaining elements are handled with a masked load.
+********************************************************************************
+*/
+__attribute__((target("avx512f")))
+static double dotAVX512(const double* pX, const double* pY, UINT32 n)
+{
+    UINT32 i;
+
+    __mmask8 tail;
+
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    __m512d acc2 = _mm512_setzero_pd();
+    __m512d acc3 = _mm512_setzero_pd();
+
+    double sum;
+
+    for (i = 0; i+32 <= n; i += 32)
+    {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(pX+i),
+                               _mm512_loadu_pd(pY+i),acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(pX+i+8),
+                               _mm512_loadu_pd(pY+i+8),acc1);
+        acc2 = _mm512_fmadd_pd(_mm512_loadu_pd(pX+i+16),
+                               _mm512_loadu_pd(pY+i+16),acc2);
+        acc3 = _mm512_fmadd_pd(_mm512_loadu_pd(pX+i+24),
+                               _mm512_loadu_pd(pY+i+24),acc3);
+    }
+
+    for (; i+8 <= n; i += 8)
+    {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(pX+i),
+                               _mm512_loadu_pd(pY+i),acc0);
+    }
+
+    if (i < n)
+    {
+        tail = (__mmask8)((1u << (n-i)) - 1);
+        acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(tail,pX+i),
+                               _mm512_maskz_loadu_pd(tail,pY+i),acc1);
+    }
+
+    acc0 = _mm512_add_pd(_mm512_add_pd(acc0,acc1),_mm512_add_pd(acc2,acc3));
+    sum = reduceAVX512(acc0);
+
+    _mm256_zeroupper();
+
+    return(sum);
+}
+
+/**
+********************************************************************************
+** @details AXPY update with AVX-512F, thirty-two elements per iteration
+********************************************************************************
+*/
+__attribute__((target("avx512f")))
+static void axpyAVX512(double a, const double* pX, double* pY, UINT32 n)
+{
+    UINT32 i;
+
+    __mmask8 tail;
+
+    __m512d va = _mm512_set1_pd(a);
+
+    for (i = 0; i+32 <= n; i += 32)
+    {
+        _mm512_storeu_pd(pY+i,   _mm512_fmadd_pd(va,_mm512_loadu_pd(pX+i),
+                                                 _mm512_loadu_pd(pY+i)));
+        _mm512_storeu_pd(pY+i+8, _mm512_fmadd_pd(va,_mm512_loadu_pd(pX+i+8),
+                                                 _mm512_loadu_pd(pY+i+8)));
+        _mm512_storeu_pd(pY+i+16,_mm512_fmadd_pd(va,_mm512_loadu_pd(pX+i+16),
+                                                 _mm512_loadu_pd(pY+i+16)));
+        _mm512_storeu_pd(pY+i+24,_mm512_fmadd_pd(va,_mm512_loadu_pd(pX+i+24),
+                                                 _mm512_loadu_pd(pY+i+24)));
+    }
+
+    for (; i+8 <= n; i += 8)
+    {
+        _mm512_storeu_pd(pY+i,_mm512_fmadd_pd(va,_mm512_loadu_pd(pX+i),
+                                              _mm512_loadu_pd(pY+i)));
+    }
+
+    if (i < n)
+    {
+        tail = (__mmask8)((1u << (n-i)) - 1);
+        _mm512_mask_storeu_pd(pY+i,tail,
+                              _mm512_fmadd_pd(va,
+                                  _mm512_maskz_loadu_pd(tail,pX+i),
+                                  _mm512_maskz_loadu_pd(tail,pY+i)));
+    }
+
+    _mm256_zeroupper();
+}
+
+/**
+********************************************************************************
+** @details Array scaling with AVX-512F, thirty-two elements per iteration
+********************************************************************************
+*/
+__attribute__((target("avx512f")))
+static void scaleAVX512(double a, double* pX, UINT32 n)
+{
+    UINT32 i;
+
+    __mmask8 tail;
+
+    __m512d va = _mm512_set1_pd(a);
+
+    for (i = 0; i+32 <= n; i += 32)
+    {
+        _mm512_storeu_pd(pX+i,   _mm512_mul_pd(va,_mm512_loadu_pd(pX+i)));
+        _mm512_storeu_pd(pX+i+8, _mm512_mul_pd(va,_mm512_loadu_pd(pX+i+8)));
+        _mm512_storeu_pd(pX+i+16,_mm512_mul_pd(va,_mm512_loadu_pd(pX+i+16)));
+        _mm512_storeu_pd(pX+i+24,_mm512_mul_pd(va,_mm512_loadu_pd(pX+i+24)));
+    }
+
+    for (; i+8 <= n; i += 8)
+    {
+        _mm512_storeu_pd(pX+i,_mm512_mul_pd(va,_mm512_loadu_pd(pX+i)));
+    }
+
+    if (i < n)
+    {
+        tail = (__mmask8)((1u << (n-i)) - 1);
+        _mm512_mask_storeu_pd(pX+i,tail,
+                              _mm512_mul_pd(va,
+                                  _mm512_maskz_loadu_pd(tail,pX+i)));
+    }
+
+    _mm256_zeroupper();
+}
+
+/**
+********************************************************************************
+** @details Sum of squares with AVX-512F
+********************************************************************************
+*/
+__attribute__((target("avx512f")))
+static double sumSqAVX512(const double* pX, UINT32 n)
+{
+    return(dotAVX512(pX,pX,n));
+}
+
+/**
+********************************************************************************
+** @details Fused AXPY update and sum of squares of the result with AVX-512F,
+**          sixteen elements per iteration
+********************************************************************************
+*/
+__attribute__((target("avx512f")))
+static double axpySumSqAVX512(double a, const double* pX, double* pY,
+                              UINT32 n)
+{
+    UINT32 i;
+
+    __mmask8 tail;
+
+    __m512d va = _mm512_set1_pd(a);
+    __m512d y0;
+    __m512d y1;
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+
+    double sum;
+
+    for (i = 0; i+16 <= n; i += 16)
+    {
+        y0 = _mm512_fmadd_pd(va,_mm512_loadu_pd(pX+i),_mm512_loadu_pd(pY+i));
+        y1 = _mm512_fmadd_pd(va,_mm512_loadu_pd(pX+i+8),
+                             _mm512_loadu_pd(pY+i+8));
+
+        _mm512_storeu_pd(pY+i,  y0);
+        _mm512_storeu_pd(pY+i+8,y1);
+
+        acc0 = _mm512_fmadd_pd(y0,y0,acc0);
+        acc1 = _mm512_fmadd_pd(y1,y1,acc1);
+    }
+
+    for (; i+8 <= n; i += 8)
+    {
+        y0 = _mm512_fmadd_pd(va,_mm512_loadu_pd(pX+i),_mm512_loadu_pd(pY+i));
+        _mm512_storeu_pd(pY+i,y0);
+        acc0 = _mm512_fmadd_pd(y0,y0,acc0);
+    }
+
+    if (i < n)
+    {
+        tail = (__mmask8)((1u << (n-i)) - 1);
+        y0 = _mm512_fmadd_pd(va,_mm512_maskz_loadu_pd(tail,pX+i),
+                             _mm512_maskz_loadu_pd(tail,pY+i));
+        _mm512_mask_storeu_pd(pY+i,tail,y0);
+        acc1 = _mm512_fmadd_pd(y0,y0,acc1);
+    }
+
+    acc0 = _mm512_add_pd(acc0,acc1);
+    sum = reduceAVX512(acc0);
+
+    _mm256_zeroupper();
+
+    return(sum);
+}
+#endif
+
+/*-----------------------------[Kernel Dispatch]------------------------------*/
+/**
+********************************************************************************
+** @details Check if the CPU supports an instruction set
+** @param   isa Instruction set
+** @return  True if the kernels of the instruction set can run on this CPU
+********************************************************************************
+*/
+static bool isaSupported(const VecKernelIsa& isa)
+{
+    switch (isa)
+    {
+        case VEC_ISA_GENERIC:
+            return(true);
+
+#ifdef VEC_KERNELS_X86
+        case VEC_ISA_SSE2:
+            return(__builtin_cpu_supports("sse2"));
+
+        case VEC_ISA_AVX2:
+            return(__builtin_cpu_supports("avx2") &&
+                   __builtin_cpu_supports("fma"));
+
+        case VEC_ISA_AVX512:
+            return(__builtin_cpu_supports("avx512f"));
+#endif
+
+        default:
+            return(false);
+    }
+}
+
+/**
+********************************************************************************
+** @details Select the kernels of an instruction set
+** @param   isa Instruction set
+** @return  False if the CPU does not support the instruction set, in which
+**          case the selected kernels are not changed
+********************************************************************************
+*/
+bool setVecKernelIsa(const VecKernelIsa& isa)
+{
+    if (!isaSupported(isa))
+    {
+        return(false);
+    }
+
+    switch (isa)
+    {
+#ifdef VEC_KERNELS_X86
+        case VEC_ISA_SSE2:
+            vecKernelTable.dot   = dotSSE2;
+            vecKernelTable.axpy  = axpySSE2;
+            vecKernelTable.scale = scaleSSE2;
+            vecKernelTable.sumSq = sumSqSSE2;
+            vecKernelTable.axpySumSq = axpySumSqSSE2;
+            break;
+
+        case VEC_ISA_AVX2:
+            vecKernelTable.dot   = dotAVX2;
+            vecKernelTable.axpy  = axpyAVX2;
+            vecKernelTable.scale = scaleAVX2;
+            vecKernelTable.sumSq = sumSqAVX2;
+            vecKernelTable.axpySumSq = axpySumSqAVX2;
+            break;
+
+        case VEC_ISA_AVX512:
+            vecKernelTable.dot   = dotAVX512;
+            vecKernelTable.axpy  = axpyAVX512;
+            vecKernelTable.scale = scaleAVX512;
+            vecKernelTable.sumSq = sumSqAVX512;
+            vecKernelTable.axpySumSq = axpySumSqAVX512;
+            break;
+#endif
+
+        default:
+            vecKernelTable.dot   = dotGeneric;
+            vecKernelTable.axpy  = axpyGeneric;
+            vecKernelTable.scale = scaleGeneric;
+            vecKernelTable.sumSq = sumSqGeneric;
+            vecKernelTable.axpySumSq = axpySumSqGeneric;
+            break;
+    }
+    vecKernelTable.isa = isa;
+
+    return(true);
+}
+
+/**
+********************************************************************************
+** @details Return the name of the instruction set of the selected kernels
+** @return  Instruction set name
+********************************************************************************
+*/
+const char* getVecKernelIsaName(void)
+{
+    switch (vecKernelTable.isa)
+    {
+        case VEC_ISA_SSE2:
+            return("SSE2");
+
+        case VEC_ISA_AVX2:
+            return("AVX2");
+
+        case VEC_ISA_AVX512:
+            return("AVX-512");
+
+        default:
+            return("Generic");
+    }
+}
+
+/**
+********************************************************************************
+** @details Select the fastest instruction set supported by the CPU
+** @return  Selected instruction set
+********************************************************************************
+*/
+static VecKernelIsa selectVecKernels(void)
+{
+    const VecKernelIsa isaOrder[] = {VEC_ISA_AVX512,
+                                     VEC_ISA_AVX2,
+                                     VEC_ISA_SSE2,
+                                     VEC_ISA_GENERIC};
+
+#ifdef VEC_KERNELS_X86
+    __builtin_cpu_init();
+#endif
+
+    for (UINT32 i = 0; i < sizeof(isaOrder)/sizeof(isaOrder[0]); i++)
+    {
+        if (setVecKernelIsa(isaOrder[i]))
+        {
+            break;
+        }
+    }
+
+    return(vecKernelTable.isa);
+}
+
+/*
+** The table starts with the generic kernels, which are valid before static
+** initialization, and the CPU features are checked once at start up
+*/
+VecKernelTable vecKernelTable = {dotGeneric,
+                                 axpyGeneric,
+                                 scaleGeneric,
+                                 sumSqGeneric,
+                                 axpySumSqGeneric,
+                                 VEC_ISA_GENERIC};
+
+static const VecKernelIsa startupIsa = selectVecKernels();
@@ -45,6 +45,7 @@
 #include <cmath>
 
 #include "Vector.hh"
+#include "VecKernels.hh"
 
 /*-------------------------------[Begin Code]---------------------------------*/
 /**
@@ -59,6 +60,7 @@ Vector::Vector()
     */
     ndims = 0;
     pVec = NULL;
+    fromArena = false;
 }
 
 /**
@@ -72,7 +74,7 @@ Vector::Vector(const UINT32& n)
     ndims = n;
     checkSize(ndims);
 
-    pVec = new double [ndims];
+    allocate(ndims);
 
     for (UINT32 i = 0; i < ndims; i++)
     {
@@ -91,9 +93,27 @@ Vector::Vector(const double* vals, const UINT32& n)
 {
     ndims = 0;
     pVec = NULL;
+    fromArena = false;
     setVector(vals,n);
 }
 
+/**
+********************************************************************************
+** @details Vector class constructor that takes ownership of a buffer
+**          allocated with new[] instead of copying its elements
+** @param   vals    Pointer to a 1-D array allocated with new[]
+** @param   n       Number of elements in vals
+********************************************************************************
+*/
+Vector::Vector(double* vals, const UINT32& n, AdoptBuffer)
+{
+    ndims = n;
+    checkSize(ndims);
+
+    pVec = vals;
+    fromArena = false;
+}
+
 /**
 ********************************************************************************
 ** @details Vector copy constructor
@@ -103,7 +123,7 @@ Vector::Vector(const double* vals, const UINT32& n)
 Vector::Vector(const Vector& vec)
 {
     ndims = vec.ndims;
-    pVec = new double [ndims];
+    allocate(ndims);
 
     for (UINT32 i = 0; i < ndims; i++)
     {
@@ -113,19 +133,44 @@ Vector::Vector(const Vector& vec)
 
 /**
 ********************************************************************************
-** @details Vector move constructor
+** @details Vector move constructor. Heap elements are taken over. Inline
+**          elements are copied, and so are arena elements, onto the heap,
+**          since the new vector may outlive the arena scope.
 ** @param   vec Vector object lvalue reference
 ********************************************************************************
 */
 Vector::Vector(Vector&& vec)
 {
-    pVec = vec.pVec;
     ndims = vec.ndims;
 
+    if (vec.pVec == vec.inlineVec || vec.fromArena)
+    {
+        allocate(ndims,false);
+        for (UINT32 i = 0; i < ndims; i++)
+        {
+            pVec[i] = vec.pVec[i];
+        }
+    }
+    else
+    {
+        pVec = vec.pVec;
+        fromArena = false;
+    }
+
     vec.pVec = NULL;
     vec.ndims = 0;
 }
 
+/**
+********************************************************************************
+** @details Vector destructor
+********************************************************************************
+*/
+Vector::~Vector()
+{
+    release();
+}
+
 /**
 ********************************************************************************
 ** @details Verify the dimension of the vector is greater than zero
@@ -178,7 +223,7 @@ void Vector::checkOperatorSize(const UINT32& n1, const UINT32& n2) const
 */
 double Vector::mag(void)
 {
-    return(sqrt(*this*(*this)));
+    return(vecNorm(pVec,ndims));
 }
 
 /**
@@ -200,35 +245,71 @@ Vector Vector::unit(void)
         exit(EXIT_FAILURE);
     }
 
-    return(Vector(*this/mag()));
+    return(Vector(*this/vecMag));
+}
+
+/**
+********************************************************************************
+** @details Scale the calling object to unit magnitude in place. The magnitude
+**          is calculated once and the elements are scaled in one more pass, so
+**          no temporary vector is created.
+** @return  Magnitude of the vector before it was normalized
+********************************************************************************
+*/
+double Vector::normalize(void)
+{
+    double vecMag;
+
+    vecMag = mag();
+    if (vecMag < FLOAT_TOL)
+    {
+        printf("Error - %s\n"
+               "        The zero vector can not be normalized.\n",
+               __PRETTY_FUNCTION__);
+        exit(EXIT_FAILURE);
+    }
+
+    vecScale(1/vecMag,pVec,ndims);
+
+    return(vecMag);
 }
 
 /**
 ********************************************************************************
-** @details Calculate the outer product of two vectors
+** @details Remove the component of a unit vector from the calling object in
+**          place, v = v - (q*v)*q. This is one step of the Modified
+**          Gram-Schmidt algorithm, done in two passes over memory with the
+**          magnitude of the result summed during the subtraction.
+** @param   unitVec Conformable unit Vector object q
+** @return  Magnitude of the vector after the projection is removed
+********************************************************************************
+*/
+double Vector::projectOut(const Vector& unitVec)
+{
+    checkOperatorSize(ndims,unitVec.ndims);
+
+    return(sqrt(vecProjectOut(unitVec.pVec,pVec,ndims)));
+}
+
+/**
+********************************************************************************
+** @details Calculate the outer product of two vectors, written row by row
+**          into the aligned storage of a new Matrix object
 ** @param   rhs Vector object
 ** @return  Outer product matrix object
 ********************************************************************************
 */
 Matrix Vector::outer(const Vector& rhs) const
 {
-    UINT32 matRows;
-    UINT32 matCols;
-    double* pMatrix;
-
-    matRows = ndims;
-    matCols = rhs.ndims;
-    pMatrix = new double [matRows*matCols];
+    Matrix outerMat(ndims,rhs.ndims);
+    MatrixView outerView = outerMat.view();
 
-    for (UINT32 i = 0; i < matRows; i++)
+    for (UINT32 i = 0; i < ndims; i++)
     {
-        for (UINT32 j = 0; j < matCols; j++)
-        {
-            pMatrix[i*matCols + j] = pVec[i]*rhs.pVec[j];
-        }
+        outerView.row(i) = pVec[i]*rhs.view();
     }
 
-    return(Matrix(pMatrix,matRows,matCols));
+    return(outerMat);
 }
 
 /**
@@ -241,10 +322,7 @@ Matrix Vector::outer(const Vector& rhs) const
 Vector& Vector::operator+=(const Vector& rhs)
 {
     checkOperatorSize(ndims,rhs.ndims);
-    for (UINT32 i = 0; i < ndims; i++)
-    {
-        pVec[i] += rhs.pVec[i];
-    }
+    vecAxpy(1,rhs.pVec,pVec,ndims);
 
     return(*this);
 }
@@ -259,10 +337,7 @@ Vector& Vector::operator+=(const Vector& rhs)
 Vector& Vector::operator-=(const Vector& rhs)
 {
     checkOperatorSize(ndims,rhs.ndims);
-    for (UINT32 i = 0; i < ndims; i++)
-    {
-        pVec[i] -= rhs.pVec[i];
-    }
+    vecAxpy(-1,rhs.pVec,pVec,ndims);
 
     return(*this);
 }
@@ -276,10 +351,7 @@ Vector& Vector::operator-=(const Vector& rhs)
 */
 Vector& Vector::operator*=(const double& rhs)
 {
-    for (UINT32 i = 0; i < ndims; i++)
-    {
-        pVec[i] *= rhs;
-    }
+    vecScale(rhs,pVec,ndims);
 
     return(*this);
 }
@@ -305,36 +377,6 @@ Vector& Vector::operator/=(const double& rhs)
     return(*this);
 }
 
-/**
-********************************************************************************
-** @details Vector addition with another Vector object
-** @param   rhs Vector object
-** @return  New Vector object with addition of elements
-********************************************************************************
-*/
-const Vector Vector::operator+(const Vector& rhs) const
-{
-    Vector result(*this);
-    result += rhs;
-
-    return(result);
-}
-
-/**
-********************************************************************************
-** @details Vector subtraction with another Vector object
-** @param   rhs Vector object
-** @return  New Vector object with subtraction of elements
-********************************************************************************
-*/
-const Vector Vector::operator-(const Vector& rhs) const
-{
-    Vector result(*this);
-    result -= rhs;
-
-    return(result);
-}
-
 /**
 ********************************************************************************
 ** @details Vector inner (dot) product
@@ -344,46 +386,9 @@ const Vector Vector::operator-(const Vector& rhs) const
 */
 double Vector::operator*(const Vector& rhs) const
 {
-    double dotProd = 0;
-
     checkOperatorSize(ndims,rhs.ndims);
-    for (UINT32 i = 0; i < ndims; i++)
-    {
-        dotProd += pVec[i]*rhs.pVec[i];
-    }
 
-    return(dotProd);
-}
-
-/**
-********************************************************************************
-** @details Double multiplied by a vector
-** @param   lhs double data type
-** @param   rhs Vector object
-** @return  New Vector object with every element multiplied by lhs
-********************************************************************************
-*/
-Vector operator*(const double& lhs, const Vector& rhs)
-{
-    Vector result(rhs);
-    result *= lhs;
-
-    return(result);
-}
-
-/**
-********************************************************************************
-** @details Vector divided by a double
-** @param   rhs double data type
-** @return  New Vector object with elements divided by a double
-********************************************************************************
-*/
-const Vector Vector::operator/(const double& rhs) const
-{
-    Vector result(*this);
-    result /= rhs;
-
-    return(result);
+    return(vecDot(pVec,rhs.pVec,ndims));
 }
 
 /**
@@ -456,7 +461,9 @@ Vector& Vector::operator=(const Vector& rhs)
 
 /**
 ********************************************************************************
-** @details Vector move assignment operator
+** @details Vector move assignment operator. Heap elements are taken over,
+**          while inline and arena elements are copied, so the elements of a
+**          vector never move into an arena scope they may outlive.
 ** @param   rhs Vector rvalue reference object
 ** @return  Calling object with temporary's values
 ********************************************************************************
@@ -467,9 +474,19 @@ Vector& Vector::operator=(Vector&& rhs)
     {
         checkOperatorSize(ndims,rhs.ndims);
 
-        delete[] pVec;
-        pVec = rhs.pVec;
-        ndims = rhs.ndims;
+        if (rhs.pVec == rhs.inlineVec || rhs.fromArena)
+        {
+            for (UINT32 i = 0; i < ndims; i++)
+            {
+                pVec[i] = rhs.pVec[i];
+            }
+        }
+        else
+        {
+            release();
+            pVec = rhs.pVec;
+            fromArena = false;
+        }
 
         rhs.pVec = NULL;
         rhs.ndims = 0;
@@ -528,7 +545,7 @@ void Vector::setVector(const double* vals, const UINT32& n)
 
     if (NULL == pVec)
     {
-        pVec = new double [ndims];
+        allocate(ndims);
     }
 
     for (UINT32 i = 0; i < ndims; i++)
@@ -547,3 +564,15 @@ const UINT32& Vector::getSize(void) const
 {
     return(ndims);
 }
+
+/**
+********************************************************************************
+** @details Return a view of the vector elements. The view is only valid while
+**          the vector object is alive and not reassigned.
+** @return  View of the vector with unit stride
+********************************************************************************
+*/
+VectorView Vector::view(void) const
+{
+    return(VectorView(pVec,ndims));
+}
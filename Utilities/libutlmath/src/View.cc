@@ -0,0 +1,788 @@
+/**
+********************************************************************************
+** @file    View.cc
+**
+** @brief   Implementation of the VectorView and MatrixView classes
+**
+** @details View operations work directly on the viewed memory. Views with
+**          unit stride use the vectorized kernels, and matrix views are
+**          multiplied with the blocked matrix multiply whenever their rows or
+**          columns are contiguous.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  View.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include "View.hh"
+#include "Gemm.hh"
+#include "Macros.hh"
+#include "VecKernels.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/*---------------------------[VectorView Methods]-----------------------------*/
+/**
+********************************************************************************
+** @details VectorView class constructor
+** @param   data    Pointer to the first element
+** @param   n       Number of elements
+** @param   inc     Distance between elements
+********************************************************************************
+*/
+VectorView::VectorView(double* data, const UINT32& n, const UINT32& inc)
+{
+    ndims = n;
+    stride = inc;
+    pData = data;
+}
+
+/**
+********************************************************************************
+** @details VectorView copy assignment operator, which copies the elements of
+**          another view into the viewed elements
+** @param   rhs VectorView object
+** @return  Calling object with the copied values
+********************************************************************************
+*/
+VectorView& VectorView::operator=(const VectorView& rhs)
+{
+    checkExprSize(ndims,rhs.ndims);
+
+    if (1 == stride && 1 == rhs.stride)
+    {
+        memmove(pData,rhs.pData,ndims*sizeof(double));
+    }
+    else
+    {
+        for (UINT32 i = 0; i < ndims; i++)
+        {
+            pData[(size_t)i*stride] = rhs.pData[(size_t)i*rhs.stride];
+        }
+    }
+
+    return(*this);
+}
+
+/**
+********************************************************************************
+** @details Calculate the magnitude (norm) of the viewed vector
+** @return  Magnitude of the vector
+********************************************************************************
+*/
+double VectorView::mag(void) const
+{
+    return(sqrt((*this)*(*this)));
+}
+
+/**
+********************************************************************************
+** @details Scale the viewed vector to unit magnitude in place
+** @return  Magnitude of the vector before it was normalized
+********************************************************************************
+*/
+double VectorView::normalize(void)
+{
+    double vecMag;
+
+    vecMag = mag();
+    if (vecMag < FLOAT_TOL)
+    {
+        printf("Error - %s\n"
+               "        The zero vector can not be normalized.\n",
+               __PRETTY_FUNCTION__);
+        exit(EXIT_FAILURE);
+    }
+
+    *this *= 1/vecMag;
+
+    return(vecMag);
+}
+
+/**
+********************************************************************************
+** @details Multiply the viewed vector by a double in place
+** @param   rhs double data type
+** @return  Calling object with scaled values
+********************************************************************************
+*/
+VectorView& VectorView::operator*=(const double& rhs)
+{
+    if (1 == stride)
+    {
+        vecScale(rhs,pData,ndims);
+    }
+    else
+    {
+        for (UINT32 i = 0; i < ndims; i++)
+        {
+            pData[(size_t)i*stride] *= rhs;
+        }
+    }
+
+    return(*this);
+}
+
+/**
+********************************************************************************
+** @details Inner (dot) product of two vector views
+** @param   rhs VectorView object
+** @return  Inner product of the views
+********************************************************************************
+*/
+double VectorView::operator*(const VectorView& rhs) const
+{
+    double sum;
+
+    checkExprSize(ndims,rhs.ndims);
+
+    if (1 == stride && 1 == rhs.stride)
+    {
+        return(vecDot(pData,rhs.pData,ndims));
+    }
+
+    sum = 0;
+    for (UINT32 i = 0; i < ndims; i++)
+    {
+        sum += pData[(size_t)i*stride]*rhs.pData[(size_t)i*rhs.stride];
+    }
+
+    return(sum);
+}
+
+/**
+********************************************************************************
+** @details Access a viewed element
+** @param   i   Element index
+** @return  Viewed element
+********************************************************************************
+*/
+double& VectorView::operator[](const UINT32& i) const
+{
+    if (i >= ndims)
+    {
+        printf("Error - %s\n"
+               "        VectorView index out of bounds: %u\n"
+               "        Max VectorView index: %u\n",
+               __PRETTY_FUNCTION__,i,ndims-1);
+        exit(EXIT_FAILURE);
+    }
+
+    return(pData[(size_t)i*stride]);
+}
+
+/**
+********************************************************************************
+** @details Return the number of elements in the view
+** @return  Number of elements
+********************************************************************************
+*/
+UINT32 VectorView::getSize(void) const
+{
+    return(ndims);
+}
+
+/**
+********************************************************************************
+** @details Return the distance between the viewed elements
+** @return  Element stride
+********************************************************************************
+*/
+UINT32 VectorView::getStride(void) const
+{
+    return(stride);
+}
+
+/**
+********************************************************************************
+** @details Return a pointer to the first viewed element
+** @return  Pointer to the first element
+********************************************************************************
+*/
+double* VectorView::getData(void) const
+{
+    return(pData);
+}
+
+/*---------------------------[MatrixView Methods]-----------------------------*/
+/**
+********************************************************************************
+** @details MatrixView class constructor
+** @param   data    Pointer to element (0,0)
+** @param   m       Number of rows
+** @param   n       Number of columns
+** @param   ld      Distance between rows (the leading dimension)
+** @param   inc     Distance between columns
+********************************************************************************
+*/
+MatrixView::MatrixView(double* data, const UINT32& m, const UINT32& n,
+                       const UINT32& ld, const UINT32& inc)
+{
+    mrows = m;
+    ncols = n;
+    rowStride = ld;
+    colStride = inc;
+    pData = data;
+}
+
+/**
+********************************************************************************
+** @details MatrixView copy assignment operator, which copies the elements of
+**          another view into the viewed elements
+** @param   rhs MatrixView object
+** @return  Calling object with the copied values
+********************************************************************************
+*/
+MatrixView& MatrixView::operator=(const MatrixView& rhs)
+{
+    if (mrows != rhs.mrows || ncols != rhs.ncols)
+    {
+        printf("Error - %s\n"
+               "        Matrix dimensions are not equal\n",
+               __PRETTY_FUNCTION__);
+        exit(EXIT_FAILURE);
+    }
+
+    for (UINT32 i = 0; i < mrows; i++)
+    {
+        row(i) = rhs.row(i);
+    }
+
+    return(*this);
+}
+
+/**
+********************************************************************************
+** @details Ensure the row and column indices are within the view
+** @param   i   Row index
+** @param   j   Column index
+********************************************************************************
+*/
+void MatrixView::checkInd(const UINT32& i, const UINT32& j) const
+{
+    if (i >= mrows || j >= ncols)
+    {
+        printf("Error - Attempting to access MatrixView element (%u,%u)\n"
+               "        Range of indices: (0-%u,0-%u)\n",
+               i,j,mrows-1,ncols-1);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+********************************************************************************
+** @details Return a view of a sub-block of the matrix, which shares the
+**          strides of the calling view
+** @param   startRow    First row of the block (0 indexed)
+** @param   startCol    First column of the block (0 indexed)
+** @param   m           Number of rows in the block
+** @param   n           Number of columns in the block
+** @return  View of the block
+********************************************************************************
+*/
+MatrixView MatrixView::block(const UINT32& startRow, const UINT32& startCol,
+                             const UINT32& m, const UINT32& n) const
+{
+    if (0 == m || 0 == n ||
+        startRow >= mrows || m > mrows - startRow ||
+        startCol >= ncols || n > ncols - startCol)
+    {
+        printf("Error - %s\n"
+               "        Block of size %u x %u at (%u,%u) is outside the\n"
+               "        %u x %u matrix\n",
+               __PRETTY_FUNCTION__,m,n,startRow,startCol,mrows,ncols);
+        exit(EXIT_FAILURE);
+    }
+
+    return(MatrixView(pData + (size_t)startRow*rowStride +
+                      (size_t)startCol*colStride,m,n,rowStride,colStride));
+}
+
+/**
+********************************************************************************
+** @details Return a view of a row of the matrix
+** @param   i   Row index
+** @return  View of the row
+********************************************************************************
+*/
+VectorView MatrixView::row(const UINT32& i) const
+{
+    checkInd(i,0);
+
+    return(VectorView(pData + (size_t)i*rowStride,ncols,colStride));
+}
+
+/**
+********************************************************************************
+** @details Return a view of a column of the matrix
+** @param   j   Column index
+** @return  View of the column
+********************************************************************************
+*/
+VectorView MatrixView::col(const UINT32& j) const
+{
+    checkInd(0,j);
+
+    return(VectorView(pData + (size_t)j*colStride,mrows,rowStride));
+}
+
+/**
+********************************************************************************
+** @details Return a view of the transpose of the matrix, which swaps the row
+**          and column strides
+** @return  View of the transpose
+********************************************************************************
+*/
+MatrixView MatrixView::transpose(void) const
+{
+    return(MatrixView(pData,ncols,mrows,colStride,rowStride));
+}
+
+/**
+********************************************************************************
+** @details Calculate the rank of the matrix from the QR decomposition with a
+**          Householder Transformation
+** @return  Rank of the matrix
+********************************************************************************
+*/
+UINT32 MatrixView::rank(void) const
+{
+    UINT32 matRank;
+    double det;
+
+    QRdecomp(MATRIX_DECOMP_RANK,det,matRank);
+
+    return(matRank);
+}
+
+/**
+********************************************************************************
+** @details Calculate the rank of the matrix, as rank(), with the scratch
+**          memory of the QR decomposition taken from a workspace
+** @param   work    Workspace sized for at least the view dimensions
+** @return  Rank of the matrix
+********************************************************************************
+*/
+UINT32 MatrixView::rank(QRWorkspace& work) const
+{
+    work.checkFit(mrows,ncols);
+
+    ArenaScope scope(work.getArena());
+
+    return(rank());
+}
+
+/**
+********************************************************************************
+** @details Calculate the determinant of a square matrix using the QR
+**          decomposition with a Householder Transformation
+** @return  Determinant of a square matrix
+********************************************************************************
+*/
+double MatrixView::determinant(void) const
+{
+    UINT32 matRank;
+    double det;
+
+    if (mrows != ncols)
+    {
+        printf("Error - %s\n"
+               "        Determinant undefined for a non-square matrix\n",
+               __PRETTY_FUNCTION__);
+        exit(EXIT_FAILURE);
+    }
+
+    QRdecomp(MATRIX_DECOMP_DET,det,matRank);
+
+    return(det);
+}
+
+/**
+********************************************************************************
+** @details Calculate the determinant of a square matrix, as determinant(),
+**          with the scratch memory of the QR decomposition taken from a
+**          workspace
+** @param   work    Workspace sized for at least the view dimensions
+** @return  Determinant of a square matrix
+********************************************************************************
+*/
+double MatrixView::determinant(QRWorkspace& work) const
+{
+    work.checkFit(mrows,ncols);
+
+    ArenaScope scope(work.getArena());
+
+    return(determinant());
+}
+
+/**
+********************************************************************************
+** @details Calculate the QR decomposition using the Householder Transformation
+**          to return the determinant of a square matrix or the rank of any
+**          matrix. The decomposition is done on a padded row-major copy of
+**          the viewed elements, gathered once with the view strides, and each
+**          reflector H = I - 2*v*v' is applied implicitly to the trailing
+**          columns as the rank-1 update w = v'*A, A = A - 2*v*w'. No
+**          reflector, identity, or outer product matrices are formed, and the
+**          only allocation is the working storage made once per call, which is
+**          drawn from the current arena if there is one.
+** @param   decompFlag  Flag indicating if the determinant or rank is returned
+** @param   det         Reference for the determinant, if a square matrix
+** @param   matrixRank  Reference for the rank
+********************************************************************************
+*/
+void MatrixView::QRdecomp(INT32 decompFlag, double& det,
+                          UINT32& matrixRank) const
+{
+    UINT32 ld;
+    UINT32 row;
+    UINT32 matRank;
+
+    double kVal;
+    double colVal;
+    double matDet;
+    double vScale;
+
+    double* pA;
+    double* pV;
+    double* pW;
+    double* pRow;
+
+    matRank = 0;
+    matDet = 1;
+
+    /*
+    ** Allocate the working copy of the matrix along with the reflector vector
+    ** v and the row vector w = v'*A. It comes from the current arena when
+    ** there is one. The rows of the copy are padded so each one starts on an
+    ** aligned boundary.
+    */
+    ld = padLeadDim(ncols);
+
+    ArenaArray work((size_t)mrows*ld + mrows + ncols);
+
+    pA = work.get();
+    pV = pA + (size_t)mrows*ld;
+    pW = pV + mrows;
+
+    for (UINT32 i = 0; i < mrows; i++)
+    {
+        pRow = pA + (size_t)i*ld;
+        if (1 == colStride)
+        {
+            memcpy(pRow,pData + (size_t)i*rowStride,ncols*sizeof(double));
+        }
+        else
+        {
+            for (UINT32 j = 0; j < ncols; j++)
+            {
+                pRow[j] = pData[(size_t)i*rowStride + (size_t)j*colStride];
+            }
+        }
+    }
+
+    /*
+    ** Each column either has a nonzero part on and below the current row,
+    ** which is reduced to a single element by a Householder reflector, or it
+    ** is already zero and is skipped without moving to the next row
+    */
+    row = 0;
+    for (UINT32 col = 0; col < ncols && row < mrows; col++)
+    {
+        /*
+        ** Calculate the norm of the column from the current row to the end and
+        ** check if it is considered to be zero
+        */
+        kVal = 0;
+        for (UINT32 i = row; i < mrows; i++)
+        {
+            colVal = pA[(size_t)i*ld + col];
+            kVal += colVal*colVal;
+        }
+        kVal = sqrt(kVal);
+
+        if (kVal < FLOAT_TOL)
+        {
+            matDet = 0;
+            if (MATRIX_DECOMP_DET == decompFlag)
+            {
+                break;
+            }
+            continue;
+        }
+        matRank++;
+
+        /*
+        ** The last row needs no reflector, so its element is the final
+        ** diagonal value of R
+        */
+        colVal = pA[(size_t)row*ld + col];
+        if (row == mrows-1)
+        {
+            matDet *= colVal;
+            row++;
+            continue;
+        }
+
+        /*
+        ** Set the correct sign for kVal to avoid numerical instability and
+        ** calculate the elements of the v hat vector. Each reflector has a
+        ** determinant of -1, which is included with the diagonal value kVal.
+        */
+        kVal = (colVal < 0) ? kVal : -kVal;
+        matDet *= -kVal;
+
+        pV[row] = sqrt((kVal - colVal)/(2*kVal));
+        vScale = -1/(2*kVal*pV[row]);
+        for (UINT32 i = row+1; i < mrows; i++)
+        {
+            pV[i] = vScale*pA[(size_t)i*ld + col];
+        }
+
+        /*
+        ** Apply the reflector to the trailing columns. The rows are streamed in
+        ** order for both w = v'*A and A = A - 2*v*w'.
+        */
+        for (UINT32 j = col+1; j < ncols; j++)
+        {
+            pW[j] = 0;
+        }
+
+        for (UINT32 i = row; i < mrows; i++)
+        {
+            pRow = pA + (size_t)i*ld + col+1;
+            vecAxpy(pV[i],pRow,pW + col+1,ncols-col-1);
+        }
+
+        for (UINT32 i = row; i < mrows; i++)
+        {
+            pRow = pA + (size_t)i*ld + col+1;
+            vecAxpy(-2*pV[i],pW + col+1,pRow,ncols-col-1);
+        }
+
+        row++;
+    }
+
+    /*
+    ** The determinant is only defined for a square matrix
+    */
+    if (mrows == ncols)
+    {
+        det = matDet;
+    }
+    matrixRank = matRank;
+}
+
+/**
+********************************************************************************
+** @details Multiply the viewed matrix by a double in place
+** @param   rhs double data type
+** @return  Calling object with scaled values
+********************************************************************************
+*/
+MatrixView& MatrixView::operator*=(const double& rhs)
+{
+    for (UINT32 i = 0; i < mrows; i++)
+    {
+        row(i) *= rhs;
+    }
+
+    return(*this);
+}
+
+/**
+********************************************************************************
+** @details Access a viewed element
+** @param   i   Row index
+** @param   j   Column index
+** @return  Viewed element (i,j)
+********************************************************************************
+*/
+double& MatrixView::operator()(const UINT32& i, const UINT32& j) const
+{
+    checkInd(i,j);
+
+    return(pData[(size_t)i*rowStride + (size_t)j*colStride]);
+}
+
+/**
+********************************************************************************
+** @details Return the number of rows in the view
+** @return  Number of rows
+********************************************************************************
+*/
+UINT32 MatrixView::getRows(void) const
+{
+    return(mrows);
+}
+
+/**
+********************************************************************************
+** @details Return the number of columns in the view
+** @return  Number of columns
+********************************************************************************
+*/
+UINT32 MatrixView::getCols(void) const
+{
+    return(ncols);
+}
+
+/**
+********************************************************************************
+** @details Return the distance between the viewed rows
+** @return  Row stride
+********************************************************************************
+*/
+UINT32 MatrixView::getRowStride(void) const
+{
+    return(rowStride);
+}
+
+/**
+********************************************************************************
+** @details Return the distance between the viewed columns
+** @return  Column stride
+********************************************************************************
+*/
+UINT32 MatrixView::getColStride(void) const
+{
+    return(colStride);
+}
+
+/**
+********************************************************************************
+** @details Return a pointer to viewed element (0,0)
+** @return  Pointer to the first element
+********************************************************************************
+*/
+double* MatrixView::getData(void) const
+{
+    return(pData);
+}
+
+/*-----------------------------[View Operations]------------------------------*/
+/**
+********************************************************************************
+** @details Find the GEMM operation and leading dimension that read a view in
+**          place. A view with contiguous rows is a row-major matrix, and a
+**          view with contiguous columns is the transpose of one.
+** @param   view    Matrix view
+** @param   trans   Reference for the GEMM operation
+** @param   ld      Reference for the leading dimension
+** @return  true if the view can be read by the blocked matrix multiply
+********************************************************************************
+*/
+static bool gemmOperand(const MatrixView& view, GemmTrans& trans, UINT32& ld)
+{
+    if (1 == view.getColStride())
+    {
+        trans = GEMM_NO_TRANS;
+        ld = view.getRowStride();
+        return(true);
+    }
+    else if (1 == view.getRowStride())
+    {
+        trans = GEMM_TRANS;
+        ld = view.getColStride();
+        return(true);
+    }
+
+    return(false);
+}
+
+/**
+********************************************************************************
+** @details Calculate C = alpha*A*B + beta*C on matrix views. The blocked
+**          matrix multiply reads and writes the views in place when each one
+**          has contiguous rows or columns. A result with contiguous columns
+**          is calculated as its transpose C' = alpha*B'*A' + beta*C'. Views
+**          with no unit stride are multiplied element by element. C must not
+**          overlap A or B.
+** @param   alpha   Scalar multiplier of A*B
+** @param   a       m x k matrix view A
+** @param   b       k x n matrix view B
+** @param   beta    Scalar multiplier of C
+** @param   c       m x n matrix view C, updated in place
+********************************************************************************
+*/
+void gemm(const double& alpha, const MatrixView& a, const MatrixView& b,
+          const double& beta, const MatrixView& c)
+{
+    GemmTrans transA;
+    GemmTrans transB;
+
+    UINT32 lda;
+    UINT32 ldb;
+
+    double sum;
+
+    if (a.getCols() != b.getRows() || a.getRows() != c.getRows() ||
+        b.getCols() != c.getCols())
+    {
+        printf("Error - %s\n"
+               "        Matrix views are not conformable: (%u x %u)*(%u x %u)"
+               " into (%u x %u)\n",
+               __PRETTY_FUNCTION__,a.getRows(),a.getCols(),b.getRows(),
+               b.getCols(),c.getRows(),c.getCols());
+        exit(EXIT_FAILURE);
+    }
+
+    if (1 != c.getColStride() && 1 == c.getRowStride())
+    {
+        gemm(alpha,b.transpose(),a.transpose(),beta,c.transpose());
+        return;
+    }
+
+    if (1 == c.getColStride() && gemmOperand(a,transA,lda) &&
+        gemmOperand(b,transB,ldb))
+    {
+        gemm(transA,transB,c.getRows(),c.getCols(),a.getCols(),alpha,
+             a.getData(),lda,b.getData(),ldb,beta,c.getData(),
+             c.getRowStride());
+        return;
+    }
+
+    for (UINT32 i = 0; i < c.getRows(); i++)
+    {
+        for (UINT32 j = 0; j < c.getCols(); j++)
+        {
+            sum = 0;
+            for (UINT32 p = 0; p < a.getCols(); p++)
+            {
+                sum += a(i,p)*b(p,j);
+            }
+            c(i,j) = (0 == beta) ? alpha*sum : alpha*sum + beta*c(i,j);
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/**
+********************************************************************************
+** @file    Workspace.cc
+**
+** @brief   Implementation of the QRWorkspace class
+**
+** @details The scratch memory of a workspace is one arena block large enough
+**          for the largest call it is sized for. The largest user is the QR
+**          decomposition of an m x n matrix, which needs a working copy of
+**          the matrix and two vectors; the Gram-Schmidt routines need one
+**          array per vector.
+**
+** @author  $Format:%an$
+**
+** @date    $Format:%cD$
+**
+** @copyright Copyright 2015 by Ben Johnson\n
+**            You can freely redistribute and/or modify the contents of this
+**            file under the terms of the GNU General Public License version 3,
+**            or any later versions.
+********************************************************************************
+*/
+
+/*
+********************************************************************************
+**  Workspace.cc
+**
+**  (C) Copyright 2015 by Ben Johnson
+**
+**  This is free software: you can redistribute it and/or modify it under the
+**  terms of the GNU General Public License as published by the Free Software
+**  Foundation, either version 3 of the License, or (at your option) any later
+**  version.
+**
+**  This is distributed in the hope that it will be useful, but WITHOUT ANY
+**  WARRANTY; without even the implied warranty of MERCHANTIBILITY or FITNESS
+**  FOR A PARTICULAR PURPOSE. See the GNU General Public License for more
+**  details.
+**
+**  A copy of the license can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************
+*/
+
+/*------------------------------[Include Files]-------------------------------*/
+#include <cstdio>
+#include <cstdlib>
+
+#include "Workspace.hh"
+#include "View.hh"
+
+/*-------------------------------[Begin Code]---------------------------------*/
+/**
+********************************************************************************
+** @details QRWorkspace class constructor
+** @param   m   Maximum number of rows, or vector dimension
+** @param   n   Maximum number of columns, or number of vectors
+********************************************************************************
+*/
+QRWorkspace::QRWorkspace(const UINT32& m, const UINT32& n) :
+    arena(getScratchSize((0 == m) ? 1 : m,(0 == n) ? 1 : n))
+{
+    if (0 == m || 0 == n)
+    {
+        printf("Error - %s\n"
+               "        Workspace of size %u x %u not allowed\n",
+               __PRETTY_FUNCTION__,m,n);
+        exit(EXIT_FAILURE);
+    }
+
+    maxRows = m;
+    maxCols = n;
+}
+
+/**
+********************************************************************************
+** @details Check that an m x n problem fits in the workspace
+** @param   m   Number of rows, or vector dimension
+** @param   n   Number of columns, or number of vectors
+********************************************************************************
+*/
+void QRWorkspace::checkFit(const UINT32& m, const UINT32& n) const
+{
+    if (m > maxRows || n > maxCols)
+    {
+        printf("Error - %s\n"
+               "        Problem of size %u x %u does not fit in a workspace\n"
+               "        of size %u x %u\n",
+               __PRETTY_FUNCTION__,m,n,maxRows,maxCols);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+********************************************************************************
+** @details Get the maximum number of rows of the workspace
+** @return  Maximum number of rows
+********************************************************************************
+*/
+UINT32 QRWorkspace::getMaxRows(void) const
+{
+    return(maxRows);
+}
+
+/**
+********************************************************************************
+** @details Get the maximum number of columns of the workspace
+** @return  Maximum number of columns
+********************************************************************************
+*/
+UINT32 QRWorkspace::getMaxCols(void) const
+{
+    return(maxCols);
+}
+
+/**
+********************************************************************************
+** @details Get the number of bytes of scratch memory needed for an m x n
+**          problem, including the padded rows of the QR working copy and the
+**          arena alignment
+** @param   m   Number of rows, or vector dimension
+** @param   n   Number of columns, or number of vectors
+** @return  Number of bytes
+********************************************************************************
+*/
+size_t QRWorkspace::getScratchSize(const UINT32& m, const UINT32& n)
+{
+    return(((size_t)m*padLeadDim(n) + m + n)*sizeof(double) + ARENA_ALIGN);
+}
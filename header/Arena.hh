@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/Arena.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/Batched.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/Expression.hh
\ No newline at end of file
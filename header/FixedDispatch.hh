@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/FixedDispatch.hh
\ No newline at end of file
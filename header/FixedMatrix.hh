@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/FixedMatrix.hh
\ No newline at end of file
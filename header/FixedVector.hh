@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/FixedVector.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/Gemm.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/Grammian.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutldefs/header/Macros.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/Matrix.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/Orthonormal.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutldefs/header/StdTypes.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutlio/header/TextLoader.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/ThreadPool.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/Tsqr.hh
\ No newline at end of file
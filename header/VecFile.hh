@@ -0,0 +1 @@
+/root/repo/Utilities/libutlio/header/VecFile.hh
\ No newline at end of file
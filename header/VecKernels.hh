@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/VecKernels.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutlio/header/VecService.hh
\ No newline at end of file
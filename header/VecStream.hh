@@ -0,0 +1 @@
+/root/repo/Utilities/libutlio/header/VecStream.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutlio/header/VecWriter.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/Vector.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/View.hh
\ No newline at end of file
@@ -0,0 +1 @@
+/root/repo/Utilities/libutlmath/header/Workspace.hh
\ No newline at end of file